@@ -0,0 +1,760 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_auth_c.c                                       */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Login authentication for the telnet server
+ */
+
+/**
+ * @file i_telnet_auth_c.c
+ *
+ * Logins are verified by the IP_TELNET_AUTH process, started by
+ * IP_TELNET_SERVER. A client process sends MIAUTHREQ and continues
+ * in its main loop; the result is returned in MIAUTHREPLY.
+ *
+ * IP_TELNET_AUTH answers directly when
+ * @li the source address has too many failed logins within
+ *     AUTH_FAIL_WINDOW (MI_AUTH_THROTTLED, for AUTH_BLOCK_TIME), or
+ * @li the user has logged in successfully with the same password
+ *     within AUTH_CACHE_TTL. Only a salted hash of the password is
+ *     kept in the cache.
+ *
+ * Other requests are forwarded to one of AUTH_WORKERS worker processes
+ * (IP_TELNET_AUTHW_n) that call the authentication backend, so a slow
+ * backend handles several logins at the same time. The backend is
+ * zzvalidateLogin (VALID_LOGIN) or the built-in login, and can be
+ * replaced with itelnet_AuthSetBackend().
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_auth_h.h"
+
+/* Module internal interfaces */
+#include "i_telnet_sig_def.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  CONSTANTS  ------------------------------------*/
+
+/* Number of worker processes calling the backend */
+#define AUTH_WORKERS       2
+
+/* Cache of successful logins */
+#define AUTH_CACHE_SIZE    8
+#define AUTH_CACHE_TTL     60    /* seconds */
+
+/* Throttling of failed logins per source address */
+#define AUTH_MAX_SOURCES   16
+#define AUTH_MAX_FAILURES  5
+#define AUTH_FAIL_WINDOW   60    /* seconds */
+#define AUTH_BLOCK_TIME    30    /* seconds */
+
+/* FNV-1a hash */
+#define FNV_OFFSET         2166136261UL
+#define FNV_PRIME          16777619UL
+
+/*-------------------------  MACROS  ---------------------------------------*/
+
+/* Seconds to system ticks, system_tick() is in microseconds */
+#define SEC_TO_TICKS(s) ((OSTICK) (((s) * 1000000UL) / system_tick()))
+
+/* TRUE if tick a is at or after tick b (handles wrap-around) */
+#define TICK_REACHED(a, b) ((OSTICK)((a) - (b)) < (OSTICK) 0x80000000UL)
+
+/*-------------------------  TYPE DEF  -------------------------------------*/
+
+/* Successful login */
+typedef struct AUTH_CACHE_st
+{
+  Boolean used;
+  char    userName[MI_AUTH_NAME_LEN];
+  W32     salt;
+  W32     hash;               /* Hash of salt and password */
+  OSTICK  expires;
+} AUTH_CACHE_st;
+
+/* Failed logins from a source address */
+typedef struct AUTH_SOURCE_st
+{
+  Boolean used;
+  W32     ipAddress;
+  W32     failures;           /* Failures within the window */
+  OSTICK  firstFailure;
+  OSTICK  blockedUntil;       /* Valid if failures >= AUTH_MAX_FAILURES */
+} AUTH_SOURCE_st;
+
+/****************************************************************************/
+/*                           LOCAL SUBROUTINES                              */
+/****************************************************************************/
+
+static Boolean DefaultBackend(const char *userName, const char *passWord,
+                              OSUSER *user);
+static W32 Hash(W32 hash, const char *str_p);
+static Boolean CacheLookup(const char *userName, const char *passWord,
+                           OSTICK now);
+static void CacheInsert(const char *userName, const char *passWord,
+                        OSTICK now);
+static AUTH_SOURCE_st *FindSource(W32 ipAddress, Boolean create);
+static Boolean IsThrottled(W32 ipAddress, OSTICK now);
+static void LoginFailed(W32 ipAddress, OSTICK now);
+static void LoginSucceeded(W32 ipAddress);
+static void Reply(PROCESS clientPid, W32 clientInd, W32 result);
+static void FreeRequest(union SIGNAL **sig_pp);
+
+/****************************************************************************/
+/*                           DATA                                           */
+/****************************************************************************/
+
+/*-------------------------  STATIC DATA  ----------------------------------*/
+
+/* Authentication processes, written by IP_TELNET_SERVER and
+   IP_TELNET_AUTH */
+static PROCESS authPid = 0;
+static PROCESS workerPid[AUTH_WORKERS];
+
+/* Authentication backend */
+static ITELNET_AUTH_BACKEND backend = DefaultBackend;
+
+/* The following data is only used by the IP_TELNET_AUTH process */
+static W32            outstanding[AUTH_WORKERS];
+static AUTH_CACHE_st  cache[AUTH_CACHE_SIZE];
+static AUTH_SOURCE_st source[AUTH_MAX_SOURCES];
+static W32            saltCounter = 0;
+
+
+
+/**************************************************************************
+ * Internal function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Verifies user name and password for a user.
+*
+* @param   userName   Login name of user.
+* @param   passWord   Password.
+* @param   user       OSE user number.
+*
+* @return  TRUE if the login is valid.
+*
+***************************************************************************
+*/
+static Boolean DefaultBackend(const char *userName, const char *passWord,
+                              OSUSER *user)
+{
+#ifdef VALID_LOGIN
+  return zzvalidateLogin(userName, passWord, user);
+#else
+  (void) user;
+  
+  return ((Boolean)((strcmp(userName, "razor") == 0) &&
+                    (strcmp(passWord, "assar") == 0)));
+#endif
+} /* DefaultBackend */
+
+
+
+/**
+***************************************************************************
+* @brief Continues an FNV-1a hash over a string, including the
+*        terminator so that "ab"+"c" and "a"+"bc" differ.
+*
+* @param   hash      Hash so far.
+* @param   str_p     String.
+*
+* @return  New hash.
+*
+***************************************************************************
+*/
+static W32 Hash(W32 hash, const char *str_p)
+{
+  do
+  {
+    hash = (hash ^ (U8) *str_p) * FNV_PRIME;
+  } while (*str_p++ != 0);
+
+  return hash;
+} /* Hash */
+
+
+
+/**
+***************************************************************************
+* @brief Looks for a valid cached login.
+*
+* @param   userName   Login name of user.
+* @param   passWord   Password.
+* @param   now        Current tick count.
+*
+* @return  TRUE if the user has logged in with the same password
+*          within AUTH_CACHE_TTL.
+*
+***************************************************************************
+*/
+static Boolean CacheLookup(const char *userName, const char *passWord,
+                           OSTICK now)
+{
+  W32 i;
+  W32 hash;
+
+  for (i = 0; i < AUTH_CACHE_SIZE; i++)
+  {
+    if (cache[i].used && (strcmp(cache[i].userName, userName) == 0))
+    {
+      if (TICK_REACHED(now, cache[i].expires))
+      {
+        cache[i].used = FALSE;
+        return FALSE;
+      }
+
+      hash = Hash(FNV_OFFSET ^ cache[i].salt, passWord);
+      return (Boolean) (hash == cache[i].hash);
+    }
+  }
+
+  return FALSE;
+} /* CacheLookup */
+
+
+
+/**
+***************************************************************************
+* @brief Caches a successful login. An existing entry for the user, a
+*        free entry or the entry expiring first is used.
+*
+* @param   userName   Login name of user.
+* @param   passWord   Password.
+* @param   now        Current tick count.
+*
+***************************************************************************
+*/
+static void CacheInsert(const char *userName, const char *passWord,
+                        OSTICK now)
+{
+  AUTH_CACHE_st *entry_p = NULL;
+  W32 i;
+
+  for (i = 0; i < AUTH_CACHE_SIZE; i++)
+  {
+    if (cache[i].used && (strcmp(cache[i].userName, userName) == 0))
+    {
+      entry_p = &cache[i];
+      break;
+    }
+
+    if ((entry_p == NULL) || !cache[i].used ||
+        (entry_p->used && TICK_REACHED(entry_p->expires, cache[i].expires)))
+    {
+      entry_p = &cache[i];
+    }
+  }
+
+  entry_p->used = TRUE;
+  strncpy(entry_p->userName, userName, MI_AUTH_NAME_LEN - 1);
+  entry_p->userName[MI_AUTH_NAME_LEN - 1] = 0;
+  entry_p->salt = (W32) now * FNV_PRIME + ++saltCounter;
+  entry_p->hash = Hash(FNV_OFFSET ^ entry_p->salt, passWord);
+  entry_p->expires = now + SEC_TO_TICKS(AUTH_CACHE_TTL);
+} /* CacheInsert */
+
+
+
+/**
+***************************************************************************
+* @brief Finds the failure record of a source address.
+*
+* @param   ipAddress  Source address.
+* @param   create     TRUE to create the record if not found. The
+*                     record with the oldest failures is reused when
+*                     the table is full.
+*
+* @return  The record, NULL if not found and not created.
+*
+***************************************************************************
+*/
+static AUTH_SOURCE_st *FindSource(W32 ipAddress, Boolean create)
+{
+  AUTH_SOURCE_st *free_p = NULL;
+  W32 i;
+
+  for (i = 0; i < AUTH_MAX_SOURCES; i++)
+  {
+    if (source[i].used && (source[i].ipAddress == ipAddress))
+    {
+      return &source[i];
+    }
+
+    if ((free_p == NULL) || !source[i].used ||
+        (free_p->used &&
+         TICK_REACHED(free_p->firstFailure, source[i].firstFailure)))
+    {
+      free_p = &source[i];
+    }
+  }
+
+  if (!create)
+  {
+    return NULL;
+  }
+
+  free_p->used = TRUE;
+  free_p->ipAddress = ipAddress;
+  free_p->failures = 0;
+  return free_p;
+} /* FindSource */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if logins from a source address are blocked.
+*
+* @param   ipAddress  Source address.
+* @param   now        Current tick count.
+*
+* @return  TRUE if blocked.
+*
+***************************************************************************
+*/
+static Boolean IsThrottled(W32 ipAddress, OSTICK now)
+{
+  AUTH_SOURCE_st *source_p;
+
+  source_p = FindSource(ipAddress, FALSE);
+  if ((source_p == NULL) || (source_p->failures < AUTH_MAX_FAILURES))
+  {
+    return FALSE;
+  }
+
+  if (TICK_REACHED(now, source_p->blockedUntil))
+  {
+    /* The block has expired */
+    source_p->used = FALSE;
+    return FALSE;
+  }
+
+  return TRUE;
+} /* IsThrottled */
+
+
+
+/**
+***************************************************************************
+* @brief Records a failed login. The source is blocked for
+*        AUTH_BLOCK_TIME after AUTH_MAX_FAILURES failures within
+*        AUTH_FAIL_WINDOW.
+*
+* @param   ipAddress  Source address.
+* @param   now        Current tick count.
+*
+***************************************************************************
+*/
+static void LoginFailed(W32 ipAddress, OSTICK now)
+{
+  AUTH_SOURCE_st *source_p;
+
+  source_p = FindSource(ipAddress, TRUE);
+
+  if ((source_p->failures == 0) ||
+      TICK_REACHED(now, source_p->firstFailure +
+                        SEC_TO_TICKS(AUTH_FAIL_WINDOW)))
+  {
+    /* New window */
+    source_p->failures = 0;
+    source_p->firstFailure = now;
+  }
+
+  source_p->failures++;
+  if (source_p->failures >= AUTH_MAX_FAILURES)
+  {
+    source_p->blockedUntil = now + SEC_TO_TICKS(AUTH_BLOCK_TIME);
+
+    APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_15, ipAddress,
+                        __LINE__, __FILE__,
+                        0);
+  }
+} /* LoginFailed */
+
+
+
+/**
+***************************************************************************
+* @brief Forgets the failed logins of a source address.
+*
+* @param   ipAddress  Source address.
+*
+***************************************************************************
+*/
+static void LoginSucceeded(W32 ipAddress)
+{
+  AUTH_SOURCE_st *source_p;
+
+  source_p = FindSource(ipAddress, FALSE);
+  if (source_p != NULL)
+  {
+    source_p->used = FALSE;
+  }
+} /* LoginSucceeded */
+
+
+
+/**
+***************************************************************************
+* @brief Sends MIAUTHREPLY to a client process.
+*
+* @param   clientPid  Client process.
+* @param   clientInd  Client individual.
+* @param   result     MI_AUTH_OK/DENIED/THROTTLED.
+*
+***************************************************************************
+*/
+static void Reply(PROCESS clientPid, W32 clientInd, W32 result)
+{
+  union SIGNAL *sig_p;
+
+  sig_p = OS_alloc(MIAUTHREPLY_S, MIAUTHREPLY);
+  sig_p->miauthreply.clientInd = clientInd;
+  sig_p->miauthreply.result = result;
+  OS_send(&sig_p, clientPid);
+} /* Reply */
+
+
+
+/**
+***************************************************************************
+* @brief Clears the password of a MIAUTHREQ or MIAUTHVERIFYR and frees
+*        the signal.
+*
+* @param   sig_pp     Signal.
+*
+***************************************************************************
+*/
+static void FreeRequest(union SIGNAL **sig_pp)
+{
+  if ((*sig_pp)->sig_no == MIAUTHREQ)
+  {
+    memset((*sig_pp)->miauthreq.password, 0, MI_AUTH_PASSWD_LEN);
+  }
+  else
+  {
+    memset((*sig_pp)->miauthverifyr.req.password, 0, MI_AUTH_PASSWD_LEN);
+  }
+
+  OS_free(sig_pp);
+} /* FreeRequest */
+
+
+
+/****************************************************************************/
+/*                                                                          */
+/*                   PROCESS                                                */
+/*                                                                          */
+/*                   IP_TELNET_AUTHW_n                                      */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*  Purpose: Verifies logins forwarded by IP_TELNET_AUTH with the           */
+/*           authentication backend.                                        */
+/*                                                                          */
+/****************************************************************************/
+
+APT_RP_PROCESS(IP_TELNET_AUTHW)
+{
+  static SIGSELECT authReq[] = {1, MIAUTHREQ};
+  union SIGNAL *sig_p;
+  union SIGNAL *reply_p;
+
+  while(1)                                              /*lint !e716*/
+  {
+    sig_p = OS_receive(authReq);
+
+    reply_p = OS_alloc(MIAUTHVERIFYR_S, MIAUTHVERIFYR);
+    reply_p->miauthverifyr.req = sig_p->miauthreq;
+    reply_p->miauthverifyr.result =
+      backend(sig_p->miauthreq.userName, sig_p->miauthreq.password, 0) ?
+      MI_AUTH_OK : MI_AUTH_DENIED;
+
+    OS_send(&reply_p, OS_sender(&sig_p));
+    FreeRequest(&sig_p);
+  }
+} /* IP_TELNET_AUTHW */
+
+
+
+/****************************************************************************/
+/*                                                                          */
+/*                   PROCESS                                                */
+/*                                                                          */
+/*                   IP_TELNET_AUTH                                         */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*  Purpose: Answers login requests (MIAUTHREQ) from the cache and the      */
+/*           throttling state, or through a worker process.                 */
+/*                                                                          */
+/****************************************************************************/
+
+APT_RP_PROCESS(IP_TELNET_AUTH)
+{
+  static SIGSELECT allSignals[] = {0};
+  union SIGNAL *sig_p;
+  struct miauthreq_s *req_p;
+  char name[20];
+  OSTICK now;
+  W32 worker;
+  W32 i;
+
+  for (i = 0; i < AUTH_CACHE_SIZE; i++)
+  {
+    cache[i].used = FALSE;
+  }
+  for (i = 0; i < AUTH_MAX_SOURCES; i++)
+  {
+    source[i].used = FALSE;
+  }
+
+  for (i = 0; i < AUTH_WORKERS; i++)
+  {
+    sprintf(name, "IP_TELNET_AUTHW_%d", (W8) i);
+    workerPid[i] = OS_create_proc((OSADDRESS) IP_TELNET_AUTHW,
+                                  OWN_REF,
+                                  name,
+                                  15,
+                                  2000,
+                                  2,
+                                  TRH_USER_MODE);
+    outstanding[i] = 0;
+  }
+
+  while(1)                                              /*lint !e716*/
+  {
+    sig_p = OS_receive(allSignals);
+    now = get_ticks();
+
+    switch(sig_p->sig_no)
+    {
+      case MIAUTHREQ:
+        req_p = &sig_p->miauthreq;
+        req_p->clientPid = OS_sender(&sig_p);
+
+        if (IsThrottled(req_p->ipAddress, now))
+        {
+          Reply(req_p->clientPid, req_p->clientInd, MI_AUTH_THROTTLED);
+        }
+        else if (CacheLookup(req_p->userName, req_p->password, now))
+        {
+          LoginSucceeded(req_p->ipAddress);
+          Reply(req_p->clientPid, req_p->clientInd, MI_AUTH_OK);
+        }
+        else
+        {
+          /* Forward to the least loaded worker */
+          worker = 0;
+          for (i = 1; i < AUTH_WORKERS; i++)
+          {
+            if (outstanding[i] < outstanding[worker])
+            {
+              worker = i;
+            }
+          }
+          outstanding[worker]++;
+          OS_send(&sig_p, workerPid[worker]);
+        }
+        break;
+
+      case MIAUTHVERIFYR:
+        for (i = 0; i < AUTH_WORKERS; i++)
+        {
+          if ((workerPid[i] == OS_sender(&sig_p)) && (outstanding[i] > 0))
+          {
+            outstanding[i]--;
+          }
+        }
+
+        req_p = &sig_p->miauthverifyr.req;
+        if (sig_p->miauthverifyr.result == MI_AUTH_OK)
+        {
+          CacheInsert(req_p->userName, req_p->password, now);
+          LoginSucceeded(req_p->ipAddress);
+        }
+        else
+        {
+          LoginFailed(req_p->ipAddress, now);
+        }
+        Reply(req_p->clientPid, req_p->clientInd,
+              sig_p->miauthverifyr.result);
+        break;
+
+      default:
+        APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_21, sig_p->sig_no);
+        OS_free(&sig_p);
+        break;
+    }
+
+    if (sig_p != NULL)
+    {
+      FreeRequest(&sig_p);
+    }
+  }
+} /* IP_TELNET_AUTH */
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Starts the authentication processes, if not already running
+*        (e.g. started by a previous telnet server).
+*
+***************************************************************************
+*/
+void itelnet_AuthStart(void)
+{
+  if (authPid == 0)
+  {
+    authPid = OS_create_proc((OSADDRESS) IP_TELNET_AUTH,
+                             OWN_REF,
+                             "IP_TELNET_AUTH",
+                             15,
+                             2000,
+                             2,
+                             TRH_USER_MODE);
+  }
+} /* itelnet_AuthStart */
+
+
+
+/**
+***************************************************************************
+* @brief Stops the authentication processes. Called when the telnet
+*        server stops.
+*
+***************************************************************************
+*/
+void itelnet_AuthStop(void)
+{
+  W32 i;
+
+  if (authPid != 0)
+  {
+    kill_proc(authPid);
+    authPid = 0;
+
+    for (i = 0; i < AUTH_WORKERS; i++)
+    {
+      if (workerPid[i] != 0)
+      {
+        kill_proc(workerPid[i]);
+        workerPid[i] = 0;
+      }
+    }
+  }
+} /* itelnet_AuthStop */
+
+
+
+/**
+***************************************************************************
+* @brief Replaces the authentication backend.
+*
+* @param   backend_p  Backend, NULL restores the default backend.
+*
+***************************************************************************
+*/
+void itelnet_AuthSetBackend(ITELNET_AUTH_BACKEND backend_p)
+{
+  backend = (backend_p != NULL) ? backend_p : DefaultBackend;
+} /* itelnet_AuthSetBackend */
+
+
+
+/**
+***************************************************************************
+* @brief Requests verification of a login. The result is returned to
+*        the calling process in MIAUTHREPLY. The login is verified
+*        directly if IP_TELNET_AUTH is not running.
+*
+* @param   clientInd  Client individual.
+* @param   ipAddress  Source address of the session.
+* @param   userName   Login name of user.
+* @param   passWord   Password.
+*
+***************************************************************************
+*/
+void itelnet_AuthRequest(W32 clientInd, W32 ipAddress,
+                         const char *userName, const char *passWord)
+{
+  union SIGNAL *sig_p;
+
+  if (authPid == 0)
+  {
+    Reply(current_process(), clientInd,
+          backend(userName, passWord, 0) ? MI_AUTH_OK : MI_AUTH_DENIED);
+    return;
+  }
+
+  sig_p = OS_alloc(MIAUTHREQ_S, MIAUTHREQ);
+  sig_p->miauthreq.clientPid = current_process();
+  sig_p->miauthreq.clientInd = clientInd;
+  sig_p->miauthreq.ipAddress = ipAddress;
+  strncpy(sig_p->miauthreq.userName, userName, MI_AUTH_NAME_LEN - 1);
+  sig_p->miauthreq.userName[MI_AUTH_NAME_LEN - 1] = 0;
+  strncpy(sig_p->miauthreq.password, passWord, MI_AUTH_PASSWD_LEN - 1);
+  sig_p->miauthreq.password[MI_AUTH_PASSWD_LEN - 1] = 0;
+  OS_send(&sig_p, authPid);
+} /* itelnet_AuthRequest */
@@ -0,0 +1,65 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_auth_h.h                                       */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the login authentication (IP_TELNET_AUTH) in      */
+/*          the telnet module.                                              */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_AUTH_H_H
+#define I_TELNET_AUTH_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+
+/****************************************************************************/
+/*                           TYPE DEFINITIONS                               */
+/****************************************************************************/
+
+/* Authentication backend, returns TRUE if the login is valid */
+typedef Boolean (*ITELNET_AUTH_BACKEND)(const char *userName,
+                                        const char *passWord,
+                                        OSUSER *user);
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_SERVER process */
+extern void itelnet_AuthStart(void);
+extern void itelnet_AuthStop(void);
+
+/* Replaces the default backend, to be called before the server starts */
+extern void itelnet_AuthSetBackend(ITELNET_AUTH_BACKEND backend_p);
+
+/* Used by the IP_TELNET_CH_n processes */
+extern void itelnet_AuthRequest(W32 clientInd, W32 ipAddress,
+                                const char *userName, const char *passWord);
+
+#endif /* I_TELNET_AUTH_H_H */
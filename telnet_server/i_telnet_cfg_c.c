@@ -0,0 +1,489 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_cfg_c.c                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Configuration snapshot for the telnet server
+ */
+
+/**
+ * @file i_telnet_cfg_c.c
+ *
+ * All flash (pboot) parameters of the telnet module are read into one
+ * validated snapshot by IP_TELNET_SERVER, at start and when the
+ * configuration is reloaded (MITELNETRELOAD). The parameter store is
+ * not read on the connection path.
+ *
+ * The session parameters are sent to each IP_TELNET_CH_n process in
+ * MICLIENTCFG, directly after MISTARTCLIENT and again to the running
+ * sessions when the configuration is reloaded. The commands of the
+ * result cache are sent as well; being read-only they are the ones a
+ * session may run ahead in parallel mode.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_cfg_h.h"
+
+/* Module internal interfaces */
+#include "i_telnet_sig_def.h"
+#include "i_telnetproc_def.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+#include "tipsock.h"
+
+#ifdef APT_PBOOT_USER
+#include "user_pboot.h"
+#else
+#include "pboot.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  CONSTANTS  ------------------------------------*/
+
+/* Defaults, used when a parameter is not set or not valid */
+#define SEND_BUFFER_SIZE          131072
+#define STOP_DEADLINE             5     /* seconds */
+#define MAX_CONNECTIONS_PER_ADDR  0     /* no limit */
+#define ACCEPT_RATE               0     /* no limit */
+#define ACCEPT_BURST              10    /* used with telnet_accept_rate */
+#define RESERVED_CONNECTIONS      0     /* none reserved */
+#define QUEUE_DEPTH               0     /* no queue */
+#define QUEUE_WAIT                60    /* seconds */
+
+/* Limits */
+#define MIN_SEND_BUFFER_SIZE      1024
+#define MAX_SEND_BUFFER_SIZE      1048576
+#define MAX_STOP_DEADLINE         60    /* seconds */
+#define MAX_QUEUE_WAIT            3600  /* seconds */
+#define MAX_CACHE_TTL             3600  /* seconds */
+
+/* Size of the parameter value buffer */
+#define PARAM_LENGTH              20
+
+/* Size of the value of telnet_cache_n: time to live and command */
+#define CFG_CACHE_PARAM_LENGTH    (16 + CFG_CACHE_CMD_LEN)
+
+/****************************************************************************/
+/*                           LOCAL SUBROUTINES                              */
+/****************************************************************************/
+
+static Boolean GetParam(char *name, char *buf_p);
+static Boolean GetLongParam(char *name, char *buf_p, W32 size);
+static W32 GetNumParam(char *name, W32 defaultValue, W32 min, W32 max);
+static void GetNetParam(char *name, W32 *net_p, W32 *mask_p);
+static OSTIME GetAutoLogout(void);
+static void GetCacheParams(TELNET_CFG_st *cfg_p);
+
+/****************************************************************************/
+/*                           DATA                                           */
+/****************************************************************************/
+
+/*-------------------------  STATIC DATA  ----------------------------------*/
+
+/* Only used by the IP_TELNET_SERVER process */
+static W32 generation = 0;
+
+
+
+/**************************************************************************
+ * Internal function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Reads a flash (pboot) parameter.
+*
+* @param   name      Parameter name.
+* @param   buf_p     Buffer of PARAM_LENGTH bytes for the value.
+*
+* @return  TRUE if the parameter is set.
+*
+***************************************************************************
+*/
+static Boolean GetParam(char *name, char *buf_p)
+{
+  return GetLongParam(name, buf_p, PARAM_LENGTH);
+} /* GetParam */
+
+
+
+/**
+***************************************************************************
+* @brief Reads a flash (pboot) parameter longer than PARAM_LENGTH.
+*
+* @param   name      Parameter name.
+* @param   buf_p     Buffer for the value.
+* @param   size      Size of the buffer.
+*
+* @return  TRUE if the parameter is set.
+*
+***************************************************************************
+*/
+static Boolean GetLongParam(char *name, char *buf_p, W32 size)
+{
+#ifdef APT_PBOOT_USER
+  if(user_pboot_param_get(name, buf_p, (int) size - 1) == 0)
+#else
+  if(pboot_param_get(name, buf_p, (int) size - 1) == 0)
+#endif
+  {
+    buf_p[size - 1] = 0;
+    return TRUE;
+  }
+
+  return FALSE;
+} /* GetLongParam */
+
+
+
+/**
+***************************************************************************
+* @brief Reads a numeric flash (pboot) parameter.
+*
+* @param   name          Parameter name.
+* @param   defaultValue  Value used if the parameter is not set or
+*                        not a number.
+* @param   min           Smallest valid value.
+* @param   max           Largest valid value, values above are limited.
+*
+* @return  Parameter value.
+*
+***************************************************************************
+*/
+static W32 GetNumParam(char *name, W32 defaultValue, W32 min, W32 max)
+{
+  char buf[PARAM_LENGTH];
+  char *end_p;
+  W32 value;
+
+  if (!GetParam(name, buf))
+  {
+    return defaultValue;
+  }
+
+  value = (W32) strtoul(buf, &end_p, 0);
+  if ((end_p == buf) || (value < min))
+  {
+    return defaultValue;
+  }
+
+  if (value > max)
+  {
+    value = max;
+  }
+
+  return value;
+} /* GetNumParam */
+
+
+
+/**
+***************************************************************************
+* @brief Reads a network flash (pboot) parameter on the form
+*        "a.b.c.d/n".
+*
+* @param   name      Parameter name.
+* @param   net_p     Network address.
+* @param   mask_p    Network mask, 0 if not set or invalid.
+*
+***************************************************************************
+*/
+static void GetNetParam(char *name, W32 *net_p, W32 *mask_p)
+{
+  char buf[PARAM_LENGTH];
+  char *ptr;
+  W32 addr = 0;
+  W32 prefixLen = 32;
+  W32 i;
+
+  *net_p = 0;
+  *mask_p = 0;
+
+  if (!GetParam(name, buf))
+  {
+    return;
+  }
+
+  ptr = buf;
+  for (i = 0; i < 4; i++)
+  {
+    addr = (addr << 8) | (strtoul(ptr, &ptr, 10) & 0xFF);
+    if ((i < 3) && (*ptr++ != '.'))
+    {
+      return;
+    }
+  }
+
+  if (*ptr == '/')
+  {
+    prefixLen = strtoul(ptr + 1, 0, 10);
+  }
+
+  if ((prefixLen == 0) || (prefixLen > 32))
+  {
+    return;
+  }
+
+  *mask_p = 0xFFFFFFFFUL << (32 - prefixLen);
+  *net_p = addr & *mask_p;
+} /* GetNetParam */
+
+
+
+/**
+***************************************************************************
+* @brief Reads the inactivity timeout, from the flash (pboot)
+*        parameter or else from the block environment.
+*
+* @return  Timeout in ms, 0 = never.
+*
+***************************************************************************
+*/
+static OSTIME GetAutoLogout(void)
+{
+  char buf[PARAM_LENGTH];
+  char *parameter_p;
+  OSTIME timeOut = 0;
+
+  if (GetParam("telnet_autologout", buf))
+  {
+    timeOut = (OSTIME) strtol(buf, 0, 0);
+  }
+  else
+  {
+    parameter_p = get_env(get_bid(current_process()), "telnet_autologout");
+    if (parameter_p)
+    {
+      timeOut = (OSTIME) strtol(parameter_p, 0, 0);
+      OS_free((union SIGNAL **) &parameter_p);
+    }
+  }
+
+  return timeOut;
+} /* GetAutoLogout */
+
+
+
+/**
+***************************************************************************
+* @brief Reads the commands of the result cache, the flash (pboot)
+*        parameters telnet_cache_1 .. telnet_cache_8 on the form
+*        "<seconds> <command>", e.g. "5 ps". Parameters that are not
+*        valid are ignored.
+*
+* @param   cfg_p     Snapshot to fill in.
+*
+***************************************************************************
+*/
+static void GetCacheParams(TELNET_CFG_st *cfg_p)
+{
+  char name[] = "telnet_cache_0";
+  char buf[CFG_CACHE_PARAM_LENGTH];
+  char *ptr;
+  W32 ttl;
+  W32 i;
+
+  cfg_p->cacheCount = 0;
+  for (i = 0; i < CFG_CACHE_MAX; i++)
+  {
+    name[sizeof(name) - 2] = (char) ('1' + i);
+    if (!GetLongParam(name, buf, sizeof(buf)))
+    {
+      continue;
+    }
+
+    ttl = (W32) strtoul(buf, &ptr, 10);
+    if ((ptr == buf) || (*ptr != ' ') || (ttl == 0))
+    {
+      continue;
+    }
+
+    itelnet_CfgNormalise(ptr);
+    if ((*ptr == '\0') || (strlen(ptr) >= CFG_CACHE_CMD_LEN))
+    {
+      continue;
+    }
+
+    cfg_p->cache[cfg_p->cacheCount].ttl =
+      (ttl > MAX_CACHE_TTL) ? MAX_CACHE_TTL : ttl;
+    strcpy(cfg_p->cache[cfg_p->cacheCount].cmd, ptr);
+    cfg_p->cacheCount++;
+  }
+} /* GetCacheParams */
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Loads the configuration snapshot. Parameters that are not set
+*        or not valid get their default values.
+*
+* @param   cfg_p     Snapshot to fill in.
+*
+***************************************************************************
+*/
+void itelnet_CfgLoad(TELNET_CFG_st *cfg_p)
+{
+  char buf[PARAM_LENGTH];
+
+  cfg_p->sendBufferSize = GetNumParam("send_buffer_size", SEND_BUFFER_SIZE,
+                                      MIN_SEND_BUFFER_SIZE,
+                                      MAX_SEND_BUFFER_SIZE);
+  cfg_p->stopDeadline = GetNumParam("telnet_stop_deadline", STOP_DEADLINE,
+                                    0, MAX_STOP_DEADLINE);
+
+  cfg_p->maxPerAddr = GetNumParam("telnet_max_per_addr",
+                                  MAX_CONNECTIONS_PER_ADDR,
+                                  0, MAX_CONNECTIONS);
+  cfg_p->acceptRate = GetNumParam("telnet_accept_rate", ACCEPT_RATE,
+                                  0, 1000);
+  cfg_p->acceptBurst = GetNumParam("telnet_accept_burst", ACCEPT_BURST,
+                                   1, 1000);
+
+  /* At least one connection must be available for everybody */
+  cfg_p->reserved = GetNumParam("telnet_reserved", RESERVED_CONNECTIONS,
+                                0, MAX_CONNECTIONS - 1);
+  GetNetParam("telnet_privileged_net", &cfg_p->privNet, &cfg_p->privMask);
+
+  cfg_p->queueDepth = GetNumParam("telnet_queue_depth", QUEUE_DEPTH,
+                                  0, MI_MAX_WAITING_CLIENTS);
+  cfg_p->queueWait = GetNumParam("telnet_queue_wait", QUEUE_WAIT,
+                                 1, MAX_QUEUE_WAIT);
+
+  cfg_p->rpcPort = GetNumParam("telnet_rpc_port", 0, 0, 65535);
+  GetCacheParams(cfg_p);
+
+  cfg_p->loginEnable = (Boolean) (GetParam("telnet_loginenable", buf) &&
+                                  (strcmp(buf, "yes") == 0));
+  cfg_p->autoLogout = GetAutoLogout();
+  cfg_p->pagerLines = GetNumParam("telnet_pager_lines", MI_PAGER_OFF,
+                                  0, MI_PAGER_MAX_LINES);
+
+  cfg_p->generation = ++generation;
+} /* itelnet_CfgLoad */
+
+
+
+/**
+***************************************************************************
+* @brief Sends the session parameters of the snapshot to a client
+*        process, see MICLIENTCFG.
+*
+* @param   cfg_p     Configuration snapshot.
+* @param   clientPid Client process.
+*
+***************************************************************************
+*/
+void itelnet_CfgSendClient(const TELNET_CFG_st *cfg_p, PROCESS clientPid)
+{
+  union SIGNAL *sig_p;
+  W32 i;
+
+  sig_p = OS_alloc(MICLIENTCFG_S, MICLIENTCFG);
+  sig_p->miclientcfg.loginEnable = cfg_p->loginEnable;
+  sig_p->miclientcfg.autoLogout = cfg_p->autoLogout;
+  sig_p->miclientcfg.generation = cfg_p->generation;
+  sig_p->miclientcfg.pagerLines = cfg_p->pagerLines;
+
+  sig_p->miclientcfg.noOfReadOnly = cfg_p->cacheCount;
+  for (i = 0; i < cfg_p->cacheCount; i++)
+  {
+    strcpy(sig_p->miclientcfg.readOnly[i], cfg_p->cache[i].cmd);
+  }
+  OS_send(&sig_p, clientPid);
+} /* itelnet_CfgSendClient */
+
+
+
+/**
+***************************************************************************
+* @brief Normalises a command in place, for the result cache: leading
+*        and trailing white space is removed, and other white space
+*        becomes one space.
+*
+* @param   cmd_p     Command, terminated.
+*
+***************************************************************************
+*/
+void itelnet_CfgNormalise(char *cmd_p)
+{
+  char *src_p = cmd_p;
+  char *dst_p = cmd_p;
+
+  while (*src_p != '\0')
+  {
+    if ((*src_p == ' ') || (*src_p == '\t') ||
+        (*src_p == '\r') || (*src_p == '\n'))
+    {
+      if ((dst_p > cmd_p) && (dst_p[-1] != ' '))
+      {
+        *dst_p++ = ' ';
+      }
+    }
+    else
+    {
+      *dst_p++ = *src_p;
+    }
+    src_p++;
+  }
+
+  if ((dst_p > cmd_p) && (dst_p[-1] == ' '))
+  {
+    dst_p--;
+  }
+  *dst_p = '\0';
+} /* itelnet_CfgNormalise */
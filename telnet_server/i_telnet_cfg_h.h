@@ -0,0 +1,101 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_cfg_h.h                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the configuration snapshot (flash (pboot)         */
+/*          parameters) of the telnet module.                               */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_CFG_H_H
+#define I_TELNET_CFG_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/* Commands of the result cache, telnet_cache_1 .. telnet_cache_8 */
+#define CFG_CACHE_MAX      MI_READONLY_MAX
+#define CFG_CACHE_CMD_LEN  (MI_RPC_CMD_MAX + 1)
+
+/****************************************************************************/
+/*                           TYPE DEFINITIONS                               */
+/****************************************************************************/
+
+/* Command of the result cache */
+typedef struct TELNET_CACHE_CFG_st
+{
+  W32     ttl;                /* Seconds a result is used */
+  char    cmd[CFG_CACHE_CMD_LEN];  /* Normalised command */
+} TELNET_CACHE_CFG_st;
+
+/* Configuration snapshot, validated */
+typedef struct TELNET_CFG_st
+{
+  /* Server */
+  W32     sendBufferSize;     /* send_buffer_size */
+  W32     stopDeadline;       /* telnet_stop_deadline, s */
+
+  /* Admission control */
+  W32     maxPerAddr;         /* telnet_max_per_addr, 0 = no limit */
+  W32     acceptRate;         /* telnet_accept_rate, 0 = no limit */
+  W32     acceptBurst;        /* telnet_accept_burst */
+  W32     reserved;           /* telnet_reserved */
+  W32     privNet;            /* telnet_privileged_net */
+  W32     privMask;           /* 0 = no privileged network */
+  W32     queueDepth;         /* telnet_queue_depth, 0 = no queue */
+  W32     queueWait;          /* telnet_queue_wait, s */
+
+  /* Command RPC listener */
+  W32     rpcPort;            /* telnet_rpc_port, 0 = off */
+  W32     cacheCount;         /* Commands of the result cache, 0 = off */
+  TELNET_CACHE_CFG_st cache[CFG_CACHE_MAX];
+
+  /* Sessions, sent to the clients in MICLIENTCFG */
+  Boolean loginEnable;        /* telnet_loginenable */
+  OSTIME  autoLogout;         /* telnet_autologout, 0 = never */
+  W32     pagerLines;         /* telnet_pager_lines, 0 = off */
+
+  W32     generation;         /* Incremented for each load */
+} TELNET_CFG_st;
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_SERVER process */
+extern void itelnet_CfgLoad(TELNET_CFG_st *cfg_p);
+extern void itelnet_CfgSendClient(const TELNET_CFG_st *cfg_p, PROCESS clientPid);
+
+/* Used by the IP_TELNET_SERVER, IP_TELNET_RPC and IP_TELNET_CH_n processes */
+extern void itelnet_CfgNormalise(char *cmd_p);
+
+#endif /* I_TELNET_CFG_H_H */
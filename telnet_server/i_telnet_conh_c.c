@@ -0,0 +1,227 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_conh_c.c                                       */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Console handler acquisition for the telnet server
+ */
+
+/**
+ * @file i_telnet_conh_c.c
+ *
+ * The OSmonitor PID is looked up once by IP_TELNET_SERVER and kept
+ * in a cache shared by all IP_TELNET_CH_n processes. The server
+ * attaches to OSmonitor and clears the cache (and hunts again) when
+ * OSmonitor disappears, so the client processes never have to hunt
+ * on the connection path.
+ *
+ * A client process requests its console handler with
+ * itelnet_ConhRequest(), which only sends APPCTRL_INIT. The
+ * APPCTRL_READY reply is received in the client main loop, so a slow
+ * OSmonitor never blocks the client process.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_conh_h.h"
+
+/* Module internal interfaces */
+#include "i_telnet_sig_def.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  CONSTANTS  ------------------------------------*/
+
+#define OSMONITOR_NAME "OSmonitor"
+
+/****************************************************************************/
+/*                           DATA                                           */
+/****************************************************************************/
+
+/*-------------------------  STATIC DATA  ----------------------------------*/
+
+/* Cached OSmonitor PID. Only written by the IP_TELNET_SERVER process. */
+static PROCESS osmonitorPid = 0;
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Starts supervision of OSmonitor. A hunt signal is returned to
+*        the calling process when OSmonitor exists.
+*
+*        Called by IP_TELNET_SERVER at start and when OSmonitor
+*        has been lost. The cache is filled again when the hunt signal
+*        is received, so a new IP_TELNET_SERVER attaches to OSmonitor
+*        also when it takes over from a previous one.
+*
+***************************************************************************
+*/
+void itelnet_ConhSupervise(void)
+{
+  union SIGNAL *sig_p;
+
+  osmonitorPid = 0;
+
+  sig_p = OS_alloc(MIOSMONHUNT_S, MIOSMONHUNT);
+  (void) hunt(OSMONITOR_NAME, 0, NULL, &sig_p);
+} /* itelnet_ConhSupervise */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the hunt and attach signals used for supervision of
+*        OSmonitor.
+*
+* @param   sig_p     Received signal.
+*
+* @return  TRUE if the signal was consumed (it must still be freed
+*          by the caller), FALSE if the signal does not belong to
+*          the OSmonitor supervision.
+*
+***************************************************************************
+*/
+Boolean itelnet_ConhHandleSig(union SIGNAL *sig_p)
+{
+  PROCESS pid;
+
+  pid = OS_sender(&sig_p);
+
+  switch (sig_p->sig_no)
+  {
+    case MIOSMONHUNT:
+      /* OSmonitor found, cache it and detect when it disappears */
+      if (pid != osmonitorPid)
+      {
+        osmonitorPid = pid;
+        (void) attach(NULL, pid);
+      }
+      return TRUE;
+
+    case OS_ATTACH_SIG:
+      if ((pid == osmonitorPid) && (pid != 0))
+      {
+        /* OSmonitor is gone, invalidate the cache and hunt again */
+        APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_9, (W32) pid,
+                            __LINE__, __FILE__,
+                            0);
+        osmonitorPid = 0;
+        itelnet_ConhSupervise();
+        return TRUE;
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  return FALSE;
+} /* itelnet_ConhHandleSig */
+
+
+
+/**
+***************************************************************************
+* @brief Returns the OSmonitor PID. The cached PID is used when
+*        available, otherwise OSmonitor is hunted for.
+*
+* @return  OSE PID for OSmonitor, 0 if OSmonitor does not exist.
+*
+***************************************************************************
+*/
+PROCESS itelnet_ConhOSmonitor(void)
+{
+  PROCESS pid = osmonitorPid;
+
+  if (pid == 0)
+  {
+    if (!hunt(OSMONITOR_NAME, 0, &pid, 0))
+    {
+      pid = 0;
+    }
+  }
+
+  return pid;
+} /* itelnet_ConhOSmonitor */
+
+
+
+/**
+***************************************************************************
+* @brief Requests a console handler from OSmonitor. The function does
+*        not wait for the reply; OSmonitor answers with APPCTRL
+*        (APPCTRL_READY) sent from the new console handler.
+*
+* @return  TRUE if the request was sent,
+*          FALSE if OSmonitor does not exist.
+*
+***************************************************************************
+*/
+Boolean itelnet_ConhRequest(void)
+{
+  union SIGNAL *sig_p;
+  PROCESS OSmonitor_;
+
+  OSmonitor_ = itelnet_ConhOSmonitor();
+  if (OSmonitor_ == 0)
+  {
+    return FALSE;
+  }
+
+  sig_p = OS_alloc(APPCTRL_S, APPCTRL);
+  sig_p->appctrl.data = APPCTRL_INIT;
+  OS_send(&sig_p, OSmonitor_);
+
+  return TRUE;
+} /* itelnet_ConhRequest */
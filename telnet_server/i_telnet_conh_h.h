@@ -0,0 +1,53 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_conh_h.h                                       */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for console handler acquisition (OSmonitor lookup     */
+/*          and APPCTRL_INIT requests) in the telnet module.                */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_CONH_H_H
+#define I_TELNET_CONH_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_SERVER process */
+extern void itelnet_ConhSupervise(void);
+extern Boolean itelnet_ConhHandleSig(union SIGNAL *sig_p);
+
+/* Used by the IP_TELNET_CH_n processes */
+extern PROCESS itelnet_ConhOSmonitor(void);
+extern Boolean itelnet_ConhRequest(void);
+
+#endif /* I_TELNET_CONH_H_H */
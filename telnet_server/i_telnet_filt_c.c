@@ -0,0 +1,610 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_filt_c.c                                       */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Output filters for the telnet client processes
+ */
+
+/**
+ * @file i_telnet_filt_c.c
+ *
+ * A command line may end with one or more filters that are applied to
+ * the output of the command by the client process, so only the wanted
+ * lines are sent to the client:
+ *
+ * @li @c "| grep PATTERN" keeps the lines containing PATTERN. The
+ *     pattern may use ^ (start of line), $ (end of line), . (any
+ *     character) and * (repetition of the previous character); a
+ *     pattern without them is searched as a plain string.
+ * @li @c "| head N" keeps the first N lines. When they have been
+ *     printed the command is aborted in OSmonitor.
+ * @li @c "| tail N" keeps the last N lines, in a ring of
+ *     FILTER_TAIL_SIZE bytes, and prints them when the command
+ *     completes.
+ *
+ * grep must come before head or tail, and only one of head and tail
+ * can be used. A command line with an unknown or invalid filter is
+ * sent to OSmonitor unchanged.
+ *
+ * itelnet_FilterStart() removes the filters from the command before
+ * it is sent. Each APPTEXT of the command is replaced by
+ * itelnet_FilterText() with an APPTEXT holding the filtered lines. The
+ * prompt that completes the command is not filtered.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_filt_h.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/****************************************************************************/
+/*                           LOCAL SUBROUTINES                              */
+/****************************************************************************/
+
+static W32 Line(TELNET_FILTER_st *filt_p, char *out_p, W32 n);
+static W32 Match(const TELNET_FILTER_st *filt_p, const char *text);
+static W32 MatchHere(const char *re, const char *text);
+static W32 MatchStar(char c, const char *re, const char *text);
+static W32 ParseStage(TELNET_FILTER_st *filt_p, const char *stage_p, W32 len);
+static void TailAdd(TELNET_FILTER_st *filt_p, W32 len);
+static void TailDrop(TELNET_FILTER_st *filt_p);
+static W32 TailGet(TELNET_FILTER_st *filt_p, char *out_p, W32 n);
+
+
+
+/**************************************************************************
+ * Internal function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Matches a pattern at the start of a text. Only * recurses, so
+*        the stack used is bounded by the number of * in the pattern.
+*
+* @param   re        Pattern.
+* @param   text      Text.
+*
+* @return  TRUE if the pattern matches.
+*
+***************************************************************************
+*/
+static W32 MatchHere(const char *re, const char *text)
+{
+  for (;;)
+  {
+    if (re[0] == '\0')
+    {
+      return TRUE;
+    }
+
+    if (re[1] == '*')
+    {
+      return MatchStar(re[0], re + 2, text);
+    }
+
+    if ((re[0] == '$') && (re[1] == '\0'))
+    {
+      return (W32) (*text == '\0');
+    }
+
+    if ((*text == '\0') || ((re[0] != '.') && (re[0] != *text)))
+    {
+      return FALSE;
+    }
+
+    re++;
+    text++;
+  }
+} /* MatchHere */
+
+
+
+/**
+***************************************************************************
+* @brief Matches c* followed by a pattern at the start of a text.
+*
+* @param   c         Repeated character, '.' for any.
+* @param   re        Pattern after c*.
+* @param   text      Text.
+*
+* @return  TRUE if the pattern matches.
+*
+***************************************************************************
+*/
+static W32 MatchStar(char c, const char *re, const char *text)
+{
+  do
+  {
+    if (MatchHere(re, text))
+    {
+      return TRUE;
+    }
+  } while ((*text != '\0') && ((*text++ == c) || (c == '.')));
+
+  return FALSE;
+} /* MatchStar */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if a line matches the grep pattern.
+*
+* @param   filt_p    Filter.
+* @param   text      Line.
+*
+* @return  TRUE if the line matches.
+*
+***************************************************************************
+*/
+static W32 Match(const TELNET_FILTER_st *filt_p, const char *text)
+{
+  if (!filt_p->regex)
+  {
+    return (W32) (strstr(text, filt_p->pattern) != NULL);
+  }
+
+  if (filt_p->pattern[0] == '^')
+  {
+    return MatchHere(&filt_p->pattern[1], text);
+  }
+
+  do
+  {
+    if (MatchHere(filt_p->pattern, text))
+    {
+      return TRUE;
+    }
+  } while (*text++ != '\0');
+
+  return FALSE;
+} /* Match */
+
+
+
+/**
+***************************************************************************
+* @brief Parses one filter of a command line, "grep PATTERN", "head N"
+*        or "tail N".
+*
+* @param   filt_p    Filter.
+* @param   stage_p   The filter, after '|'.
+* @param   len       Length of the filter.
+*
+* @return  TRUE if the filter is valid.
+*
+***************************************************************************
+*/
+static W32 ParseStage(TELNET_FILTER_st *filt_p, const char *stage_p, W32 len)
+{
+  const char *arg_p;
+  char *end_p;
+  W32 argLen;
+  W32 value;
+
+  while ((len > 0) && (*stage_p == ' '))
+  {
+    stage_p++;
+    len--;
+  }
+  while ((len > 0) && (stage_p[len - 1] == ' '))
+  {
+    len--;
+  }
+
+  if ((len < 6) || (stage_p[4] != ' '))
+  {
+    return FALSE;
+  }
+
+  arg_p = &stage_p[5];
+  argLen = len - 5;
+  while ((argLen > 0) && (*arg_p == ' '))
+  {
+    arg_p++;
+    argLen--;
+  }
+
+  if (strncmp(stage_p, "grep", 4) == 0)
+  {
+    /* The pattern may be quoted */
+    if ((argLen >= 2) && (arg_p[0] == '"') && (arg_p[argLen - 1] == '"'))
+    {
+      arg_p++;
+      argLen -= 2;
+    }
+
+    if (filt_p->grep || filt_p->head || filt_p->tail ||
+        (argLen == 0) || (argLen >= FILTER_PATTERN_MAX))
+    {
+      return FALSE;
+    }
+
+    memcpy(filt_p->pattern, arg_p, argLen);
+    filt_p->pattern[argLen] = '\0';
+    filt_p->grep = TRUE;
+    filt_p->regex = (W32) (strpbrk(filt_p->pattern, "^$.*") != NULL);
+    return TRUE;
+  }
+
+  if ((strncmp(stage_p, "head", 4) != 0) && (strncmp(stage_p, "tail", 4) != 0))
+  {
+    return FALSE;
+  }
+
+  value = (W32) strtoul(arg_p, &end_p, 10);
+  if (filt_p->head || filt_p->tail || (end_p != arg_p + argLen) ||
+      (value == 0) || (value > FILTER_MAX_LINES))
+  {
+    return FALSE;
+  }
+
+  if (stage_p[0] == 'h')
+  {
+    filt_p->head = value;
+  }
+  else
+  {
+    filt_p->tail = value;
+  }
+  return TRUE;
+} /* ParseStage */
+
+
+
+/**
+***************************************************************************
+* @brief Removes the oldest line from the tail ring.
+*
+* @param   filt_p    Filter.
+*
+***************************************************************************
+*/
+static void TailDrop(TELNET_FILTER_st *filt_p)
+{
+  /* Skip the line break and the line up to the next line break */
+  do
+  {
+    filt_p->tailStart = (filt_p->tailStart + 1) % FILTER_TAIL_SIZE;
+    filt_p->tailLen--;
+  } while ((filt_p->tailLen > 0) &&
+           (filt_p->tailBuf[filt_p->tailStart] != '\n'));
+
+  filt_p->tailLines--;
+} /* TailDrop */
+
+
+
+/**
+***************************************************************************
+* @brief Adds the received line to the tail ring. The oldest lines are
+*        dropped if the ring is full or has N lines.
+*
+* @param   filt_p    Filter.
+* @param   len       Length of the line.
+*
+***************************************************************************
+*/
+static void TailAdd(TELNET_FILTER_st *filt_p, W32 len)
+{
+  W32 pos;
+  W32 i;
+
+  while ((filt_p->tailLines >= filt_p->tail) ||
+         (filt_p->tailLen + len + 1 > FILTER_TAIL_SIZE))
+  {
+    TailDrop(filt_p);
+  }
+
+  pos = (filt_p->tailStart + filt_p->tailLen) % FILTER_TAIL_SIZE;
+  filt_p->tailBuf[pos] = '\n';
+  for (i = 0; i < len; i++)
+  {
+    pos = (pos + 1) % FILTER_TAIL_SIZE;
+    filt_p->tailBuf[pos] = filt_p->line[i];
+  }
+
+  filt_p->tailLen += len + 1;
+  filt_p->tailLines++;
+} /* TailAdd */
+
+
+
+/**
+***************************************************************************
+* @brief Copies the lines of the tail ring to the output and empties
+*        the ring.
+*
+* @param   filt_p    Filter.
+* @param   out_p     Output text.
+* @param   n         Length of the output.
+*
+* @return  New length of the output.
+*
+***************************************************************************
+*/
+static W32 TailGet(TELNET_FILTER_st *filt_p, char *out_p, W32 n)
+{
+  W32 i;
+
+  for (i = 0; i < filt_p->tailLen; i++)
+  {
+    out_p[n++] = filt_p->tailBuf[(filt_p->tailStart + i) % FILTER_TAIL_SIZE];
+  }
+
+  filt_p->tailStart = 0;
+  filt_p->tailLen = 0;
+  filt_p->tailLines = 0;
+
+  return n;
+} /* TailGet */
+
+
+
+/**
+***************************************************************************
+* @brief Filters the received line. A line that passes is added to the
+*        output, or to the tail ring, as a line break and the line.
+*
+* @param   filt_p    Filter.
+* @param   out_p     Output text.
+* @param   n         Length of the output.
+*
+* @return  New length of the output.
+*
+***************************************************************************
+*/
+static W32 Line(TELNET_FILTER_st *filt_p, char *out_p, W32 n)
+{
+  W32 len = filt_p->lineLen;
+
+  filt_p->line[len] = '\0';
+  filt_p->lineLen = 0;
+
+  /* The output starts on the line of the command */
+  if (!filt_p->started)
+  {
+    filt_p->started = TRUE;
+    if (len == 0)
+    {
+      return n;
+    }
+  }
+
+  if (filt_p->grep && !Match(filt_p, filt_p->line))
+  {
+    return n;
+  }
+
+  if (filt_p->head)
+  {
+    if (filt_p->lines >= filt_p->head)
+    {
+      return n;
+    }
+    filt_p->lines++;
+  }
+
+  if (filt_p->tail)
+  {
+    TailAdd(filt_p, len);
+    return n;
+  }
+
+  out_p[n++] = '\n';
+  memcpy(&out_p[n], filt_p->line, len);
+
+  return n + len;
+} /* Line */
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Removes the filters from the end of a command line and
+*        returns the filter to apply to the output of the command.
+*
+* @param   cmd       Command line, changed if it has filters.
+*
+* @return  Filter, NULL if the command line has no valid filters.
+*
+***************************************************************************
+*/
+TELNET_FILTER_st *itelnet_FilterStart(char *cmd)
+{
+  TELNET_FILTER_st *filt_p;
+  char *bar_p;
+  char *stage_p;
+  char *next_p;
+
+  bar_p = strchr(cmd, '|');
+  if (bar_p == NULL)
+  {
+    return NULL;
+  }
+
+  filt_p = (TELNET_FILTER_st *) OS_alloc(sizeof(TELNET_FILTER_st), 0);
+  memset(filt_p, 0, sizeof(TELNET_FILTER_st));
+
+  for (stage_p = bar_p + 1; stage_p != NULL; stage_p = next_p)
+  {
+    next_p = strchr(stage_p, '|');
+    if (!ParseStage(filt_p, stage_p,
+                    (next_p != NULL) ? (W32) (next_p - stage_p) :
+                                       (W32) strlen(stage_p)))
+    {
+      /* Not a filter, OSmonitor gets the whole line */
+      OS_free((union SIGNAL **) &filt_p);
+      return NULL;
+    }
+
+    if (next_p != NULL)
+    {
+      next_p++;
+    }
+  }
+
+  /* Remove the filters */
+  *bar_p = '\0';
+  while ((bar_p > cmd) && (*(bar_p - 1) == ' '))
+  {
+    *--bar_p = '\0';
+  }
+
+  return filt_p;
+} /* itelnet_FilterStart */
+
+
+
+/**
+***************************************************************************
+* @brief Filters an APPTEXT. The signal is replaced with one holding
+*        the lines that pass the filter, with the same ctrl. A line
+*        split over several APPTEXT signals is kept until it is
+*        complete.
+*
+* @param   filt_p    Filter.
+* @param   sig_pp    APPTEXT, replaced with the filtered text.
+* @param   bodyLen   Length of the text to filter, the rest (the prompt)
+*                    is passed unchanged.
+* @param   last      TRUE if the text completes the command. The last
+*                    line and the tail are output.
+*
+* @return  TRUE if head got all its lines with this text, so the rest
+*          of the output is not needed.
+*
+***************************************************************************
+*/
+W32 itelnet_FilterText(TELNET_FILTER_st *filt_p, union SIGNAL **sig_pp,
+                       W32 bodyLen, W32 last)
+{
+  const char *text = (*sig_pp)->apptext.text;
+  union SIGNAL *out_p;
+  char *outText;
+  W32 headFull;
+  W32 size;
+  W32 n = 0;
+  W32 i;
+
+  headFull = (W32) (filt_p->head && (filt_p->lines >= filt_p->head));
+
+  /* A passed line is at most one longer than in the input */
+  size = bodyLen + FILTER_LINE_MAX + 2;
+  if (last)
+  {
+    size += FILTER_TAIL_SIZE + strlen(&text[bodyLen]);
+  }
+
+  out_p = OS_alloc(APPTEXT_S + size, APPTEXT); /*lint !e737*/
+  out_p->apptext.ctrl = (*sig_pp)->apptext.ctrl;
+  outText = (char *) out_p->apptext.text;
+
+  for (i = 0; i < bodyLen; i++)
+  {
+    if (text[i] == '\n')
+    {
+      n = Line(filt_p, outText, n);
+    }
+    else if ((text[i] != '\r') && (filt_p->lineLen < FILTER_LINE_MAX - 1))
+    {
+      filt_p->line[filt_p->lineLen++] = text[i];
+    }
+  }
+
+  if (last)
+  {
+    if (filt_p->lineLen > 0)
+    {
+      n = Line(filt_p, outText, n);
+    }
+    if (filt_p->tail)
+    {
+      n = TailGet(filt_p, outText, n);
+    }
+
+    strcpy(&outText[n], &text[bodyLen]);
+  }
+  else
+  {
+    outText[n] = '\0';
+  }
+
+  OS_free(sig_pp);
+  *sig_pp = out_p;
+
+  return (W32) (!headFull && filt_p->head && (filt_p->lines >= filt_p->head));
+} /* itelnet_FilterText */
+
+
+
+/**
+***************************************************************************
+* @brief Frees the filter of a command.
+*
+* @param   filt_pp   Filter, set to NULL.
+*
+***************************************************************************
+*/
+void itelnet_FilterEnd(TELNET_FILTER_st **filt_pp)
+{
+  if (*filt_pp != NULL)
+  {
+    OS_free((union SIGNAL **) filt_pp);
+    *filt_pp = NULL;
+  }
+} /* itelnet_FilterEnd */
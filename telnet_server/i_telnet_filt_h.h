@@ -0,0 +1,89 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_filt_h.h                                       */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the output filters (grep, head, tail) of the      */
+/*          IP_TELNET_CH_n processes.                                       */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_FILT_H_H
+#define I_TELNET_FILT_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/* Max length of a grep pattern */
+#define FILTER_PATTERN_MAX 64
+
+/* Max length of a filtered line, longer lines are cut */
+#define FILTER_LINE_MAX    256
+
+/* Size of the tail ring, older lines are dropped when it is full */
+#define FILTER_TAIL_SIZE   4096
+
+/* Max lines of head and tail */
+#define FILTER_MAX_LINES   1000
+
+/****************************************************************************/
+/*                           TYPE DEFINITIONS                               */
+/****************************************************************************/
+
+/* Output filter of a command, allocated by itelnet_FilterStart */
+typedef struct TELNET_FILTER_st
+{
+  W32     grep;                 /* Lines must match the pattern */
+  W32     regex;                /* Pattern has ^ $ . or * */
+  char    pattern[FILTER_PATTERN_MAX];
+  W32     head;                 /* Lines of head, 0 = none */
+  W32     tail;                 /* Lines of tail, 0 = none */
+  W32     lines;                /* Lines passed by head */
+  W32     started;              /* First line of the output seen */
+  W32     lineLen;              /* Line being received */
+  char    line[FILTER_LINE_MAX];
+  W32     tailStart;            /* Tail ring, lines stored as '\n' line */
+  W32     tailLen;
+  W32     tailLines;
+  char    tailBuf[FILTER_TAIL_SIZE];
+} TELNET_FILTER_st;
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_CH_n processes */
+extern TELNET_FILTER_st *itelnet_FilterStart(char *cmd);
+extern W32 itelnet_FilterText(TELNET_FILTER_st *filt_p, union SIGNAL **sig_pp,
+                              W32 bodyLen, W32 last);
+extern void itelnet_FilterEnd(TELNET_FILTER_st **filt_pp);
+
+#endif /* I_TELNET_FILT_H_H */
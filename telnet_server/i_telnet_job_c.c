@@ -0,0 +1,619 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_job_c.c                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Background jobs of the telnet client processes
+ */
+
+/**
+ * @file i_telnet_job_c.c
+ *
+ * A command line ending with '&' is run as a background job. The job
+ * has a console handler of its own, requested from OSmonitor like the
+ * console handler of the session, so the session can run other
+ * commands meanwhile. The output of the job is kept in a buffer of
+ * JOB_BUF_SIZE bytes until it is retrieved with "output" or "fg".
+ * When one more text of the size of the last one would not fit in the
+ * buffer, the flow control acknowledge (APPCTRL_ACK) is held, so the
+ * console handler waits instead of the output being lost. A text that
+ * does not fit anyway, being larger or sent without APPTEXT_ACK, makes
+ * the buffer grow; no output is dropped.
+ *
+ * The console handler of a finished job is kept for the next job of
+ * the session.
+ *
+ * In parallel mode the client process also runs buffered commands of
+ * the session ahead as jobs (queued), which are not listed to the
+ * user; their output is printed in order when the command is due.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_job_h.h"
+
+/* Module internal interfaces */
+#include "i_telnet_conh_h.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+
+#include <string.h>
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  MACROS  ---------------------------------------*/
+
+/* TRUE if start sequence number a is before b, wrap-around safe */
+#define SEQ_BEFORE(a, b) ((W32)((a) - (b)) >= 0x80000000UL)
+
+/****************************************************************************/
+/*                           LOCAL SUBROUTINES                              */
+/****************************************************************************/
+
+static void SendCmd(TELNET_JOB_st *job_p);
+static void SendAck(const TELNET_JOB_st *job_p);
+static void GrowBuf(TELNET_JOB_st *job_p, W32 len);
+
+
+
+/**************************************************************************
+ * Internal function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Sends the command of a job to its console handler.
+*
+* @param   job_p     Job, with a console handler.
+*
+***************************************************************************
+*/
+static void SendCmd(TELNET_JOB_st *job_p)
+{
+  union SIGNAL *sig_p;
+
+  sig_p = OS_alloc(APPCMD_S + strlen(job_p->cmd) + 1, APPCMD); /*lint !e737*/
+  strcpy((char*) sig_p->appcmd.cmd, job_p->cmd);
+  OS_send(&sig_p, job_p->conh_);
+
+  job_p->state = JOB_RUNNING;
+} /* SendCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Sends the flow control acknowledge (APPCTRL_ACK) of an
+*        APPTEXT to the console handler of a job.
+*
+* @param   job_p     Job.
+*
+***************************************************************************
+*/
+static void SendAck(const TELNET_JOB_st *job_p)
+{
+  union SIGNAL *sig_p;
+
+  sig_p = OS_alloc(APPCTRL_S, APPCTRL);
+  sig_p->appctrl.data = APPCTRL_ACK;
+  OS_send(&sig_p, job_p->conh_);
+} /* SendAck */
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Makes room in the output buffer of a job for a text. The
+*        buffer is at least doubled when it grows.
+*
+* @param   job_p     Job.
+* @param   len       Length of the text.
+*
+***************************************************************************
+*/
+static void GrowBuf(TELNET_JOB_st *job_p, W32 len)
+{
+  char *buf_p;
+  W32 size;
+
+  if (job_p->len + len < job_p->size)
+  {
+    return;
+  }
+
+  size = job_p->size * 2;
+  if (size <= job_p->len + len)
+  {
+    size = job_p->len + len + 1;
+  }
+
+  buf_p = (char *) OS_alloc(size, 0);
+  memcpy(buf_p, job_p->buf_p, job_p->len);
+  OS_free((union SIGNAL **) &job_p->buf_p);
+  job_p->buf_p = buf_p;
+  job_p->size = size;
+} /* GrowBuf */
+
+
+
+/**
+***************************************************************************
+* @brief Initializes the background jobs of a session.
+*
+* @param   jobs_p    Jobs of the session.
+*
+***************************************************************************
+*/
+void itelnet_JobInit(TELNET_JOBS_st *jobs_p)
+{
+  W32 i;
+
+  memset(jobs_p, 0, sizeof(*jobs_p));
+  for (i = 0; i < JOB_MAX; i++)
+  {
+    jobs_p->job[i].id = i + 1;
+    jobs_p->job[i].state = JOB_FREE;
+  }
+} /* itelnet_JobInit */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if a command line is to be run as a background job,
+*        i.e. if it ends with '&'. The '&' is then removed.
+*
+* @param   cmd       Command line.
+*
+* @return  TRUE if the command is a background job.
+*
+***************************************************************************
+*/
+W32 itelnet_JobIsBackground(char *cmd)
+{
+  W32 len;
+
+  len = strlen(cmd);
+  while ((len > 0) && (cmd[len - 1] == ' '))
+  {
+    len--;
+  }
+
+  if ((len < 2) || (cmd[len - 1] != '&'))
+  {
+    return FALSE;
+  }
+
+  len--;
+  while ((len > 0) && (cmd[len - 1] == ' '))
+  {
+    len--;
+  }
+  cmd[len] = '\0';
+
+  return (W32) (len > 0);
+} /* itelnet_JobIsBackground */
+
+
+
+/**
+***************************************************************************
+* @brief Starts a background job. The command is sent at once if a
+*        console handler is kept from an earlier job, else when the
+*        requested console handler is ready (itelnet_JobReady).
+*
+* @param   jobs_p    Jobs of the session.
+* @param   cmd       Command.
+*
+* @return  The job, NULL if the command is too long, all jobs are used
+*          or OSmonitor does not exist.
+*
+***************************************************************************
+*/
+TELNET_JOB_st *itelnet_JobStart(TELNET_JOBS_st *jobs_p, const char *cmd)
+{
+  TELNET_JOB_st *job_p = NULL;
+  W32 i;
+
+  if (strlen(cmd) >= JOB_CMD_MAX)
+  {
+    return NULL;
+  }
+
+  /* A free job with a console handler is preferred */
+  for (i = 0; i < JOB_MAX; i++)
+  {
+    if (jobs_p->job[i].state == JOB_FREE)
+    {
+      if ((job_p == NULL) || (jobs_p->job[i].conh_ != 0))
+      {
+        job_p = &jobs_p->job[i];
+      }
+      if (job_p->conh_ != 0)
+      {
+        break;
+      }
+    }
+  }
+
+  if (job_p == NULL)
+  {
+    return NULL;
+  }
+
+  if ((job_p->conh_ == 0) && !itelnet_ConhRequest())
+  {
+    return NULL;
+  }
+
+  strcpy(job_p->cmd, cmd);
+  job_p->seq = jobs_p->nextSeq++;
+  job_p->queued = FALSE;
+  job_p->aborted = FALSE;
+  job_p->ackHeld = FALSE;
+  job_p->len = 0;
+  job_p->size = JOB_BUF_SIZE;
+  job_p->buf_p = (char *) OS_alloc(JOB_BUF_SIZE, 0);
+
+  if (job_p->conh_ != 0)
+  {
+    SendCmd(job_p);
+  }
+  else
+  {
+    job_p->state = JOB_STARTING;
+  }
+
+  return job_p;
+} /* itelnet_JobStart */
+
+
+
+/**
+***************************************************************************
+* @brief Handles a console handler ready (APPCTRL_READY) for a job.
+*        OSmonitor answers the requests in order, so the console
+*        handler is given to the job that has waited the longest.
+*
+* @param   jobs_p    Jobs of the session.
+* @param   conh_     The new console handler.
+*
+* @return  TRUE if a job was waiting for the console handler.
+*
+***************************************************************************
+*/
+W32 itelnet_JobReady(TELNET_JOBS_st *jobs_p, PROCESS conh_)
+{
+  TELNET_JOB_st *job_p = NULL;
+  W32 i;
+
+  for (i = 0; i < JOB_MAX; i++)
+  {
+    if ((jobs_p->job[i].state == JOB_STARTING) &&
+        ((job_p == NULL) ||
+         SEQ_BEFORE(jobs_p->job[i].seq, job_p->seq)))
+    {
+      job_p = &jobs_p->job[i];
+    }
+  }
+
+  if (job_p == NULL)
+  {
+    return FALSE;
+  }
+
+  job_p->conh_ = conh_;
+  if (job_p->aborted)
+  {
+    /* Aborted while waiting, the console handler is kept */
+    itelnet_JobFree(job_p, conh_);
+    return TRUE;
+  }
+  SendCmd(job_p);
+
+  return TRUE;
+} /* itelnet_JobReady */
+
+
+
+/**
+***************************************************************************
+* @brief Finds the job of a console handler.
+*
+* @param   jobs_p    Jobs of the session.
+* @param   conh_     Console handler, the sender of an APPTEXT.
+*
+* @return  The job, NULL if the console handler is not used by a job.
+*
+***************************************************************************
+*/
+TELNET_JOB_st *itelnet_JobFind(TELNET_JOBS_st *jobs_p, PROCESS conh_)
+{
+  W32 i;
+
+  if (conh_ == 0)
+  {
+    return NULL;
+  }
+
+  for (i = 0; i < JOB_MAX; i++)
+  {
+    if (jobs_p->job[i].conh_ == conh_)
+    {
+      return &jobs_p->job[i];
+    }
+  }
+
+  return NULL;
+} /* itelnet_JobFind */
+
+
+
+/**
+***************************************************************************
+* @brief Gets a background job by its number. Queued commands of the
+*        session are not background jobs.
+*
+* @param   jobs_p    Jobs of the session.
+* @param   id        Job number, 0 for the job started last.
+*
+* @return  The job, NULL if there is no such job.
+*
+***************************************************************************
+*/
+TELNET_JOB_st *itelnet_JobGet(TELNET_JOBS_st *jobs_p, W32 id)
+{
+  TELNET_JOB_st *job_p = NULL;
+  W32 i;
+
+  if (id > JOB_MAX)
+  {
+    return NULL;
+  }
+
+  if (id > 0)
+  {
+    job_p = &jobs_p->job[id - 1];
+    return ((job_p->state != JOB_FREE) && !job_p->queued) ? job_p : NULL;
+  }
+
+  for (i = 0; i < JOB_MAX; i++)
+  {
+    if ((jobs_p->job[i].state != JOB_FREE) && !jobs_p->job[i].queued &&
+        ((job_p == NULL) ||
+         SEQ_BEFORE(job_p->seq, jobs_p->job[i].seq)))
+    {
+      job_p = &jobs_p->job[i];
+    }
+  }
+
+  return job_p;
+} /* itelnet_JobGet */
+
+
+
+/**
+***************************************************************************
+* @brief Keeps an APPTEXT of a job. The acknowledge is held when one
+*        more text of this size would not fit in JOB_BUF_SIZE bytes;
+*        a text that does not fit makes the buffer grow. An aborted
+*        job is freed when its command completes.
+*
+* @param   job_p     Job.
+* @param   text      Output, the prompt not included.
+* @param   len       Length of the output.
+* @param   completed TRUE if the text completes the command.
+* @param   ackReq    TRUE if APPCTRL_ACK is requested.
+*
+***************************************************************************
+*/
+void itelnet_JobText(TELNET_JOB_st *job_p, const char *text, W32 len,
+                     W32 completed, W32 ackReq)
+{
+  if (job_p->aborted)
+  {
+    if (ackReq)
+    {
+      SendAck(job_p);
+    }
+    if (completed)
+    {
+      itelnet_JobFree(job_p, job_p->conh_);
+    }
+    return;
+  }
+
+  if (job_p->state == JOB_RUNNING)
+  {
+    GrowBuf(job_p, len);
+    memcpy(&job_p->buf_p[job_p->len], text, len);
+    job_p->len += len;
+
+    if (completed)
+    {
+      job_p->state = JOB_DONE;
+    }
+  }
+
+  if (ackReq)
+  {
+    /* The next text is judged to be as large as this one */
+    if ((job_p->state == JOB_RUNNING) &&
+        (job_p->len + len >= JOB_BUF_SIZE))
+    {
+      job_p->ackHeld = TRUE;
+    }
+    else
+    {
+      SendAck(job_p);
+    }
+  }
+} /* itelnet_JobText */
+
+
+
+/**
+***************************************************************************
+* @brief Takes the output kept of a job, as an APPTEXT to be printed
+*        by the session. The buffer is emptied, shrunk to JOB_BUF_SIZE
+*        if it has grown, and a held acknowledge is sent.
+*
+* @param   job_p     Job.
+* @param   prompt    Prompt to end the text with, which then completes
+*                    the command (APPTEXT_RDY). NULL for no prompt.
+*
+* @return  The APPTEXT.
+*
+***************************************************************************
+*/
+union SIGNAL *itelnet_JobOutput(TELNET_JOB_st *job_p, const char *prompt)
+{
+  union SIGNAL *sig_p;
+  W32 size;
+
+  size = job_p->len + 1;
+  if (prompt != NULL)
+  {
+    size += strlen(prompt);
+  }
+
+  sig_p = OS_alloc(APPTEXT_S + size, APPTEXT); /*lint !e737*/
+  sig_p->apptext.ctrl = 0;
+  memcpy(sig_p->apptext.text, job_p->buf_p, job_p->len);
+  sig_p->apptext.text[job_p->len] = '\0';
+
+  if (prompt != NULL)
+  {
+    strcat(sig_p->apptext.text, prompt);
+    sig_p->apptext.ctrl = APPTEXT_RDY;
+  }
+
+  job_p->len = 0;
+  if (job_p->size > JOB_BUF_SIZE)
+  {
+    OS_free((union SIGNAL **) &job_p->buf_p);
+    job_p->buf_p = (char *) OS_alloc(JOB_BUF_SIZE, 0);
+    job_p->size = JOB_BUF_SIZE;
+  }
+
+  if (job_p->ackHeld)
+  {
+    job_p->ackHeld = FALSE;
+    SendAck(job_p);
+  }
+
+  return sig_p;
+} /* itelnet_JobOutput */
+
+
+
+/**
+***************************************************************************
+* @brief Aborts the command of a job (APPCTRL_ABORT). The output is
+*        dropped and the job is freed when the command completes.
+*
+* @param   job_p     Job.
+*
+***************************************************************************
+*/
+void itelnet_JobAbort(TELNET_JOB_st *job_p)
+{
+  union SIGNAL *sig_p;
+
+  if (job_p->state == JOB_DONE)
+  {
+    itelnet_JobFree(job_p, job_p->conh_);
+    return;
+  }
+
+  if (job_p->state == JOB_RUNNING)
+  {
+    sig_p = OS_alloc(APPCTRL_S, APPCTRL);
+    sig_p->appctrl.data = APPCTRL_ABORT;
+    OS_send(&sig_p, job_p->conh_);
+
+    if (job_p->ackHeld)
+    {
+      job_p->ackHeld = FALSE;
+      SendAck(job_p);
+    }
+  }
+
+  job_p->aborted = TRUE;
+} /* itelnet_JobAbort */
+
+
+
+/**
+***************************************************************************
+* @brief Ends a job. The console handler given is kept for the next
+*        job.
+*
+* @param   job_p     Job.
+* @param   conh_     Console handler to keep, 0 if none.
+*
+***************************************************************************
+*/
+void itelnet_JobFree(TELNET_JOB_st *job_p, PROCESS conh_)
+{
+  if (job_p->buf_p != NULL)
+  {
+    OS_free((union SIGNAL **) &job_p->buf_p);
+    job_p->buf_p = NULL;
+  }
+
+  job_p->state = JOB_FREE;
+  job_p->conh_ = conh_;
+  job_p->len = 0;
+  job_p->queued = FALSE;
+  job_p->aborted = FALSE;
+  job_p->ackHeld = FALSE;
+} /* itelnet_JobFree */
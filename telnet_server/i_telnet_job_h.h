@@ -0,0 +1,110 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_job_h.h                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the background jobs ("<cmd> &") of the            */
+/*          IP_TELNET_CH_n processes.                                       */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_JOB_H_H
+#define I_TELNET_JOB_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/* Max number of background jobs of a session, including the commands
+   run ahead in parallel mode */
+#define JOB_MAX            8
+
+/* Max length of the command of a job */
+#define JOB_CMD_MAX        64
+
+/* Size of the output kept of a job. APPCTRL_ACK is held when one
+   more text of the size of the last one would not fit, so the command
+   waits until the output is retrieved. Texts that do not fit anyway
+   make the buffer grow. */
+#define JOB_BUF_SIZE       4096
+
+/* State of a job slot */
+#define JOB_FREE           0    /* conh_ may be kept for the next job */
+#define JOB_STARTING       1    /* APPCTRL_INIT sent, no reply yet */
+#define JOB_RUNNING        2
+#define JOB_DONE           3
+
+/****************************************************************************/
+/*                           TYPE DEFINITIONS                               */
+/****************************************************************************/
+
+/* Background job, with a console handler of its own */
+typedef struct TELNET_JOB_st
+{
+  W32     state;                /* JOB_FREE/STARTING/RUNNING/DONE */
+  W32     id;                   /* Job number shown to the user */
+  W32     seq;                  /* Order of the starts of the jobs */
+  PROCESS conh_;                /* Console handler, 0 if none */
+  W32     queued;               /* Command of the session run ahead
+                                   (parallel mode), not listed */
+  W32     aborted;              /* Output dropped, freed when done */
+  W32     ackHeld;              /* APPCTRL_ACK held, the buffer is full */
+  W32     size;                 /* Size of buf_p, JOB_BUF_SIZE or more */
+  W32     len;                  /* Bytes in buf_p */
+  char    *buf_p;               /* Output */
+  char    cmd[JOB_CMD_MAX];
+} TELNET_JOB_st;
+
+/* Background jobs of a session */
+typedef struct TELNET_JOBS_st
+{
+  W32     nextSeq;
+  TELNET_JOB_st job[JOB_MAX];
+} TELNET_JOBS_st;
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_CH_n processes */
+extern void itelnet_JobInit(TELNET_JOBS_st *jobs_p);
+extern W32 itelnet_JobIsBackground(char *cmd);
+extern TELNET_JOB_st *itelnet_JobStart(TELNET_JOBS_st *jobs_p, const char *cmd);
+extern W32 itelnet_JobReady(TELNET_JOBS_st *jobs_p, PROCESS conh_);
+extern TELNET_JOB_st *itelnet_JobFind(TELNET_JOBS_st *jobs_p, PROCESS conh_);
+extern TELNET_JOB_st *itelnet_JobGet(TELNET_JOBS_st *jobs_p, W32 id);
+extern void itelnet_JobText(TELNET_JOB_st *job_p, const char *text, W32 len,
+                            W32 completed, W32 ackReq);
+extern union SIGNAL *itelnet_JobOutput(TELNET_JOB_st *job_p,
+                                       const char *prompt);
+extern void itelnet_JobAbort(TELNET_JOB_st *job_p);
+extern void itelnet_JobFree(TELNET_JOB_st *job_p, PROCESS conh_);
+
+#endif /* I_TELNET_JOB_H_H */
@@ -73,10 +73,20 @@
  *
  * @section telnetModSourceFileStructure Source File Structure
  *
- * The module consists of three C-modules:
+ * The module consists of the following C-modules:
  * @li @c i_telnet_main_c.c
  * @li @c i_telnetproc_c.c
  * @li @c i_telnet_ledit_c.c
+ * @li @c i_telnet_conh_c.c
+ * @li @c i_telnet_tmo_c.c
+ * @li @c i_telnet_cfg_c.c
+ * @li @c i_telnet_auth_c.c
+ * @li @c i_telnet_opt_c.c
+ * @li @c i_telnet_filt_c.c
+ * @li @c i_telnet_watch_c.c
+ * @li @c i_telnet_job_c.c
+ * @li @c i_telnet_paste_c.c
+ * @li @c i_telnet_rpc_c.c
  *
  * @section telnetModDataStructure Data Structures
  *
@@ -90,6 +100,15 @@
  * The ownership of the socket is transferred to the child process
  * and the connection is after this handled by the child process.
  *
+ * When the user is logged in, the client process requests a console
+ * handler from OSmonitor (APPCTRL_INIT). The client does not wait for
+ * the reply; the APPCTRL_READY reply is handled in the main loop and
+ * commands typed before it arrives are buffered. If OSmonitor aborts
+ * the request, or does not reply within CONH_REQ_TIMEOUT, the buffered
+ * commands are discarded and the next command requests a console
+ * handler again. The OSmonitor PID is cached by the server process,
+ * see i_telnet_conh_c.c.
+ *
  * The TIP stack informs the telnet process when data has been received
  * from the client. The data is fetched from the TIP stack (tip_read) and
  * sent on to the OSmonitor function in the RP (signal APPCMD). 
@@ -104,6 +123,109 @@
  * In case the TIP stack reports it couldn't send all the data it was
  * requested to send, the telnet process calls tip_write with the
  * reminder when the TIP stack reports it is ready to send again.
+ * Echo of the user input that cannot be written is kept in an echo
+ * queue, which is always sent before the rest of the printout, so
+ * typing is echoed without waiting for a large printout. The queue
+ * grows as needed; while it is large the client is not read.
+ *
+ * CTRL_C (or IAC IP) aborts the command in OSmonitor (APPCTRL_ABORT),
+ * discards the commands typed ahead and drops the output that has not
+ * been sent; IAC AO only drops the output. The rest of the output of
+ * the command is acknowledged and discarded until the prompt arrives,
+ * and Synch (IAC DM) makes the client discard what is already sent.
+ *
+ * XOFF (CTRL_S) pauses the output and XON (CTRL_Q) resumes it. While
+ * paused, APPTEXT signals are held and APPCTRL_ACK is not sent, so
+ * OSmonitor stops producing output; the texts held are bounded by the
+ * acknowledge withheld and none is dropped. At resume the held signals
+ * are sent to the own process, so they are printed in order by the
+ * normal APPTEXT handling.
+ *
+ * The pager stops the printout when a page is full and writes a
+ * --More-- prompt; space shows the next page, Enter the next line and
+ * q aborts the command. The output is held and acknowledged as when
+ * paused, so OSmonitor does not produce output that is not read. The
+ * page size is set by telnet_pager_lines (0 = off, 1 = window size of
+ * the client from NAWS, otherwise lines), and per session with the
+ * local command "pager [on|off|<lines>]".
+ *
+ * A command line may end with output filters, "| grep PATTERN",
+ * "| head N" and "| tail N". They are removed when the command is sent
+ * and the APPTEXT signals of the command are filtered before they are
+ * written, see i_telnet_filt_c.c. When head has got its lines the
+ * command is aborted and the rest of the output is discarded.
+ *
+ * Local commands (clear, exit, fg, history, jobs, output, pager,
+ * parallel, session, time and watch) are looked up in a hashed table
+ * and run in the client process, without a round trip to the console
+ * handler. Typed while a command is running, they are buffered with
+ * the other commands and run in order; only "exit" is run at once.
+ * The prompt of the console handler is kept from the last completed
+ * printout and printed after a local command.
+ *
+ * The local command "watch N <cmd>" runs a command every N seconds
+ * (MICLIENTWATCH). The output is drawn on a cleared screen the first
+ * time, and then only the changed lines are drawn, see
+ * i_telnet_watch_c.c. Any key ends the watch mode.
+ *
+ * A command line ending with '&' is run as a background job, with a
+ * console handler of its own, see i_telnet_job_c.c. The output of the
+ * job is kept and printed by "output [n]" or "fg [n]", as the output
+ * of a command of the session; "fg" of a running job makes its
+ * console handler the console handler of the session.
+ *
+ * In parallel mode ("parallel N") commands typed ahead (or pasted) are
+ * not only buffered: up to N - 1 of them are run ahead as jobs on
+ * console handlers of their own. When such a command is due its output
+ * is printed as for "fg", so the printouts keep the order of the
+ * commands. Only read-only commands, the ones of the result cache
+ * (telnet_cache_n, sent in MICLIENTCFG), are run ahead, and only while
+ * the commands before them are read-only as well; other commands are
+ * run in order.
+ *
+ * The terminal marks pasted text (xterm bracketed paste). Pasted text
+ * is not passed to the line editor character by character, it is
+ * split into command lines at once and the lines are run or buffered
+ * as typed ones, see i_telnet_paste_c.c.
+ *
+ * In automation mode ("automation on") the session is used by a
+ * program. The input is not echoed or edited, and the output of each
+ * command is written after a header with the number of the command,
+ * the length of the output and whether the command has completed,
+ * so the program does not have to look for the prompt.
+ *
+ * Commands typed ahead are queued without a fixed limit, the APPCMD
+ * is allocated when the command is sent. When the queue gets large
+ * the socket is not read (no TIP_FD_READ), the TCP window closes and
+ * the client stops sending until the queue has drained.
+ *
+ * The inactivity timeout of the sessions is supervised by the telnet
+ * server process with one timer wheel for all sessions, see
+ * i_telnet_tmo_c.c. The client process only records the time of
+ * the last input from the user.
+ *
+ * The flash (pboot) parameters are read once by the telnet server
+ * process into a configuration snapshot, see i_telnet_cfg_c.c. The
+ * client process gets the session parameters (telnet_loginenable,
+ * telnet_autologout) in MICLIENTCFG directly after MISTARTCLIENT, and
+ * again when the configuration is reloaded.
+ *
+ * The login is verified by the IP_TELNET_AUTH process, see
+ * i_telnet_auth_c.c. The client process sends the user name and
+ * password in MIAUTHREQ and keeps handling signals until MIAUTHREPLY
+ * arrives; characters typed meanwhile are discarded.
+ *
+ * Processes on the node (MIRPCREQ), and programs connecting to
+ * telnet_rpc_port when it is set, can also run commands without a
+ * telnet session on the IP_TELNET_RPC process, see i_telnet_rpc_c.c.
+ * It keeps the output of the read-only commands set in telnet_cache_n
+ * for a while, so that many requests for them run the command once.
+ *
+ * The telnet commands and option negotiations in the data from the
+ * client are handled in i_telnet_opt_c.c. When the user has logged
+ * in, LINEMODE is requested. A client supporting it edits and echoes
+ * the command line itself and sends the whole line; otherwise every
+ * character is sent and echoed by the line editor.
  *
  * The telnet server uses the synchronous non-blocking socket          
  * interface to the TIP stack.                                         
@@ -125,16 +247,21 @@
 
 /* Module internal interfaces */
 #include "i_telnet_ledit_h.h"
+#include "i_telnet_conh_h.h"
+#include "i_telnet_tmo_h.h"
+#include "i_telnet_auth_h.h"
+#include "i_telnet_opt_h.h"
+#include "i_telnet_filt_h.h"
+#include "i_telnet_watch_h.h"
+#include "i_telnet_job_h.h"
+#include "i_telnet_paste_h.h"
+#include "i_telnet_cfg_h.h"
+#include "i_telnet_sig_def.h"
+#include "i_def.h"
 
 /* Module external interfaces */
 #include "i_blockproc_h.h"
 
-#ifdef APT_PBOOT_USER
-#include "user_pboot.h"
-#else
-#include "pboot.h"
-#endif
-
 #include "tipsock.h"
 
 /*-------------------------  COMMON DECLARATIONS  --------------------------*/
@@ -151,26 +278,53 @@
 
 /* Max time to wait for input from user */
 #define CLIENT_LOGIN_TIMEOUT 30000  /* 30 seconds */
+#define CONH_REQ_TIMEOUT     10000  /* 10 seconds */
+#define TIME_REQ_TIMEOUT     1000   /* 1 second */
 #define MAX_LOGIN_NAME_LEN 12
 #define MAX_PASSWD_LEN 12
-#define TMO_SIG 77665544
-
-/* TELNET PROTOCOL numbers. */
-#define IAC     ((char) 255)            /* interpret as command: */
-#define DONT    ((char) 254)            /* you are not to use option */
-#define DO      ((char) 253)            /* please, you use option */
-#define WONT    ((char) 252)            /* I won't use option */
-#define WILL    ((char) 251)            /* I will use option */
-#define SB      ((char) 250)            /* interpret as subnegotiation */
-#define SE      ((char) 240)            /* end sub negotiation */
-
-/* telnet options. */
-#define TELOPT_ECHO     1  /* echo */
-#define TELOPT_SGA      3  /* suppress go ahead */
 
 #define CLIENT_STATE_LOGIN 0
 #define CLIENT_STATE_PASSWORD 1
 #define CLIENT_STATE_LOGGEDIN 2
+#define CLIENT_STATE_AUTH 3
+
+/* Echo and control output queue of a client. It grows in blocks of
+   ECHO_BLOCK_SIZE; above ECHO_QUEUE_MAX_BYTES the socket is not read
+   until the queue is down to ECHO_QUEUE_LOW_BYTES. */
+#define ECHO_BLOCK_SIZE      512
+#define ECHO_QUEUE_MAX_BYTES 4096
+#define ECHO_QUEUE_LOW_BYTES 1024
+
+/* Flow control characters */
+#define XON  0x11                       /* CTRL_Q, resume output */
+#define XOFF 0x13                       /* CTRL_S, pause output */
+
+/* Pager */
+#define PAGER_DEFAULT_LINES 24          /* Window size not known */
+#define MORE_PROMPT "--More--"
+#define MORE_ERASE  "\b\b\b\b\b\b\b\b        \b\b\b\b\b\b\b\b"
+
+/* Watch mode */
+#define WATCH_DEFAULT_WIDTH 80          /* Window size not known */
+#define WATCH_MAX_INTERVAL  3600        /* seconds */
+
+/* Local commands */
+#define BUILTIN_HASH_SIZE   16          /* Power of 2, > number of commands */
+#define BUILTIN_EXIT        (-1)        /* Local command ends the session */
+#define PROMPT_MAX          32          /* Longest prompt kept */
+#define DEFAULT_PROMPT      "\r\nOSmon> "  /* Prompt not known yet */
+
+/* Parallel mode, console handlers of a session including its own */
+#define PARALLEL_MAX        JOB_MAX
+
+/* Max length of the header of a result in automation mode */
+#define AUTO_HEADER_MAX     32
+
+/* Commands typed ahead. Above CMD_QUEUE_MAX_BYTES the socket is not
+   read, so TCP stops the client, until the queue is down to
+   CMD_QUEUE_LOW_BYTES. */
+#define CMD_QUEUE_MAX_BYTES 16384
+#define CMD_QUEUE_LOW_BYTES 4096
 
 /*-------------------------  MACROS  ---------------------------------------*/
 
@@ -185,12 +339,133 @@
 
 /*-------------------------  TYPE DEF  -------------------------------------*/
 
-typedef struct LOGIN_st
+/* Kind of a buffered command */
+#define QUEUED_CMD      0               /* Sent to the console handler */
+#define QUEUED_LOCAL    1               /* Local command */
+#define QUEUED_JOB      2               /* Background job, '&' removed */
+
+/* Command typed ahead while another command is running. The APPCMD
+   is built when the command is sent. */
+typedef struct CMD_QUEUE_st
+{
+  struct CMD_QUEUE_st* next_p;
+  TELNET_JOB_st* job_p;                 /* Job when run ahead (parallel
+                                           mode), NULL if not */
+  W32           kind;                   /* QUEUED_CMD/LOCAL/JOB */
+  char          cmd[1];                 /* Allocated to its length */
+} CMD_QUEUE_st;
+
+/* APPTEXT held while the output is stopped */
+typedef struct HELD_TEXT_st
+{
+  struct HELD_TEXT_st* next_p;
+  union SIGNAL* sig_p;
+} HELD_TEXT_st;
+
+/* Block of the echo queue */
+typedef struct ECHO_BLOCK_st
+{
+  struct ECHO_BLOCK_st* next_p;
+  W32           start;                  /* First byte not sent */
+  W32           end;                    /* First free byte */
+  char          buf[ECHO_BLOCK_SIZE];
+} ECHO_BLOCK_st;
+
+/* Echo and control output waiting for the socket. It is sent ahead
+   of the remaining APPTEXT printout at TIP_FD_WRITE. */
+typedef struct ECHO_QUEUE_st
+{
+  int           fd;                     /* Socket of the client */
+  W32           len;                    /* Bytes in the queue */
+  ECHO_BLOCK_st* first_p;               /* Blocks, in order */
+  ECHO_BLOCK_st* last_p;
+} ECHO_QUEUE_st;
+
+/* Command execution data for a client */
+typedef struct CMD_DATA_st
 {
-  int hostecho_s;
-  int peerecho_s;
-  int hostsga_s;
-} LOGIN_st;
+  PROCESS       conh_;                  /* Console handler PID */
+  W32           conhPending;            /* APPCTRL_INIT sent, no reply yet */
+  W32           conhTmoPending;         /* MICLIENTCONHTMO requested */
+  CANCEL_INFO   conhTmo;
+  W32           timePending;            /* "time" waits for REALTIMEGETR,
+                                           MICLIENTTIMETMO requested */
+  CANCEL_INFO   timeTmo;
+  W32           isCmdRunning;           /* Command sent, not completed */
+  W32           localEcho;              /* Input echoed by the client */
+  W32           discardOutput;          /* Command aborted, output dropped */
+  W32           paused;                 /* Output paused by XOFF */
+  W32           ackHeld;                /* APPCTRL_ACK not sent while
+                                           the output is stopped */
+  W32           pager;                  /* Lines per page,
+                                           MI_PAGER_OFF/WINDOW */
+  W32           winWidth;               /* Window size (NAWS), 0 = unknown */
+  W32           winHeight;
+  W32           linesLeft;              /* Lines left on the page */
+  W32           pageEnd;                /* Output stops here in the text */
+  W32           morePrompt;             /* Pager prompt written, output
+                                           stopped until a key */
+  TELNET_FILTER_st* filter_p;           /* Output filter of the running
+                                           command, NULL if none */
+  TELNET_WATCH_st* watch_p;             /* Watch mode, NULL if none */
+  W32           watchTickPending;       /* MICLIENTWATCH requested */
+  CANCEL_INFO   watchTmo;
+  U8            builtinHash[BUILTIN_HASH_SIZE]; /* Index + 1 in builtins,
+                                                   0 = free */
+  char          prompt[PROMPT_MAX];     /* Last prompt of the console
+                                           handler, empty if unknown */
+  OSTICK        startTick;              /* Start of the session */
+  W32           noOfCmds;               /* Commands sent to the console
+                                           handler */
+  W32           noOfLocalCmds;          /* Local commands run */
+  TELNET_JOBS_st jobs;                  /* Background jobs */
+  TELNET_PASTE_st paste;                /* Bracketed paste */
+  W32           automation;             /* Automation mode, results are
+                                           framed */
+  W32           autoBase;               /* noOfCmds when the automation
+                                           mode was turned on */
+  W32           parallel;               /* Commands run at a time, 1 =
+                                           parallel mode off */
+  W32           cmdReadOnly;            /* The running command may be
+                                           overtaken in parallel mode */
+  union SIGNAL* cfg_p;                  /* Last MICLIENTCFG, the
+                                           read-only commands */
+  W32           replay;                 /* Held texts sent to self, not yet
+                                           received again */
+  W32           noOfHeld;               /* Number of held texts */
+  W32           noOfHeldSelf;           /* Of which replayed texts */
+  HELD_TEXT_st* heldFirst_p;            /* Held texts, in order */
+  HELD_TEXT_st* heldLast_p;
+  HELD_TEXT_st* heldSelfLast_p;         /* Last of the replayed texts,
+                                           NULL if none */
+  CMD_QUEUE_st* queueFirst_p;           /* Buffered (awaiting) commands,
+                                           in order */
+  CMD_QUEUE_st* queueLast_p;
+  W32           noOfQueued;             /* Number of buffered commands */
+  W32           queuedBytes;            /* Size of buffered commands */
+  W32           inputStopped;           /* TIP_FD_READ not subscribed,
+                                           the command or echo queue
+                                           is full */
+  ECHO_QUEUE_st* echo_p;                /* Echo queue of the client */
+  CLIENT_PROC_DATA_st* client_p;        /* For the local commands run */
+  cmd_hist*     root_p;                 /* from the buffer */
+  W32           promptPending;          /* Local command done, the prompt
+                                           is printed when no text is
+                                           held or being written */
+} CMD_DATA_st;
+
+/* Local command, run in the client process. Returns the length of
+   the command line to send to the console handler (including the
+   terminating character), 0 if the command is done or BUILTIN_EXIT. */
+typedef int (*BUILTIN_FUNC)(CMD_DATA_st *cmdData_p,
+                            CLIENT_PROC_DATA_st *client_p,
+                            cmd_hist *root_p, char *cmd);
+
+typedef struct BUILTIN_st
+{
+  const char    *name;
+  BUILTIN_FUNC  func;
+} BUILTIN_st;
 
 
 /****************************************************************************/
@@ -200,17 +475,106 @@ typedef struct LOGIN_st
 static int AddCharacter(char ch, char *userName, int *position, const int length);
 static W32 CalcApptextLength(const char *ptr);
 static void CloseConnection(const CLIENT_PROC_DATA_st *const client_p);
-static OSTIME GetTimeout(void);
 static char HandleEscSeq(const char *const string, U32* i);
-static U8 NeedLogin(void);
-static PROCESS ReqConsoleHandler(void);
-static W32 TelnetServerOptions(LOGIN_st* login, int fd, W32 length,
-                               const char *const string);
+static void ReqConsoleHandler(CMD_DATA_st *cmdData_p);
+static void ConsoleHandlerFailed(CMD_DATA_st *cmdData_p, int fd);
+static void RunNextBufCmd(CMD_DATA_st *cmdData_p, int fd, W32 afterText);
+static void RunAhead(CMD_DATA_st *cmdData_p);
+static W32 IsReadOnly(const CMD_DATA_st *cmdData_p, const char *cmd);
+static void SendCommand(CMD_DATA_st *cmdData_p, int fd, const char *cmd,
+                        int commandSize);
+static void QueueCommand(CMD_DATA_st *cmdData_p, int fd, const char *cmd,
+                         W32 kind);
+static void SendBufCmd(CMD_DATA_st *cmdData_p, CMD_QUEUE_st *entry_p);
+static W32 RunBufLocalCmd(CMD_DATA_st *cmdData_p, CMD_QUEUE_st *entry_p);
+static void FreeBufCmds(CMD_DATA_st *cmdData_p, int fd);
+static void StopInput(CMD_DATA_st *cmdData_p, int fd, W32 stop);
+static void ResumeInput(CMD_DATA_st *cmdData_p, int fd);
+static void AbortOutput(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                        union SIGNAL **savedSig_pp, const TELNET_OPT_st *opt_p);
+static W32 IsCmdCompleted(const union SIGNAL *sig_p);
+static W32 LastLineOffset(const char *text);
+static void SendAppAck(const CMD_DATA_st *cmdData_p);
+static void SendAppAbort(const CMD_DATA_st *cmdData_p);
+static W32 FilterAppText(CMD_DATA_st *cmdData_p, union SIGNAL **sig_pp);
+static W32 WatchAppText(CMD_DATA_st *cmdData_p, union SIGNAL **sig_pp);
+static W32 AutoAppText(CMD_DATA_st *cmdData_p, union SIGNAL **sig_pp,
+                       W32 skip);
+static int AutomationCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                         cmd_hist *root_p, char *cmd);
+static int WatchCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                    cmd_hist *root_p, char *cmd);
+static void StopWatch(CMD_DATA_st *cmdData_p,
+                      const union SIGNAL *savedSig_p);
+static void AckAppText(CMD_DATA_st *cmdData_p);
+static void HoldAppText(CMD_DATA_st *cmdData_p, union SIGNAL **sig_pp);
+static void ReplayHeld(CMD_DATA_st *cmdData_p);
+static void ReleaseHeld(CMD_DATA_st *cmdData_p);
+static W32 OutputStopped(const CMD_DATA_st *cmdData_p);
+static W32 PageSize(const CMD_DATA_st *cmdData_p);
+static W32 PageEnd(CMD_DATA_st *cmdData_p, const union SIGNAL *sig_p,
+                   W32 from);
+static void MoreKey(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                    union SIGNAL **savedSig_pp, const TELNET_OPT_st *opt_p,
+                    char ch);
+static int PagerCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                    cmd_hist *root_p, char *cmd);
+static int ClearCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                    cmd_hist *root_p, char *cmd);
+static int ExitCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                   cmd_hist *root_p, char *cmd);
+static int HistoryCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                      cmd_hist *root_p, char *cmd);
+static int SessionCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                      cmd_hist *root_p, char *cmd);
+static int TimeCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                   cmd_hist *root_p, char *cmd);
+static void TimeReply(CMD_DATA_st *cmdData_p, int fd,
+                      const union SIGNAL *sig_p);
+static int JobsCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                   cmd_hist *root_p, char *cmd);
+static int FgCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                 cmd_hist *root_p, char *cmd);
+static int OutputCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                     cmd_hist *root_p, char *cmd);
+static int ParallelCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                       cmd_hist *root_p, char *cmd);
+static TELNET_JOB_st *GetJobArg(CMD_DATA_st *cmdData_p, int fd,
+                                const char *cmd);
+static void ForegroundJob(CMD_DATA_st *cmdData_p, TELNET_JOB_st *job_p);
+static void PrintJobOutput(CMD_DATA_st *cmdData_p, TELNET_JOB_st *job_p,
+                           W32 completed);
+static void StartJob(CMD_DATA_st *cmdData_p, int fd, const char *cmd);
+static void JobAppText(TELNET_JOB_st *job_p, const union SIGNAL *sig_p);
+static W32 BuiltinHash(const char *name, W32 len);
+static void InitBuiltins(CMD_DATA_st *cmdData_p);
+static const BUILTIN_st *FindBuiltin(const CMD_DATA_st *cmdData_p,
+                                     const char *cmd);
+static const BUILTIN_st *FindLocalCmd(const CMD_DATA_st *cmdData_p,
+                                      const char *cmd);
+static void SavePrompt(CMD_DATA_st *cmdData_p, const char *text);
+static void FlushPrompt(CMD_DATA_st *cmdData_p);
+static int RunCommandLine(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                          cmd_hist *root_p, int commandSize);
+static int PasteText(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                     cmd_hist *root_p, const char *data_p, W32 *i_p,
+                     W32 length);
+static void Logout(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                   union SIGNAL **sig_pp);
+static W32 ContinueOutput(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                          union SIGNAL **savedSig_pp);
+static void EndAppText(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                       union SIGNAL **savedSig_pp);
+static W32 WriteError(CLIENT_PROC_DATA_st *client_p, union SIGNAL **savedSig_pp);
+static W32 FlushEcho(ECHO_QUEUE_st *queue_p);
+static void QueueEcho(ECHO_QUEUE_st *queue_p, const char *buf, int bufLen);
+static int NoEcho(int fd, const char *buf, int bufLen);
+static int LEditOutput(int fd, const char *buf, int bufLen);
 static W8 TelnetWrite(int fd, const char *buf, CLIENT_PROC_DATA_st *client_p);
-static void TelnetWriteCmd(int fd, U8 cmd, U8 val);
-static int TelnetWriteSimple(int fd, const char *buf, int bufLen);
-static Boolean ValidateLogin(const char *userName, const char *passWord, OSUSER *user);
-static W32 WrApptextStrSocket(int fd, const char *ptr, CLIENT_PROC_DATA_st *client_p);
+static int TelnetWriteSimple(ECHO_QUEUE_st *queue_p, const char *buf,
+                             int bufLen);
+static W32 WrApptextStrSocket(int fd, const char *ptr, W32 maxLen,
+                              CLIENT_PROC_DATA_st *client_p);
 static int WrStrSocket(int fd, const char *ptr, CLIENT_PROC_DATA_st *client_p);
 
 /****************************************************************************/
@@ -223,6 +587,36 @@ static int WrStrSocket(int fd, const char *ptr, CLIENT_PROC_DATA_st *client_p);
 
 static SIGSELECT any[1] = {0};
 
+/* Echo queues, indexed by client individual. An entry is only used by
+   the client process of the client individual, which keeps a pointer
+   to it (CMD_DATA_st). */
+static ECHO_QUEUE_st echoQueue[MAX_CONNECTIONS];
+
+/* Echo queue of the client process running, for the output of the line
+   editor (LEditOutput). Set by the client process for each signal it
+   receives; the client processes do not preempt each other. */
+static ECHO_QUEUE_st *leditEcho_p = NULL;
+
+/* Local commands. The hash index is built per session, see
+   InitBuiltins(). */
+static const BUILTIN_st builtins[] =
+{
+  {"automation", AutomationCmd},
+  {"clear",    ClearCmd},
+  {"exit",     ExitCmd},
+  {"fg",       FgCmd},
+  {"history",  HistoryCmd},
+  {"jobs",     JobsCmd},
+  {"output",   OutputCmd},
+  {"pager",    PagerCmd},
+  {"parallel", ParallelCmd},
+  {"session",  SessionCmd},
+  {"time",     TimeCmd},
+  {"watch",    WatchCmd}
+};
+
+#define NO_OF_BUILTINS (sizeof(builtins) / sizeof(builtins[0]))
+
 
 
 /**************************************************************************
@@ -284,39 +678,172 @@ static char HandleEscSeq(const char *const string, U32* i)
 
 /**
 ***************************************************************************
-* @brief This function writes a Telnet command to a socket.
+* @brief Output function of the line editor when the client echoes the
+*        command line (LINEMODE). Nothing is written.
 *
 * @param   fd        File descriptor.
-* @param   cmd       Command to write.
-* @param   val       Value.
+* @param   buf       Pointer to string.
+* @param   bufLen    Length of string.
+*
+* @return  0
+*
+***************************************************************************
+*/
+static int NoEcho(int fd, const char *buf, int bufLen) /*lint !e715*/
+{
+  return 0;
+} /* NoEcho */
+
+
+
+/**
+***************************************************************************
+* @brief Output function of the line editor. The output is added to the
+*        echo queue of the running client process (leditEcho_p), which
+*        writes to the socket.
+*
+* @param   fd        Socket, root->fd.
+* @param   buf       Pointer to string.
+* @param   bufLen    Length of string.
+*
+* @return  See TelnetWriteSimple().
 *
 ***************************************************************************
 */
-static void TelnetWriteCmd(int fd, U8 cmd, U8 val)
+static int LEditOutput(int fd, const char *buf, int bufLen)
 {
-  U8 buf[3];
+  (void) fd;
+
+  return TelnetWriteSimple(leditEcho_p, buf, bufLen);
+} /* LEditOutput */
+
 
-  buf[0] = (U8) IAC;
-  buf[1] = cmd;
-  buf[2] = val;
+
+/**
+***************************************************************************
+* @brief Adds echo or control output to the echo queue. The queue grows
+*        by a block when the last one is full, nothing is dropped; the
+*        client is not read while the queue is large, see
+*        ECHO_QUEUE_MAX_BYTES.
+*
+* @param   queue_p   Pointer to the echo queue.
+* @param   buf       Pointer to string.
+* @param   bufLen    Length of string.
+*
+***************************************************************************
+*/
+static void QueueEcho(ECHO_QUEUE_st *queue_p, const char *buf, int bufLen)
+{
+  ECHO_BLOCK_st *block_p;
+  W32 left = (W32) bufLen;
+  W32 len;
 
-  if (TelnetWriteSimple(fd, (char*) buf, 3) != 0)
+  while (left > 0)
   {
-    APT_RP_DOTRACE_LEV1(ERROR_ID_R12_1930, (W32) tip_errno,
-                        __LINE__, __FILE__,
-                        0);
+    block_p = queue_p->last_p;
+    if ((block_p == NULL) || (block_p->end == ECHO_BLOCK_SIZE))
+    {
+      block_p = (ECHO_BLOCK_st *) OS_alloc(sizeof(ECHO_BLOCK_st), 0);
+      block_p->next_p = NULL;
+      block_p->start = 0;
+      block_p->end = 0;
+
+      if (queue_p->last_p != NULL)
+      {
+        queue_p->last_p->next_p = block_p;
+      }
+      else
+      {
+        queue_p->first_p = block_p;
+      }
+      queue_p->last_p = block_p;
+    }
+
+    len = ECHO_BLOCK_SIZE - block_p->end;
+    if (len > left)
+    {
+      len = left;
+    }
+
+    memcpy(&block_p->buf[block_p->end], buf, len);
+    block_p->end += len;
+    queue_p->len += len;
+    buf += len;
+    left -= len;
+  }
+} /* QueueEcho */
+
+
+
+/**
+***************************************************************************
+* @brief Writes as much as possible of the echo queue to the socket.
+*        Called at TIP_FD_WRITE before the APPTEXT printout is
+*        continued, so echo and control output are not delayed by
+*        large printouts.
+*
+* @param   queue_p   Pointer to the echo queue.
+*
+* @return  Number of bytes still in the queue.
+*
+***************************************************************************
+*/
+static W32 FlushEcho(ECHO_QUEUE_st *queue_p)
+{
+  ECHO_BLOCK_st *block_p;
+  int sent;
+
+  while ((block_p = queue_p->first_p) != NULL)
+  {
+    sent = tip_write(queue_p->fd, &block_p->buf[block_p->start],
+                     (int) (block_p->end - block_p->start));
+    if (sent < 0)
+    {
+      if (tip_errno != (int)TIP_EWOULDBLOCK)
+      {
+        /* The connection is failing, the error is handled when the
+           printout is written. Discard the echo. */
+        APT_RP_DOTRACE_LEV1(ERROR_ID_R12_1931, (W32) tip_errno,
+                            __LINE__, __FILE__,
+                            0);
+        while ((block_p = queue_p->first_p) != NULL)
+        {
+          queue_p->first_p = block_p->next_p;
+          OS_free((union SIGNAL **) &block_p);
+        }
+        queue_p->last_p = NULL;
+        queue_p->len = 0;
+      }
+      break;
+    }
 
-/*  printf("tip_write failed with error code = %d\n", tip_errno);*/
+    block_p->start += (W32) sent;
+    queue_p->len -= (W32) sent;
+    if (block_p->start < block_p->end)
+    {
+      /* The socket is full */
+      break;
+    }
+
+    queue_p->first_p = block_p->next_p;
+    if (queue_p->first_p == NULL)
+    {
+      queue_p->last_p = NULL;
+    }
+    OS_free((union SIGNAL **) &block_p);
   }
-} /* TelnetWriteCmd */
+
+  return queue_p->len;
+} /* FlushEcho */
 
 
 
 /**
 ***************************************************************************
 * @brief Writes a string to a socket using the SYNCHRONOUS socket interface.
+*        What the socket cannot take is queued in the echo queue.
 *
-* @param   fd        File descriptor.
+* @param   queue_p   Pointer to the echo queue of the client.
 * @param   buf       Pointer to string.
 * @param   bufLen    Length of string.
 *
@@ -325,16 +852,29 @@ static void TelnetWriteCmd(int fd, U8 cmd, U8 val)
 *
 ***************************************************************************
 */
-static int TelnetWriteSimple(int fd, const char *buf, int bufLen)
+static int TelnetWriteSimple(ECHO_QUEUE_st *queue_p, const char *buf,
+                             int bufLen)
 {
   static int outOfMemory = 0;
   static int nextPrintout = 0;
+  int sent;
 
-  if (tip_write(fd, buf, bufLen) < 0)
+  /* Keep the order behind output already waiting in the echo queue */
+  if (FlushEcho(queue_p) != 0)
+  {
+    QueueEcho(queue_p, buf, bufLen);
+    return 0;
+  }
+
+  sent = tip_write(queue_p->fd, buf, bufLen);
+  if (sent < 0)
   {
     if (tip_errno == (int)TIP_EWOULDBLOCK)
     {
-      /* APT_RP_DOTRACE_LEV1(ERROR_ID_R12_1931, (W32) tip_errno, __LINE__, __FILE__, 0);*/
+      /* The socket is full, typically of a printout. The echo is
+         queued and sent first at TIP_FD_WRITE. */
+      QueueEcho(queue_p, buf, bufLen);
+      return 0;
     }
     else if (tip_errno == (int)TIP_ENOMEM)
     { 
@@ -364,6 +904,11 @@ static int TelnetWriteSimple(int fd, const char *buf, int bufLen)
     }
     return tip_errno;
   }
+  else if (sent < bufLen)
+  {
+    /* Queue the rest */
+    QueueEcho(queue_p, buf + sent, bufLen - sent);
+  }
   
   return 0;
 } /* TelnetWriteSimple */
@@ -564,6 +1109,7 @@ static int WrStrSocket(int fd, const char *ptr, CLIENT_PROC_DATA_st *client_p)
 *
 * @param   fd        File descriptor.
 * @param   ptr       Pointer to string.
+* @param   maxLen    Max number of characters to write.
 * @param   client_p  Pointer to client data.
 *
 * @return  0 if TelnetWrite is successful,
@@ -571,12 +1117,13 @@ static int WrStrSocket(int fd, const char *ptr, CLIENT_PROC_DATA_st *client_p)
 *
 ***************************************************************************
 */
-static W32 WrApptextStrSocket(int fd, const char *ptr, CLIENT_PROC_DATA_st *client_p)
+static W32 WrApptextStrSocket(int fd, const char *ptr, W32 maxLen,
+                              CLIENT_PROC_DATA_st *client_p)
 {
   char buf[SZ];
   W32 tnError = FALSE;
   
-  for ( ; *ptr; ptr++)
+  for ( ; *ptr && maxLen; ptr++, maxLen--)
   {
     if (*ptr == '\f') /* Form feed: clear screen and start from top. */
     {
@@ -606,6 +1153,7 @@ static W32 WrApptextStrSocket(int fd, const char *ptr, CLIENT_PROC_DATA_st *clie
       }
       
       client_p -> buflen = 0;
+      client_p -> ptrInApptext++;
     }
     else if (*ptr == '\n')
     {
@@ -671,357 +1219,2681 @@ static W32 WrApptextStrSocket(int fd, const char *ptr, CLIENT_PROC_DATA_st *clie
 
 /**
 ***************************************************************************
-* @brief This function negotiates telnet server options with a
-*        telnet client.
+* @brief This function requests a console handler from the OSmonitor.
+*        The reply (APPCTRL_READY) is handled in the main loop. Until
+*        it arrives the client is treated as running a command, so
+*        commands typed ahead are buffered. The request fails if the
+*        reply has not arrived within CONH_REQ_TIMEOUT
+*        (MICLIENTCONHTMO).
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void ReqConsoleHandler(CMD_DATA_st *cmdData_p)
+{
+  if (cmdData_p->conhPending)
+  {
+    return;
+  }
+
+  if (itelnet_ConhRequest())
+  {
+    cmdData_p->conhPending = TRUE;
+    cmdData_p->isCmdRunning = TRUE;
+
+    if (!cmdData_p->conhTmoPending)
+    {
+      APT_RP_FREQUEST_TMO(&cmdData_p->conhTmo, CONH_REQ_TIMEOUT,
+                          current_process(), MICLIENTCONHTMO);
+      cmdData_p->conhTmoPending = TRUE;
+    }
+  }
+  else
+  {
+    /* OSmonitor does not exist */
+    APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_10, 0,
+                        __LINE__, __FILE__,
+                        0);
+  }
+} /* ReqConsoleHandler */
+
+
+
+/**
+***************************************************************************
+* @brief Called when the console handler request has been aborted by
+*        OSmonitor or has timed out. The commands typed ahead are
+*        discarded and the user is told; the next command requests a
+*        console handler again.
 *
-* @param   login     Login data.
+* @param   cmdData_p Pointer to command execution data.
 * @param   fd        File descriptor.
-* @param   length    Length of data.
-* @param   string    Pointer to string.
 *
-* @return  i
+***************************************************************************
+*/
+static void ConsoleHandlerFailed(CMD_DATA_st *cmdData_p, int fd)
+{
+  if (cmdData_p->conhTmoPending)
+  {
+    APT_RP_CANCEL_TMO(&cmdData_p->conhTmo);
+    cmdData_p->conhTmoPending = FALSE;
+  }
+
+  cmdData_p->conhPending = FALSE;
+  cmdData_p->isCmdRunning = FALSE;
+  FreeBufCmds(cmdData_p, fd);
+
+  (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\nOSmonitor not available\r\n",
+                           strlen("\r\nOSmonitor not available\r\n"));
+} /* ConsoleHandlerFailed */
+
+
+
+/**
+***************************************************************************
+* @brief Called when a command has been completed (all output signals
+*        have been received, or the reply to "time") or when the console
+*        handler has become ready. Executes the next buffered command, if any. Buffered
+*        local commands are run here in their order, until a command
+*        is sent to the console handler.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   fd        File descriptor.
+* @param   afterText TRUE if called when the completing APPTEXT has been
+*                    written, else FALSE.
 *
 ***************************************************************************
 */
-/* THIS FUNCTION DOES NOT SEEM TO DO EXACTLY WHAT IT IS SUPPOSED TO DO.
- * It only handles one option and other options provided in the same string
- * are not handled.
- */
-static W32 TelnetServerOptions(LOGIN_st* login, int fd, W32 length, const char *const string)
+static void RunNextBufCmd(CMD_DATA_st *cmdData_p, int fd, W32 afterText)
 {
-  char cmd;
-  char opt;
-  W32  found = 0;
-  W32  i = 0;
+  CMD_QUEUE_st *entry_p;
+  int commandSize;
 
-  /* Look at one telnet option at a time. */
-  while((length >= 3) && (string[0] == IAC) && (found == 0))
+  /* The buffer and its count always agree, else there is an internal
+     fault in RTIPGPHR. Report RPTERROR and free all buffered commands
+     (if any) to avoid memory leaks. */
+  if ((cmdData_p->queueFirst_p == NULL) != (cmdData_p->noOfQueued == 0))
   {
-    cmd = string[1];
-    opt = string[2];
-      
-    /*********** ECHO ***********/
-    if(opt == TELOPT_ECHO)
+    if (afterText)
     {
-      switch(cmd)
-      {
-        case DO:
-          if (login->hostecho_s == 0)
-          {
-            login->hostecho_s = 1;
-            TelnetWriteCmd(fd, (U8)WILL, TELOPT_ECHO);
-          }
-          break;
+      APT_RP_ERROR2(ERROR_ID_G12B_RTIPGPHR_7, 0,
+                    __LINE__, __FILE__,
+                    2,           /* Num of extra parameters 0-65535 */
+                    cmdData_p->noOfQueued,
+                    cmdData_p->queuedBytes);
+    }
+    else
+    {
+      APT_RP_ERROR2(ERROR_ID_G12B_RTIPGPHR_8, 0,
+                    __LINE__, __FILE__,
+                    2,           /* Num of extra parameters 0-65535 */
+                    cmdData_p->noOfQueued,
+                    cmdData_p->queuedBytes);
+    }
+    FreeBufCmds(cmdData_p, fd);
+  }
 
-        case DONT:
-          if (login->hostecho_s == 1)
-          {
-            login->hostecho_s = 0;
-            TelnetWriteCmd(fd, (U8)WONT, TELOPT_ECHO);
-          }
-          break;
+  /* Unset flag indicating ongoing command */
+  cmdData_p->isCmdRunning = FALSE;
 
-        case WILL:
-          if (login->peerecho_s == 0)
-          {
-            login->peerecho_s = 1;
-            TelnetWriteCmd(fd, (U8)DO, TELOPT_ECHO);
-          }
-          break;
+  /* The output of the next command starts a new page */
+  cmdData_p->linesLeft = PageSize(cmdData_p) - 1;
 
-        case WONT:
-          if (login->peerecho_s == 1)
-          {
-            login->peerecho_s = 0;
-            TelnetWriteCmd(fd, (U8)DONT, TELOPT_ECHO);
-          }
-          break;
-              
-        default:
-          break;
-      }
+  /* Check the if there are any buffered (awaiting) commands
+     and if so execute the next command. */
+  while (!cmdData_p->isCmdRunning && (cmdData_p->queueFirst_p != NULL))
+  {
+    entry_p = cmdData_p->queueFirst_p;
+    cmdData_p->queueFirst_p = entry_p->next_p;
+    if (cmdData_p->queueFirst_p == NULL)
+    {
+      cmdData_p->queueLast_p = NULL;
     }
-    else /* not ECHO */
+    commandSize = (int) strlen(entry_p->cmd);
+    cmdData_p->noOfQueued--;
+    cmdData_p->queuedBytes -= (W32) commandSize + 1;
+
+    /* Print the command on the telnet console, unless the
+       client has already echoed it */
+    if ((cmdData_p->localEcho == FALSE) &&
+        (TelnetWriteSimple(cmdData_p->echo_p, entry_p->cmd, commandSize) != 0))
     {
-      switch(cmd)
+      if (afterText)
       {
-        /* Sender wants receiver to enable option. Receiver says NO. */
-        case DO:
-          if(opt == TELOPT_SGA)
-          {
-            if (login->hostsga_s == 0)
-            {
-              login->hostsga_s = 1;
-              TelnetWriteCmd(fd, (U8)WILL, (U8) opt);
-            }
-          }
-          else
-            TelnetWriteCmd(fd, (U8)WONT, (U8) opt);
-          break;
-
-          /* Sender wants to enable option. Receiver says NO. */
-        case WILL:
-          TelnetWriteCmd(fd, (U8)DONT, (U8) opt);
-          break;
-          
-          /* Sender wants to disable option. Receiver must say OK. */
-        case WONT:
-          TelnetWriteCmd(fd, (U8)DONT, (U8) opt);
-          break;
-          
-          /* Sender wants receiver to disable option. Receiver must say OK. */
-        case DONT:
-          if(opt == TELOPT_SGA)
-          {
-            login->hostsga_s = 0;
-          }
-          TelnetWriteCmd(fd, (U8)WONT, (U8) opt);
-          break;
-          
-        default:
-          break;
+        APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_5, (W32)tip_errno,
+                            __LINE__, __FILE__,
+                            0);
+      }
+      else
+      {
+        APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_6, (W32)tip_errno,
+                            __LINE__, __FILE__,
+                            0);
       }
     }
-    
-    /* Skip to next option. */
-    if(cmd == SB) /* Suboption ? */
+
+    if ((entry_p->kind == QUEUED_CMD) || RunBufLocalCmd(cmdData_p, entry_p))
     {
-      for(i = 3; i < length; i++)
-        if(string[i] == SE)
-        {
-          i++;
-          break;
-        }
+      SendBufCmd(cmdData_p, entry_p);
     }
-    else
+    else if ((cmdData_p->queueFirst_p == NULL) &&
+             !cmdData_p->isCmdRunning && !cmdData_p->automation)
     {
-      i = 3;
+      /* Local command done, the last one buffered. The prompt is
+         printed as after a typed local command; "fg" of a running job
+         prints it when the job completes. */
+      cmdData_p->promptPending = TRUE;
     }
-    found = 1;
+    OS_free((union SIGNAL **) &entry_p);
   }
-  
-  return i;
-} /* TelnetServerOptions */
+
+  /* Read from the client again when the queue has room */
+  ResumeInput(cmdData_p, fd);
+
+  RunAhead(cmdData_p);
+} /* RunNextBufCmd */
 
 
 
 /**
 ***************************************************************************
-* @brief This function requests a console handler from the OSmonitor.
+* @brief Sends a buffered command to OSmonitor, or prints the output of
+*        it if it has been run ahead.
 *
-* @return  OSE PID for the console handler.
+* @param   cmdData_p Pointer to command execution data.
+* @param   entry_p   The buffered command, taken from the buffer.
 *
 ***************************************************************************
 */
-static PROCESS ReqConsoleHandler(void)
+static void SendBufCmd(CMD_DATA_st *cmdData_p, CMD_QUEUE_st *entry_p)
 {
-  union SIGNAL *sig_p;
-  PROCESS conh_ = 0;
-  PROCESS OSmonitor_;
-  static SIGSELECT appctrl[] = {1, APPCTRL};
+  union SIGNAL *outSig_p;
+  TELNET_JOB_st *job_p;
+
+  /* Send command to OSmonitor, without its output filters */
+  cmdData_p->cmdReadOnly = IsReadOnly(cmdData_p, entry_p->cmd);
+  itelnet_FilterEnd(&cmdData_p->filter_p);
+  cmdData_p->filter_p = itelnet_FilterStart(entry_p->cmd);
 
-  if (!hunt("OSmonitor", 0, &OSmonitor_, 0) )
+  job_p = entry_p->job_p;
+  if ((job_p != NULL) && (job_p->state == JOB_STARTING))
   {
-    return 0;
+    /* Run ahead but no console handler yet, run here instead */
+    itelnet_JobAbort(job_p);
+    job_p = NULL;
   }
-  
-  sig_p = OS_alloc(APPCTRL_S, APPCTRL);
-  sig_p->appctrl.data = APPCTRL_INIT;
-  OS_send(&sig_p, OSmonitor_);
-  sig_p = OS_receive(appctrl);
-   
-  switch (sig_p->appctrl.data) 
+
+  if (job_p != NULL)
   {
-    case APPCTRL_READY:
-      conh_ = OS_sender(&sig_p);
-      break;
-      
-    default:
-      break;
+    /* Already run ahead (parallel mode), its output is printed now */
+    ForegroundJob(cmdData_p, job_p);
   }
-  OS_free(&sig_p);
-  
-  return conh_;
-} /* ReqConsoleHandler */
+  else
+  {
+    outSig_p = OS_alloc(APPCMD_S + strlen(entry_p->cmd) + 1, APPCMD); /*lint !e737*/
+    strcpy((char*) outSig_p->appcmd.cmd, entry_p->cmd);
+    OS_send(&outSig_p, cmdData_p->conh_);
+  }
+  cmdData_p->noOfCmds++;
+
+  /* Set flag indicating ongoing command, it prints the prompt */
+  cmdData_p->isCmdRunning = TRUE;
+  cmdData_p->promptPending = FALSE;
+} /* SendBufCmd */
 
 
 
 /**
 ***************************************************************************
-* @brief This function closes a connection, returns the socket
-*        descriptor and kills the calling process.
+* @brief Runs a buffered local command or starts a buffered background
+*        job. The local command is looked up again, the automation mode
+*        may have been turned on by a command before it.
 *
-* @param   client_p  Pointer to client data.
+* @param   cmdData_p Pointer to command execution data.
+* @param   entry_p   The buffered command, taken from the buffer.
+*
+* @return  TRUE if the command line in entry_p is to be sent to the
+*          console handler ("watch", or no longer a local command).
 *
 ***************************************************************************
 */
-static void CloseConnection(const CLIENT_PROC_DATA_st *const client_p)
+static W32 RunBufLocalCmd(CMD_DATA_st *cmdData_p, CMD_QUEUE_st *entry_p)
 {
-  SIGNAL *sig_p;
-  
-  if (tip_shutdown(client_p -> socketId, (int)TIP_SHUT_RDWR) < 0)
+  const BUILTIN_st *builtin_p;
+
+  if (entry_p->kind == QUEUED_JOB)
   {
-    /* Error when shutting down socket. */
-    APT_RP_ERROR(ERROR_ID_R12_1886, (W32) tip_errno);
+    StartJob(cmdData_p, cmdData_p->client_p->socketId, entry_p->cmd);
+    return FALSE;
   }
 
-  if (tip_close(client_p -> socketId) < 0)
+  builtin_p = FindLocalCmd(cmdData_p, entry_p->cmd);
+  if (builtin_p == NULL)
   {
-    /* Error when closing socket. */
-    APT_RP_ERROR(ERROR_ID_R12_1887, (W32) tip_errno);
+    return TRUE;
   }
 
-#ifndef SOFTKERNEL  
-  /*
-   * The socket_proc_terminate function frees the process context
-   * variables used by the specified process and shall be called
-   * when a process that has been using the TIP-stack socket interface
-   * is to be terminated. Note! No more socket calls has to be made by
-   * the process in question after that this function is called.
-   * Then it will be inserted again in the context array.
-   */
-  socket_proc_terminate(current_process() );
-#endif
-  
-  /* Tell the Telnet server process that the client process is closed */
-  sig_p = OS_alloc(MISTOPCLIENTR_S, MISTOPCLIENTR);
-  sig_p->mistopclientr.clientInd = client_p -> clientInd;
-  OS_send(&sig_p, client_p -> serverPid);
+  cmdData_p->noOfLocalCmds++;
+  return (W32) (builtin_p->func(cmdData_p, cmdData_p->client_p,
+                                cmdData_p->root_p, entry_p->cmd) > 0);
+} /* RunBufLocalCmd */
 
-  /* Kill the telnet client process */
-  kill_proc(current_process());
 
-} /* CloseConnection */
+
+/**
+***************************************************************************
+* @brief Runs buffered commands ahead in parallel mode, as jobs on
+*        console handlers of their own, so that at most
+*        cmdData_p->parallel commands of the session run at a time.
+*        Their output is printed by RunNextBufCmd in the order of the
+*        commands. Only read-only commands are run ahead, and not past
+*        a command that is not.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void RunAhead(CMD_DATA_st *cmdData_p)
+{
+  CMD_QUEUE_st *entry_p;
+  TELNET_JOB_st *job_p;
+  char cmd[JOB_CMD_MAX];
+  TELNET_FILTER_st *filter_p;
+  W32 running = 1;
+
+  /* The replies to console handler requests are told apart by order */
+  if ((cmdData_p->parallel < 2) || (cmdData_p->conh_ == 0) ||
+      cmdData_p->conhPending || !cmdData_p->cmdReadOnly)
+  {
+    return;
+  }
+
+  for (entry_p = cmdData_p->queueFirst_p; entry_p != NULL;
+       entry_p = entry_p->next_p)
+  {
+    if (entry_p->job_p != NULL)
+    {
+      running++;
+    }
+  }
+
+  for (entry_p = cmdData_p->queueFirst_p;
+       (entry_p != NULL) && (running < cmdData_p->parallel);
+       entry_p = entry_p->next_p)
+  {
+    if (entry_p->job_p != NULL)
+    {
+      continue;
+    }
+
+    /* A local command or a command that may change the state is run
+       in order, and so are the commands after it */
+    if ((entry_p->kind != QUEUED_CMD) ||
+        (strlen(entry_p->cmd) >= JOB_CMD_MAX) ||
+        !IsReadOnly(cmdData_p, entry_p->cmd))
+    {
+      break;
+    }
+
+    /* The job runs the command without its output filters, they are
+       applied when the output is printed */
+    strcpy(cmd, entry_p->cmd);
+    filter_p = itelnet_FilterStart(cmd);
+    itelnet_FilterEnd(&filter_p);
+
+    job_p = itelnet_JobStart(&cmdData_p->jobs, cmd);
+    if (job_p == NULL)
+    {
+      break;
+    }
+
+    job_p->queued = TRUE;
+    entry_p->job_p = job_p;
+    running++;
+  }
+} /* RunAhead */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if a command is read-only, i.e. one of the commands of
+*        the result cache in MICLIENTCFG, compared without its output
+*        filters and normalised as by itelnet_CfgNormalise(). The empty
+*        command only prints the prompt.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   cmd       Command string.
+*
+* @return  TRUE if the command may be run ahead.
+*
+***************************************************************************
+*/
+static W32 IsReadOnly(const CMD_DATA_st *cmdData_p, const char *cmd)
+{
+  const struct miclientcfg_s *cfg_p = &cmdData_p->cfg_p->miclientcfg;
+  char key[MI_RPC_CMD_MAX + 1];
+  TELNET_FILTER_st *filter_p;
+  W32 i;
+
+  if (strlen(cmd) >= sizeof(key))
+  {
+    return FALSE;
+  }
+
+  strcpy(key, cmd);
+  filter_p = itelnet_FilterStart(key);
+  itelnet_FilterEnd(&filter_p);
+  itelnet_CfgNormalise(key);
+
+  if (key[0] == '\0')
+  {
+    return TRUE;
+  }
+
+  for (i = 0; (i < cfg_p->noOfReadOnly) && (i < MI_READONLY_MAX); i++)
+  {
+    if (strcmp(key, cfg_p->readOnly[i]) == 0)
+    {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+} /* IsReadOnly */
+
+
+
+/**
+***************************************************************************
+* @brief Sends a completed command line to the console handler, or
+*        buffers it if another command is running or the console
+*        handler is not yet available.
+*
+* @param   cmdData_p   Pointer to command execution data.
+* @param   fd          File descriptor.
+* @param   cmd         Command string.
+* @param   commandSize Length of command including terminating character.
+*
+***************************************************************************
+*/
+static void SendCommand(CMD_DATA_st *cmdData_p, int fd, const char *cmd,
+                        int commandSize)
+{
+  union SIGNAL *outSig_p;
+
+  /* Request a console handler if there is none (OSmonitor may not
+     have existed when the session started). */
+  if ((cmdData_p->conh_ == 0) && (cmdData_p->conhPending == FALSE))
+  {
+    ReqConsoleHandler(cmdData_p);
+
+    if (cmdData_p->conhPending == FALSE)
+    {
+      (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\nOSmonitor not available\r\n",
+                               strlen("\r\nOSmonitor not available\r\n"));
+      return;
+    }
+  }
+
+  /* Check if another command is not already running */
+  if (cmdData_p->isCmdRunning == FALSE)
+  {
+    /* Send complete command to OSmonitor, without its output
+       filters. */
+    outSig_p = OS_alloc(APPCMD_S + commandSize, APPCMD); /*lint !e737*/
+    strcpy((char*) outSig_p->appcmd.cmd, cmd);
+    cmdData_p->cmdReadOnly = IsReadOnly(cmdData_p, cmd);
+    itelnet_FilterEnd(&cmdData_p->filter_p);
+    cmdData_p->filter_p = itelnet_FilterStart((char*) outSig_p->appcmd.cmd);
+    OS_send(&outSig_p, cmdData_p->conh_);
+    cmdData_p->noOfCmds++;
+
+    /* Set flag indicating ongoing command, it prints the prompt */
+    cmdData_p->isCmdRunning = TRUE;
+    cmdData_p->promptPending = FALSE;
+  }
+  else
+  {
+    /* Another command is already running. This can happen in
+       case of copy-paste of multiple commands into the telnet
+       console. Store the new command, it will be executed after
+       all preceding commands are finished. */
+    QueueCommand(cmdData_p, fd, cmd, QUEUED_CMD);
+  }
+} /* SendCommand */
+
+
+
+/**
+***************************************************************************
+* @brief Buffers a command line typed while another command is running.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   fd        File descriptor.
+* @param   cmd       Command line.
+* @param   kind      QUEUED_CMD, QUEUED_LOCAL or QUEUED_JOB.
+*
+***************************************************************************
+*/
+static void QueueCommand(CMD_DATA_st *cmdData_p, int fd, const char *cmd,
+                         W32 kind)
+{
+  CMD_QUEUE_st *entry_p;
+  W32 commandSize;
+
+  commandSize = strlen(cmd) + 1;
+  entry_p = (CMD_QUEUE_st *) OS_alloc(sizeof(CMD_QUEUE_st) + commandSize, 0); /*lint !e737*/
+  entry_p->next_p = NULL;
+  entry_p->job_p = NULL;
+  entry_p->kind = kind;
+  strcpy(entry_p->cmd, cmd);
+
+  if (cmdData_p->queueLast_p != NULL)
+  {
+    cmdData_p->queueLast_p->next_p = entry_p;
+  }
+  else
+  {
+    cmdData_p->queueFirst_p = entry_p;
+  }
+  cmdData_p->queueLast_p = entry_p;
+  cmdData_p->noOfQueued++;
+  cmdData_p->queuedBytes += commandSize;
+
+  /* The queue has no fixed length. When it gets large the client is
+     not read, so TCP stops it, instead of commands being lost. */
+  if (!cmdData_p->inputStopped &&
+      (cmdData_p->queuedBytes > CMD_QUEUE_MAX_BYTES))
+  {
+    StopInput(cmdData_p, fd, TRUE);
+  }
+
+  RunAhead(cmdData_p);
+} /* QueueCommand */
+
+
+
+/**
+***************************************************************************
+* @brief Frees all buffered commands.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   fd        File descriptor.
+*
+***************************************************************************
+*/
+static void FreeBufCmds(CMD_DATA_st *cmdData_p, int fd)
+{
+  CMD_QUEUE_st *entry_p;
+
+  while (cmdData_p->queueFirst_p != NULL)
+  {
+    entry_p = cmdData_p->queueFirst_p;
+    cmdData_p->queueFirst_p = entry_p->next_p;
+
+    /* A command run ahead is aborted */
+    if (entry_p->job_p != NULL)
+    {
+      itelnet_JobAbort(entry_p->job_p);
+    }
+    OS_free((union SIGNAL **) &entry_p);
+  }
+
+  cmdData_p->queueLast_p = NULL;
+  cmdData_p->noOfQueued = 0;
+  cmdData_p->queuedBytes = 0;
+
+  ResumeInput(cmdData_p, fd);
+} /* FreeBufCmds */
+
+
+
+/**
+***************************************************************************
+* @brief Stops or resumes reading from the client, by the subscription
+*        of TIP_FD_READ. While the socket is not read the TCP window
+*        closes and the client stops sending.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   fd        File descriptor.
+* @param   stop      TRUE to stop reading, FALSE to resume.
+*
+***************************************************************************
+*/
+static void StopInput(CMD_DATA_st *cmdData_p, int fd, W32 stop)
+{
+  int result;
+
+  if (stop)
+  {
+    result = tip_asyncselect(fd, TIP_FD_CLOSE | TIP_FD_WRITE); /*lint !e641 !e655*/
+  }
+  else
+  {
+    result = tip_asyncselect(fd, TIP_FD_CLOSE | TIP_FD_READ | TIP_FD_WRITE); /*lint !e641 !e655*/
+  }
+
+  if (result < 0)
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_16, (W32) tip_errno);
+    return;
+  }
+
+  cmdData_p->inputStopped = stop;
+} /* StopInput */
+
+
+
+/**
+***************************************************************************
+* @brief Reads from the client again, if stopped, when both the command
+*        queue and the echo queue have room.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   fd        File descriptor.
+*
+***************************************************************************
+*/
+static void ResumeInput(CMD_DATA_st *cmdData_p, int fd)
+{
+  if (cmdData_p->inputStopped &&
+      (cmdData_p->queuedBytes <= CMD_QUEUE_LOW_BYTES) &&
+      (cmdData_p->echo_p->len <= ECHO_QUEUE_LOW_BYTES))
+  {
+    StopInput(cmdData_p, fd, FALSE);
+  }
+} /* ResumeInput */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if an APPTEXT signal completes the command.
+*
+*        Note: due to a probable fault in consolehandler, when executing
+*        help command "?" the apptext signal with APPTEXT_RDY is not
+*        send when command is completed. For that reason it's necessary
+*        to additionally check if prompt text without RDY flag is
+*        received, and if so behave as if command is completed.
+*
+* @param   sig_p     APPTEXT signal.
+*
+* @return  TRUE if the command is completed.
+*
+***************************************************************************
+*/
+static W32 IsCmdCompleted(const union SIGNAL *sig_p)
+{
+  if ((sig_p->apptext.ctrl & APPTEXT_RDY)
+      OR
+      (strcmp(sig_p->apptext.text, "\r\nOSmon> ") == 0)
+      OR
+      (strcmp(sig_p->apptext.text, "\r\nOSmon>") == 0))
+  {
+    return TRUE;
+  }
+
+  return FALSE;
+} /* IsCmdCompleted */
+
+
+
+/**
+***************************************************************************
+* @brief Returns the offset of the last line (normally the prompt) of
+*        an APPTEXT text, including the line break before it.
+*
+* @param   text      APPTEXT text.
+*
+* @return  Offset of the last line, 0 if the text is one line.
+*
+***************************************************************************
+*/
+static W32 LastLineOffset(const char *text)
+{
+  const char *nl_p;
+
+  nl_p = strrchr(text, '\n');
+  if (nl_p == NULL)
+  {
+    return 0;
+  }
+
+  if ((nl_p > text) && (*(nl_p - 1) == '\r'))
+  {
+    nl_p--;
+  }
+
+  return (W32) (nl_p - text);
+} /* LastLineOffset */
+
+
+
+/**
+***************************************************************************
+* @brief Sends the flow control acknowledge (APPCTRL_ACK) of an
+*        APPTEXT to the console handler.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void SendAppAck(const CMD_DATA_st *cmdData_p)
+{
+  union SIGNAL *outSig_p;
+
+  if (cmdData_p->conh_ != 0)
+  {
+    outSig_p = OS_alloc(APPCTRL_S, APPCTRL);
+    outSig_p->appctrl.data = APPCTRL_ACK;
+    OS_send(&outSig_p, cmdData_p->conh_);
+  }
+} /* SendAppAck */
+
+
+
+/**
+***************************************************************************
+* @brief Aborts the running command in the console handler
+*        (APPCTRL_ABORT).
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void SendAppAbort(const CMD_DATA_st *cmdData_p)
+{
+  union SIGNAL *outSig_p;
+
+  if (cmdData_p->conh_ != 0)
+  {
+    outSig_p = OS_alloc(APPCTRL_S, APPCTRL);
+    outSig_p->appctrl.data = APPCTRL_ABORT;
+    OS_send(&outSig_p, cmdData_p->conh_);
+  }
+} /* SendAppAbort */
+
+
+
+/**
+***************************************************************************
+* @brief Applies the output filter of the running command to an
+*        APPTEXT. When head has got its lines the command is aborted
+*        and the rest of its output is discarded. The filter is freed
+*        when the command completes.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   sig_pp    APPTEXT, replaced with the filtered text.
+*
+* @return  TRUE if nothing is left of the text, it has been
+*          acknowledged.
+*
+***************************************************************************
+*/
+static W32 FilterAppText(CMD_DATA_st *cmdData_p, union SIGNAL **sig_pp)
+{
+  W32 completed;
+  W32 bodyLen;
+
+  completed = IsCmdCompleted(*sig_pp);
+  bodyLen = completed ? LastLineOffset((*sig_pp)->apptext.text) :
+                        (W32) strlen((*sig_pp)->apptext.text);
+
+  if (itelnet_FilterText(cmdData_p->filter_p, sig_pp, bodyLen, completed) &&
+      !completed)
+  {
+    /* The rest of the output is not wanted */
+    SendAppAbort(cmdData_p);
+    cmdData_p->discardOutput = TRUE;
+  }
+
+  if (completed)
+  {
+    itelnet_FilterEnd(&cmdData_p->filter_p);
+  }
+  else if ((*sig_pp)->apptext.text[0] == '\0')
+  {
+    if ((*sig_pp)->apptext.ctrl & APPTEXT_ACK)
+    {
+      AckAppText(cmdData_p);
+    }
+    return TRUE;
+  }
+
+  return FALSE;
+} /* FilterAppText */
+
+
+
+/**
+***************************************************************************
+* @brief Keeps an APPTEXT of the watched command. When the command
+*        completes, the APPTEXT is replaced with the screen update and
+*        the next run is requested.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   sig_pp    APPTEXT, replaced with the screen update when the
+*                    command completes.
+*
+* @return  TRUE if the text has been kept and acknowledged, FALSE if
+*          the screen update is to be written.
+*
+***************************************************************************
+*/
+static W32 WatchAppText(CMD_DATA_st *cmdData_p, union SIGNAL **sig_pp)
+{
+  W32 completed;
+  W32 bodyLen;
+
+  completed = IsCmdCompleted(*sig_pp);
+  bodyLen = completed ? LastLineOffset((*sig_pp)->apptext.text) :
+                        (W32) strlen((*sig_pp)->apptext.text);
+
+  itelnet_WatchText(cmdData_p->watch_p, (*sig_pp)->apptext.text, bodyLen);
+
+  if (!completed)
+  {
+    if ((*sig_pp)->apptext.ctrl & APPTEXT_ACK)
+    {
+      AckAppText(cmdData_p);
+    }
+    return TRUE;
+  }
+
+  itelnet_WatchDraw(cmdData_p->watch_p, sig_pp);
+
+  if (!cmdData_p->watchTickPending)
+  {
+    APT_RP_FREQUEST_TMO(&cmdData_p->watchTmo,
+                        cmdData_p->watch_p->interval * 1000,
+                        current_process(), MICLIENTWATCH);
+    cmdData_p->watchTickPending = TRUE;
+  }
+
+  return FALSE;
+} /* WatchAppText */
+
+
+
+/**
+***************************************************************************
+* @brief Frames an APPTEXT in automation mode. The text is preceded by
+*        a header line "#<seq> <len> <more|done>": the number of the
+*        command since the automation mode was turned on, the number
+*        of bytes written after the header, and "done" if the command
+*        has completed (APPTEXT_RDY). The prompt, form feeds, escape
+*        sequences and other control characters are removed, and line
+*        breaks are written as CR LF.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   sig_pp    APPTEXT, replaced with the framed text.
+* @param   skip      Offset where the output starts.
+*
+* @return  TRUE if nothing is left of the text, it has been
+*          acknowledged.
+*
+***************************************************************************
+*/
+static W32 AutoAppText(CMD_DATA_st *cmdData_p, union SIGNAL **sig_pp,
+                       W32 skip)
+{
+  union SIGNAL *out_p;
+  const char *text = (*sig_pp)->apptext.text;
+  char *body;
+  W32 completed;
+  W32 bodyLen;
+  W32 wireLen;
+  W32 n = 0;
+  W32 i;
+  char c;
+
+  completed = IsCmdCompleted(*sig_pp);
+  bodyLen = completed ? LastLineOffset(text) : (W32) strlen(text);
+
+  out_p = OS_alloc(APPTEXT_S + AUTO_HEADER_MAX + bodyLen, APPTEXT); /*lint !e737*/
+  out_p->apptext.ctrl = (*sig_pp)->apptext.ctrl | (completed ? APPTEXT_RDY : 0);
+  body = (char *) out_p->apptext.text + AUTO_HEADER_MAX;
+
+  for (i = skip; i < bodyLen; i++)
+  {
+    c = text[i];
+    if (c == ESC)
+    {
+      /* Escape sequence, ESC [ <parameters> <final character> */
+      if (text[i + 1] == '[')
+      {
+        for (i += 2; (i < bodyLen) && ((text[i] < 0x40) || (text[i] > 0x7e)); i++)
+        {
+        }
+      }
+    }
+    else if ((c == '\n') || (c == '\t') || ((U8) c >= ' '))
+    {
+      body[n++] = c;
+    }
+  }
+  body[n] = '\0';
+
+  if ((n == 0) && !completed)
+  {
+    OS_free(&out_p);
+    if ((*sig_pp)->apptext.ctrl & APPTEXT_ACK)
+    {
+      AckAppText(cmdData_p);
+    }
+    return TRUE;
+  }
+
+  /* Each line break is written as CR LF */
+  wireLen = n;
+  for (i = 0; i < n; i++)
+  {
+    if (body[i] == '\n')
+    {
+      wireLen++;
+    }
+  }
+
+  i = (W32) sprintf((char *) out_p->apptext.text, "#%lu %lu %s\n",
+                    (unsigned long) (cmdData_p->noOfCmds - cmdData_p->autoBase),
+                    (unsigned long) wireLen, completed ? "done" : "more");
+  memmove(&out_p->apptext.text[i], body, n + 1);
+
+  OS_free(sig_pp);
+  *sig_pp = out_p;
+  return FALSE;
+} /* AutoAppText */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "automation [on|off]". In automation
+*        mode the session is used by a program: the input is not echoed
+*        or edited, only "automation" and "exit" are local commands,
+*        and the output of each command is framed (see AutoAppText), so
+*        the program does not look for the prompt. Commands may be sent
+*        without waiting for the results. "automation on" is answered
+*        with the header "#0 0 done".
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int AutomationCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                         cmd_hist *root_p, char *cmd)
+{
+  const char *arg = &cmd[strlen("automation")];
+  int fd = client_p->socketId;
+
+  while (*arg == ' ')
+  {
+    arg++;
+  }
+
+  if ((strcmp(arg, "on") == 0) || ((*arg == '\0') && cmdData_p->automation))
+  {
+    if (!cmdData_p->automation)
+    {
+      /* The results are framed from the next command */
+      if (cmdData_p->isCmdRunning)
+      {
+        (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\na command is running",
+                                 strlen("\r\na command is running"));
+        return 0;
+      }
+      cmdData_p->automation = TRUE;
+      cmdData_p->autoBase = cmdData_p->noOfCmds;
+    }
+    cmdData_p->localEcho = TRUE;
+    root_p->output = NoEcho;
+    (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\n#0 0 done\r\n",
+                             strlen("\r\n#0 0 done\r\n"));
+  }
+  else if (strcmp(arg, "off") == 0)
+  {
+    /* The echo is turned on again at the next input */
+    cmdData_p->automation = FALSE;
+  }
+  else if (*arg != '\0')
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\nUsage: automation [on|off]",
+                             strlen("\r\nUsage: automation [on|off]"));
+  }
+  else
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\nautomation off",
+                             strlen("\r\nautomation off"));
+  }
+
+  return 0;
+} /* AutomationCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "watch N <cmd>", which starts the
+*        watch mode. The command line is replaced with the watched
+*        command.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  Length of the watched command including the terminating
+*          character, 0 if the command line is not valid.
+*
+***************************************************************************
+*/
+static int WatchCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                    cmd_hist *root_p, char *cmd)
+{
+  char *cmd_p;
+  W32 interval;
+
+  interval = (W32) strtoul(&cmd[5], &cmd_p, 10);
+  while (*cmd_p == ' ')
+  {
+    cmd_p++;
+  }
+
+  if ((cmd_p == &cmd[5]) || (interval == 0) ||
+      (interval > WATCH_MAX_INTERVAL) || (*cmd_p == '\0') ||
+      (strlen(cmd_p) >= WATCH_CMD_MAX))
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p,
+                             "\r\nUsage: watch <seconds> <command>",
+                             strlen("\r\nUsage: watch <seconds> <command>"));
+    return 0;
+  }
+
+  itelnet_WatchEnd(&cmdData_p->watch_p);
+  cmdData_p->watch_p =
+    itelnet_WatchStart(cmd_p, interval,
+                       (cmdData_p->winHeight > 0) ? cmdData_p->winHeight :
+                                                    PAGER_DEFAULT_LINES,
+                       (cmdData_p->winWidth > 0) ? cmdData_p->winWidth :
+                                                   WATCH_DEFAULT_WIDTH);
+
+  memmove(cmd, cmd_p, strlen(cmd_p) + 1);
+  return (int) strlen(cmd) + 1;
+} /* WatchCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Ends the watch mode. A running command is aborted and its
+*        output discarded; the prompt is printed when it completes, or
+*        else when the printout is done (FlushPrompt).
+*
+* @param   cmdData_p  Pointer to command execution data.
+* @param   savedSig_p APPTEXT being written, NULL if none.
+*
+***************************************************************************
+*/
+static void StopWatch(CMD_DATA_st *cmdData_p,
+                      const union SIGNAL *savedSig_p)
+{
+  itelnet_WatchEnd(&cmdData_p->watch_p);
+
+  if (cmdData_p->isCmdRunning &&
+      ((savedSig_p == NULL) || !IsCmdCompleted(savedSig_p)))
+  {
+    SendAppAbort(cmdData_p);
+    cmdData_p->discardOutput = TRUE;
+  }
+  else
+  {
+    cmdData_p->promptPending = TRUE;
+  }
+} /* StopWatch */
+
+
+
+/**
+***************************************************************************
+* @brief Acknowledges an APPTEXT (APPCTRL_ACK). While the output is
+*        stopped (XOFF or pager) the acknowledge is held, so OSmonitor
+*        stops sending until the output is resumed.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void AckAppText(CMD_DATA_st *cmdData_p)
+{
+  if (OutputStopped(cmdData_p))
+  {
+    cmdData_p->ackHeld = TRUE;
+  }
+  else
+  {
+    SendAppAck(cmdData_p);
+  }
+} /* AckAppText */
+
+
+
+/**
+***************************************************************************
+* @brief Holds an APPTEXT while the output is stopped, while another
+*        text is being written, or while held texts are replayed. No
+*        text is dropped: a held text is acknowledged only when it has
+*        been printed, so OSmonitor stops sending at the first held
+*        text that requests APPCTRL_ACK.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   sig_pp    Pointer to the APPTEXT, set to NULL.
+*
+***************************************************************************
+*/
+static void HoldAppText(CMD_DATA_st *cmdData_p, union SIGNAL **sig_pp)
+{
+  HELD_TEXT_st *entry_p;
+
+  entry_p = (HELD_TEXT_st *) OS_alloc(sizeof(HELD_TEXT_st), 0);
+  entry_p->sig_p = *sig_pp;
+  *sig_pp = NULL;
+
+  /* Replayed texts come before the texts received during the replay */
+  if (OS_sender(&entry_p->sig_p) == current_process())
+  {
+    if (cmdData_p->heldSelfLast_p == NULL)
+    {
+      entry_p->next_p = cmdData_p->heldFirst_p;
+      cmdData_p->heldFirst_p = entry_p;
+    }
+    else
+    {
+      entry_p->next_p = cmdData_p->heldSelfLast_p->next_p;
+      cmdData_p->heldSelfLast_p->next_p = entry_p;
+    }
+    cmdData_p->heldSelfLast_p = entry_p;
+    cmdData_p->noOfHeldSelf++;
+    cmdData_p->replay--;
+  }
+  else
+  {
+    entry_p->next_p = NULL;
+    if (cmdData_p->heldLast_p == NULL)
+    {
+      cmdData_p->heldFirst_p = entry_p;
+    }
+    else
+    {
+      cmdData_p->heldLast_p->next_p = entry_p;
+    }
+  }
+
+  if (entry_p->next_p == NULL)
+  {
+    cmdData_p->heldLast_p = entry_p;
+  }
+  cmdData_p->noOfHeld++;
+} /* HoldAppText */
+
+
+
+/**
+***************************************************************************
+* @brief Sends the held texts to the own process, they are printed in
+*        order when received again.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void ReplayHeld(CMD_DATA_st *cmdData_p)
+{
+  HELD_TEXT_st *entry_p;
+
+  while (cmdData_p->heldFirst_p != NULL)
+  {
+    entry_p = cmdData_p->heldFirst_p;
+    cmdData_p->heldFirst_p = entry_p->next_p;
+
+    OS_send(&entry_p->sig_p, current_process());
+    OS_free((union SIGNAL **) &entry_p);
+  }
+
+  cmdData_p->replay += cmdData_p->noOfHeld;
+  cmdData_p->noOfHeld = 0;
+  cmdData_p->noOfHeldSelf = 0;
+  cmdData_p->heldLast_p = NULL;
+  cmdData_p->heldSelfLast_p = NULL;
+} /* ReplayHeld */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if the output is stopped, by XOFF or at the pager
+*        prompt.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+* @return  TRUE if the output is stopped.
+*
+***************************************************************************
+*/
+static W32 OutputStopped(const CMD_DATA_st *cmdData_p)
+{
+  return (W32) (cmdData_p->paused || cmdData_p->morePrompt);
+} /* OutputStopped */
+
+
+
+/**
+***************************************************************************
+* @brief Returns the number of lines of a page, from the pager setting
+*        or from the window size of the client.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+* @return  Lines of a page, at least 2.
+*
+***************************************************************************
+*/
+static W32 PageSize(const CMD_DATA_st *cmdData_p)
+{
+  if (cmdData_p->pager >= 2)
+  {
+    return cmdData_p->pager;
+  }
+
+  if (cmdData_p->winHeight >= 2)
+  {
+    return cmdData_p->winHeight;
+  }
+
+  return PAGER_DEFAULT_LINES;
+} /* PageSize */
+
+
+
+/**
+***************************************************************************
+* @brief Finds where the output of an APPTEXT stops for the pager,
+*        i.e. the start of the first line that does not fit on the
+*        page. The lines left on the page are updated. The line break
+*        before the prompt that completes a command is not counted.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   sig_p     APPTEXT signal.
+* @param   from      Offset in the text where the output continues.
+*
+* @return  Offset where the output stops, the text length if the rest
+*          of the text fits on the page.
+*
+***************************************************************************
+*/
+static W32 PageEnd(CMD_DATA_st *cmdData_p, const union SIGNAL *sig_p,
+                   W32 from)
+{
+  const char *text = sig_p->apptext.text;
+  W32 last;
+  W32 lineStart;
+  W32 i;
+
+  if ((cmdData_p->pager == MI_PAGER_OFF) || (cmdData_p->watch_p != NULL) ||
+      cmdData_p->automation)
+  {
+    return (W32) strlen(text);
+  }
+
+  last = IsCmdCompleted(sig_p) ? LastLineOffset(text) : (W32) strlen(text);
+  lineStart = from;
+
+  for (i = from; text[i] != '\0'; i++)
+  {
+    if (text[i] == '\f')
+    {
+      /* The screen is cleared, a new page */
+      cmdData_p->linesLeft = PageSize(cmdData_p) - 1;
+    }
+    else if ((text[i] == '\n') && (i < last))
+    {
+      if (cmdData_p->linesLeft == 0)
+      {
+        return lineStart;
+      }
+      cmdData_p->linesLeft--;
+      lineStart = i + 1;
+    }
+  }
+
+  return i;
+} /* PageEnd */
+
+
+
+/**
+***************************************************************************
+* @brief Prints the texts held while the output was stopped, when no
+*        text is being written. The held acknowledge is sent, so
+*        OSmonitor continues.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void ReleaseHeld(CMD_DATA_st *cmdData_p)
+{
+  if (OutputStopped(cmdData_p))
+  {
+    return;
+  }
+
+  /* Texts still being replayed are followed by the newly held ones */
+  if ((cmdData_p->replay == 0) && (cmdData_p->noOfHeld > 0))
+  {
+    ReplayHeld(cmdData_p);
+  }
+
+  if (cmdData_p->ackHeld)
+  {
+    cmdData_p->ackHeld = FALSE;
+    SendAppAck(cmdData_p);
+  }
+} /* ReleaseHeld */
+
+
+
+/**
+***************************************************************************
+* @brief Checks the result of a failed write of an APPTEXT. If the
+*        error cannot be handled, the out buffer and the APPTEXT are
+*        freed.
+*
+* @param   client_p    Pointer to client data.
+* @param   savedSig_pp Pointer to the APPTEXT being written.
+*
+* @return  FALSE if the rest is written at TIP_FD_WRITE,
+*          TRUE if the connection must be closed.
+*
+***************************************************************************
+*/
+static W32 WriteError(CLIENT_PROC_DATA_st *client_p, union SIGNAL **savedSig_pp)
+{
+  if ((tip_errno == (int)TIP_EWOULDBLOCK) OR (tip_errno == (int)TIP_ESUCCESS))
+  {
+    /* INETR would block or INETR couldn't send what we requested. */
+    /* Keep the text and wait for TIP_SOCKET_CHANGED_EVENT with    */
+    /* event TIP_FD_WRITE.                                         */
+    DEBUG_PRINT(("----> tip_errno = %d when writing APPTEXT\n", tip_errno));
+    return FALSE;
+  }
+
+  /* INETR has reported an error we cannot handle. */
+  if (client_p->startOfOutBuffer_p != NULL)
+  {
+    OS_free((SIGNAL**) &(client_p->startOfOutBuffer_p));
+  }
+  client_p->outBuffer_p = NULL;
+  client_p->startOfOutBuffer_p = NULL;
+
+  if (*savedSig_pp != NULL)
+  {
+    OS_free(savedSig_pp);
+  }
+
+  return TRUE;
+} /* WriteError */
+
+
+
+/**
+***************************************************************************
+* @brief Called when an APPTEXT has been written. The out buffer and
+*        the text are freed, the text is acknowledged, and the next
+*        buffered command is run if the text completes the command.
+*
+* @param   cmdData_p   Pointer to command execution data.
+* @param   client_p    Pointer to client data.
+* @param   savedSig_pp Pointer to the APPTEXT, set to NULL.
+*
+***************************************************************************
+*/
+static void EndAppText(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                       union SIGNAL **savedSig_pp)
+{
+  if (client_p->startOfOutBuffer_p != NULL)
+  {
+    OS_free((SIGNAL**) &(client_p->startOfOutBuffer_p));
+  }
+  client_p->outBuffer_p = NULL;
+  client_p->startOfOutBuffer_p = NULL;
+
+  /* Check if confirm is requested. */
+  if ((*savedSig_pp)->apptext.ctrl & APPTEXT_ACK)
+  {
+    /* ACK (flow control) requested, held while the output is stopped. */
+    AckAppText(cmdData_p);
+  }
+
+  /* Check if command is completed. */
+  if (IsCmdCompleted(*savedSig_pp))
+  {
+    /* The command has been completed (all output signals have
+       been received). Execute the next buffered command. */
+    RunNextBufCmd(cmdData_p, client_p->socketId, TRUE);
+  }
+
+  OS_free(savedSig_pp);
+} /* EndAppText */
+
+
+
+/**
+***************************************************************************
+* @brief Writes as much as possible of the output to the client: the
+*        echo queue, the out buffer, and the APPTEXT being written up to
+*        the end of the page. Called when an APPTEXT is received, at
+*        TIP_FD_WRITE, and when the output is resumed (XON, pager key
+*        or abort). When the page is full the pager prompt is written
+*        and the output stops until the user answers it. When the text
+*        has been written the texts held meanwhile are printed.
+*
+* @param   cmdData_p   Pointer to command execution data.
+* @param   client_p    Pointer to client data.
+* @param   savedSig_pp Pointer to the APPTEXT being written, NULL if none.
+*
+* @return  0 if successful or the output waits for the socket or the
+*          user, 1 if the connection must be closed.
+*
+***************************************************************************
+*/
+static W32 ContinueOutput(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                          union SIGNAL **savedSig_pp)
+{
+  int fd = client_p->socketId;
+
+  /* Echo and control output goes ahead of the printout. */
+  if ((FlushEcho(cmdData_p->echo_p) != 0) || OutputStopped(cmdData_p))
+  {
+    return 0;
+  }
+
+  if (client_p->buflen)
+  {
+    /* There is still data in the buffer to send */
+    if (TelnetWrite(fd, (client_p->startOfOutBuffer_p + client_p->bytesSentAcc),
+                    client_p) != 0)
+    {
+      return WriteError(client_p, savedSig_pp);
+    }
+  }
+
+  if (*savedSig_pp == NULL)
+  {
+    ReleaseHeld(cmdData_p);
+    return 0;
+  }
+
+  if (client_p->ptrInApptext < cmdData_p->pageEnd)
+  {
+    /* There is still data in APPTEXT to send on this page */
+
+    DEBUG_PRINT(("Calling WrApptextStrSocket, apptext = \"%s\"\n, bytesSent = %ld\n", (*savedSig_pp)->apptext.text, client_p->bytesSent));
+
+    if (WrApptextStrSocket(fd,
+                           &((*savedSig_pp)->apptext.text[client_p->ptrInApptext]),
+                           cmdData_p->pageEnd - client_p->ptrInApptext,
+                           client_p) != 0)
+    {
+      return WriteError(client_p, savedSig_pp);
+    }
+  }
+
+  if (client_p->ptrInApptext < client_p->apptextLength)
+  {
+    /* The page is full, wait for the user */
+    cmdData_p->morePrompt = TRUE;
+    (void) TelnetWriteSimple(cmdData_p->echo_p, MORE_PROMPT, strlen(MORE_PROMPT));
+    return 0;
+  }
+
+  EndAppText(cmdData_p, client_p, savedSig_pp);
+  ReleaseHeld(cmdData_p);
+
+  return 0;
+} /* ContinueOutput */
+
+
+
+/**
+***************************************************************************
+* @brief Handles a key typed at the pager prompt. Space shows the next
+*        page, Enter the next line, and q (or CTRL_C) discards the rest
+*        of the output and aborts the command. Other keys are ignored.
+*
+* @param   cmdData_p   Pointer to command execution data.
+* @param   client_p    Pointer to client data.
+* @param   savedSig_pp Pointer to the APPTEXT being written.
+* @param   opt_p       Telnet protocol state.
+* @param   ch          Key.
+*
+***************************************************************************
+*/
+static void MoreKey(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                    union SIGNAL **savedSig_pp, const TELNET_OPT_st *opt_p,
+                    char ch)
+{
+  if ((ch != ' ') && (ch != CR) && (ch != 'q') && (ch != 'Q') &&
+      (ch != CTRL_C))
+  {
+    return;
+  }
+
+  cmdData_p->morePrompt = FALSE;
+
+  /* In LINEMODE the client has echoed the key and the line break */
+  if (!cmdData_p->localEcho)
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p, MORE_ERASE,
+                             strlen(MORE_ERASE));
+  }
+
+  if ((ch == ' ') || (ch == CR))
+  {
+    cmdData_p->linesLeft = (ch == ' ') ? PageSize(cmdData_p) - 1 : 1;
+    cmdData_p->pageEnd = PageEnd(cmdData_p, *savedSig_pp,
+                                 client_p->ptrInApptext);
+    return;
+  }
+
+  /* Quit, the rest of the output is not wanted */
+  SendAppAbort(cmdData_p);
+
+  FreeBufCmds(cmdData_p, client_p->socketId);
+  AbortOutput(cmdData_p, client_p, savedSig_pp, opt_p);
+} /* MoreKey */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "pager [on|off|<lines>]", which
+*        sets or shows the pager setting of the session. "on" uses the
+*        window size of the client.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int PagerCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                    cmd_hist *root_p, char *cmd)
+{
+  int fd = client_p->socketId;
+  const char *arg = &cmd[strlen("pager")];
+  char buf[48];
+  W32 lines;
+
+  while (*arg == ' ')
+  {
+    arg++;
+  }
+
+  if (strcmp(arg, "on") == 0)
+  {
+    cmdData_p->pager = MI_PAGER_WINDOW;
+  }
+  else if (strcmp(arg, "off") == 0)
+  {
+    cmdData_p->pager = MI_PAGER_OFF;
+  }
+  else if (*arg != '\0')
+  {
+    lines = (W32) strtoul(arg, 0, 10);
+    if ((lines < 2) || (lines > MI_PAGER_MAX_LINES))
+    {
+      (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\nUsage: pager [on|off|<lines>]",
+                               strlen("\r\nUsage: pager [on|off|<lines>]"));
+      return 0;
+    }
+    cmdData_p->pager = lines;
+  }
+
+  if (cmdData_p->pager == MI_PAGER_OFF)
+  {
+    sprintf(buf, "\r\npager off");
+  }
+  else
+  {
+    sprintf(buf, "\r\npager on, %lu lines", (unsigned long) PageSize(cmdData_p));
+  }
+  (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+
+  return 0;
+} /* PagerCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "clear", which clears the screen.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int ClearCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                    cmd_hist *root_p, char *cmd)
+{
+  (void) root_p;
+
+  (void) TelnetWriteSimple(cmdData_p->echo_p, "\033[2J\033[H",
+                           strlen("\033[2J\033[H"));
+  return 0;
+} /* ClearCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "exit", which ends the session.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  BUILTIN_EXIT, or 0 if there are arguments.
+*
+***************************************************************************
+*/
+static int ExitCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                   cmd_hist *root_p, char *cmd)
+{
+  if (cmd[strlen("exit")] != '\0')
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\nUsage: exit",
+                             strlen("\r\nUsage: exit"));
+    return 0;
+  }
+
+  return BUILTIN_EXIT;
+} /* ExitCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "history", which prints the command
+*        history of the session, oldest first.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor, with the command history.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int HistoryCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                      cmd_hist *root_p, char *cmd)
+{
+  const hist_stack *hist_p;
+  char buf[16];
+  W32 n = 1;
+
+  for (hist_p = root_p->first; hist_p != NULL; hist_p = hist_p->next)
+  {
+    sprintf(buf, "\r\n%4lu  ", (unsigned long) n++);
+    (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+    (void) TelnetWriteSimple(cmdData_p->echo_p, hist_p->buf,
+                             strlen(hist_p->buf));
+  }
+
+  return 0;
+} /* HistoryCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "session", which prints statistics
+*        and settings of the session.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int SessionCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                      cmd_hist *root_p, char *cmd)
+{
+  char buf[64];
+  W32 secs;
+
+  (void) root_p;
+
+  secs = (W32) (get_ticks() - cmdData_p->startTick) /
+         (W32) (1000000UL / system_tick());
+
+  sprintf(buf, "\r\nsession %lu, connected %lu:%02lu:%02lu",
+          (unsigned long) client_p->clientInd,
+          (unsigned long) (secs / 3600),
+          (unsigned long) ((secs / 60) % 60),
+          (unsigned long) (secs % 60));
+  (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+
+  sprintf(buf, "\r\ncommands %lu, local commands %lu",
+          (unsigned long) cmdData_p->noOfCmds,
+          (unsigned long) cmdData_p->noOfLocalCmds);
+  (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+
+  sprintf(buf, "\r\nwindow %lux%lu",
+          (unsigned long) cmdData_p->winWidth,
+          (unsigned long) cmdData_p->winHeight);
+  (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+
+  if (cmdData_p->pager == MI_PAGER_OFF)
+  {
+    sprintf(buf, "\r\npager off");
+  }
+  else
+  {
+    sprintf(buf, "\r\npager on, %lu lines", (unsigned long) PageSize(cmdData_p));
+  }
+  (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+
+  return 0;
+} /* SessionCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "time", which prints the real time
+*        of the node. The time is requested from REOS; the reply
+*        (REALTIMEGETR) is printed by the main loop, see TimeReply().
+*        Meanwhile the command is running and the following commands
+*        are buffered.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is running.
+*
+***************************************************************************
+*/
+static int TimeCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                   cmd_hist *root_p, char *cmd)
+{
+  SIGNAL *sig_p;
+
+  (void) root_p;
+
+  sig_p = OS_alloc(REALTIMEGET_S, REALTIMEGET);
+  sig_p->realtimeget.version_no = 0;
+  OS_send(&sig_p, BDT.REOS);
+
+  APT_RP_FREQUEST_TMO(&cmdData_p->timeTmo, TIME_REQ_TIMEOUT,
+                      current_process(), MICLIENTTIMETMO);
+  cmdData_p->timePending = TRUE;
+  cmdData_p->isCmdRunning = TRUE;
+
+  return 0;
+} /* TimeCmd */
+
+
+
+
+/**
+***************************************************************************
+* @brief Completes the local command "time" when REALTIMEGETR or
+*        MICLIENTTIMETMO is received. The time is printed, followed by
+*        the prompt, and the next buffered command is run.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   fd        File descriptor.
+* @param   sig_p     REALTIMEGETR, NULL if the request timed out.
+*
+***************************************************************************
+*/
+static void TimeReply(CMD_DATA_st *cmdData_p, int fd,
+                      const union SIGNAL *sig_p)
+{
+  char buf[32];
+
+  if (!cmdData_p->timePending)
+  {
+    /* Late reply, "time not available" already printed */
+    return;
+  }
+
+  if (sig_p != NULL)
+  {
+    APT_RP_CANCEL_TMO(&cmdData_p->timeTmo);
+    sprintf(buf, "\r\n%4d-%02d-%02d %02d:%02d:%02d",
+            sig_p->realtimegetr.year, sig_p->realtimegetr.month,
+            sig_p->realtimegetr.day, sig_p->realtimegetr.hour,
+            sig_p->realtimegetr.minute, sig_p->realtimegetr.second);
+  }
+  else
+  {
+    sprintf(buf, "\r\ntime not available");
+  }
+  (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+
+  cmdData_p->timePending = FALSE;
+  cmdData_p->promptPending = TRUE;
+  RunNextBufCmd(cmdData_p, fd, FALSE);
+} /* TimeReply */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "jobs", which lists the background
+*        jobs of the session.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int JobsCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                   cmd_hist *root_p, char *cmd)
+{
+  static const char *const stateName[] = {"Free", "Starting", "Running", "Done"};
+  const TELNET_JOB_st *job_p;
+  char buf[48];
+  W32 noOfJobs = 0;
+  W32 i;
+
+  (void) root_p;
+
+  for (i = 0; i < JOB_MAX; i++)
+  {
+    job_p = &cmdData_p->jobs.job[i];
+    if ((job_p->state == JOB_FREE) || job_p->queued)
+    {
+      continue;
+    }
+
+    sprintf(buf, "\r\n[%lu] %-8s %5lu bytes  ", (unsigned long) job_p->id,
+            stateName[job_p->state], (unsigned long) job_p->len);
+    (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+    (void) TelnetWriteSimple(cmdData_p->echo_p, job_p->cmd,
+                             strlen(job_p->cmd));
+    noOfJobs++;
+  }
+
+  if (noOfJobs == 0)
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\nno jobs",
+                             strlen("\r\nno jobs"));
+  }
+
+  return 0;
+} /* JobsCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "fg [n]". The output kept of the
+*        job is printed. A running job is brought to the foreground:
+*        its console handler becomes the console handler of the
+*        session, and the one of the session is kept for the next job.
+*        A finished job is removed.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int FgCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                 cmd_hist *root_p, char *cmd)
+{
+  TELNET_JOB_st *job_p;
+
+  job_p = GetJobArg(cmdData_p, client_p->socketId,
+                    &cmd[strlen("fg")]);
+  if (job_p == NULL)
+  {
+    return 0;
+  }
+
+  ForegroundJob(cmdData_p, job_p);
+
+  return 0;
+} /* FgCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "parallel [off|<n>]", which sets or
+*        shows the number of commands of the session run at a time.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int ParallelCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                       cmd_hist *root_p, char *cmd)
+{
+  const char *arg = &cmd[strlen("parallel")];
+  char buf[40];
+  W32 n;
+
+  while (*arg == ' ')
+  {
+    arg++;
+  }
+
+  if (strcmp(arg, "off") == 0)
+  {
+    cmdData_p->parallel = 1;
+  }
+  else if (*arg != '\0')
+  {
+    n = (W32) strtoul(arg, 0, 10);
+    if ((n < 1) || (n > PARALLEL_MAX))
+    {
+      sprintf(buf, "\r\nUsage: parallel [off|1..%d]", PARALLEL_MAX);
+      (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+      return 0;
+    }
+    cmdData_p->parallel = n;
+  }
+
+  if (cmdData_p->parallel < 2)
+  {
+    sprintf(buf, "\r\nparallel off");
+  }
+  else
+  {
+    sprintf(buf, "\r\nparallel %lu", (unsigned long) cmdData_p->parallel);
+  }
+  (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+
+  return 0;
+} /* ParallelCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Handles the local command "output [n]", which prints the
+*        output kept of a job. A finished job is removed, a running
+*        job continues in the background.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Pointer to client data.
+* @param   root_p    Command line editor.
+* @param   cmd       Command line.
+*
+* @return  0, the command is done.
+*
+***************************************************************************
+*/
+static int OutputCmd(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                     cmd_hist *root_p, char *cmd)
+{
+  TELNET_JOB_st *job_p;
+  W32 done;
+
+  job_p = GetJobArg(cmdData_p, client_p->socketId,
+                    &cmd[strlen("output")]);
+  if (job_p == NULL)
+  {
+    return 0;
+  }
+
+  done = (W32) (job_p->state == JOB_DONE);
+  PrintJobOutput(cmdData_p, job_p, TRUE);
+  if (done)
+  {
+    itelnet_JobFree(job_p, job_p->conh_);
+  }
+
+  return 0;
+} /* OutputCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Gets the job given as argument to "fg" or "output", the job
+*        started last if no job number is given. The output of a job
+*        is only printed when no command of the session is running.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   fd        File descriptor.
+* @param   arg       Argument, "[%]<n>" or empty.
+*
+* @return  The job, NULL if it can not be printed (the reason has been
+*          written).
+*
+***************************************************************************
+*/
+static TELNET_JOB_st *GetJobArg(CMD_DATA_st *cmdData_p, int fd,
+                                const char *arg)
+{
+  TELNET_JOB_st *job_p;
+
+  while (*arg == ' ')
+  {
+    arg++;
+  }
+  if (*arg == '%')
+  {
+    arg++;
+  }
+
+  if (cmdData_p->isCmdRunning)
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\na command is running",
+                             strlen("\r\na command is running"));
+    return NULL;
+  }
+
+  job_p = itelnet_JobGet(&cmdData_p->jobs, (W32) strtoul(arg, 0, 10));
+  if ((job_p == NULL) || (job_p->state == JOB_STARTING))
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\nno such job",
+                             strlen("\r\nno such job"));
+    return NULL;
+  }
+
+  return job_p;
+} /* GetJobArg */
+
+
+
+/**
+***************************************************************************
+* @brief Brings a job to the foreground, as the command of the session.
+*        The output kept is printed. The console handler of a running
+*        job becomes the console handler of the session, and the one of
+*        the session is kept for the next job. A finished job is
+*        removed.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   job_p     Job, running or done.
+*
+***************************************************************************
+*/
+static void ForegroundJob(CMD_DATA_st *cmdData_p, TELNET_JOB_st *job_p)
+{
+  PROCESS conh_;
+
+  if (job_p->state == JOB_DONE)
+  {
+    PrintJobOutput(cmdData_p, job_p, TRUE);
+    itelnet_JobFree(job_p, job_p->conh_);
+    return;
+  }
+
+  conh_ = cmdData_p->conh_;
+  cmdData_p->conh_ = job_p->conh_;
+  PrintJobOutput(cmdData_p, job_p, FALSE);
+  itelnet_JobFree(job_p, conh_);
+} /* ForegroundJob */
+
+
+
+/**
+***************************************************************************
+* @brief Prints the output kept of a job. The output is sent to the
+*        process itself as an APPTEXT and printed after the texts held,
+*        as the output of a command of the session.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   job_p     Job.
+* @param   completed TRUE to end the output with the prompt, FALSE if
+*                    the command continues in the foreground.
+*
+***************************************************************************
+*/
+static void PrintJobOutput(CMD_DATA_st *cmdData_p, TELNET_JOB_st *job_p,
+                           W32 completed)
+{
+  union SIGNAL *sig_p;
+  const char *prompt = NULL;
+
+  if (completed)
+  {
+    prompt = (cmdData_p->prompt[0] != '\0') ? cmdData_p->prompt :
+                                               DEFAULT_PROMPT;
+  }
+
+  sig_p = itelnet_JobOutput(job_p, prompt);
+
+  cmdData_p->isCmdRunning = TRUE;
+  cmdData_p->promptPending = FALSE;
+  cmdData_p->replay++;
+  OS_send(&sig_p, current_process());
+} /* PrintJobOutput */
+
+
+
+/**
+***************************************************************************
+* @brief Starts a background job ("<cmd> &").
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   fd        File descriptor.
+* @param   cmd       Command, without the '&'.
+*
+***************************************************************************
+*/
+static void StartJob(CMD_DATA_st *cmdData_p, int fd, const char *cmd)
+{
+  TELNET_JOB_st *job_p = NULL;
+  char buf[16];
+
+  /* The replies to console handler requests are told apart by order,
+     so a job is not started while the session waits for one. */
+  if ((cmdData_p->conh_ != 0) && !cmdData_p->conhPending)
+  {
+    job_p = itelnet_JobStart(&cmdData_p->jobs, cmd);
+  }
+
+  if (job_p == NULL)
+  {
+    (void) TelnetWriteSimple(cmdData_p->echo_p, "\r\njob not started",
+                             strlen("\r\njob not started"));
+    return;
+  }
+
+  sprintf(buf, "\r\n[%lu] ", (unsigned long) job_p->id);
+  (void) TelnetWriteSimple(cmdData_p->echo_p, buf, strlen(buf));
+  (void) TelnetWriteSimple(cmdData_p->echo_p, job_p->cmd, strlen(job_p->cmd));
+} /* StartJob */
+
+
+
+/**
+***************************************************************************
+* @brief Keeps an APPTEXT of a background job.
+*
+* @param   job_p     Job of the sender.
+* @param   sig_p     APPTEXT.
+*
+***************************************************************************
+*/
+static void JobAppText(TELNET_JOB_st *job_p, const union SIGNAL *sig_p)
+{
+  W32 completed;
+
+  completed = IsCmdCompleted(sig_p);
+  itelnet_JobText(job_p, sig_p->apptext.text,
+                  completed ? LastLineOffset(sig_p->apptext.text) :
+                              (W32) strlen(sig_p->apptext.text),
+                  completed, (W32) ((sig_p->apptext.ctrl & APPTEXT_ACK) != 0));
+} /* JobAppText */
+
+
+
+/**
+***************************************************************************
+* @brief Hashes the name of a local command.
+*
+* @param   name      Name, not terminated.
+* @param   len       Length of the name.
+*
+* @return  Slot in the hash index.
+*
+***************************************************************************
+*/
+static W32 BuiltinHash(const char *name, W32 len)
+{
+  W32 hash = 0;
+  W32 i;
+
+  for (i = 0; i < len; i++)
+  {
+    hash = (hash * 31) + (U8) name[i];
+  }
+
+  return hash & (BUILTIN_HASH_SIZE - 1);
+} /* BuiltinHash */
+
+
+
+/**
+***************************************************************************
+* @brief Builds the hash index of the local commands, open addressing
+*        with linear probing.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void InitBuiltins(CMD_DATA_st *cmdData_p)
+{
+  W32 i;
+  W32 slot;
+
+  memset(cmdData_p->builtinHash, 0, sizeof(cmdData_p->builtinHash));
+
+  for (i = 0; i < NO_OF_BUILTINS; i++)
+  {
+    slot = BuiltinHash(builtins[i].name, strlen(builtins[i].name));
+    while (cmdData_p->builtinHash[slot] != 0)
+    {
+      slot = (slot + 1) & (BUILTIN_HASH_SIZE - 1);
+    }
+    cmdData_p->builtinHash[slot] = (U8) (i + 1);
+  }
+} /* InitBuiltins */
+
+
+
+/**
+***************************************************************************
+* @brief Looks up the local command of a command line, by the first
+*        word of the line.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   cmd       Command line.
+*
+* @return  The local command, NULL if the command is not local.
+*
+***************************************************************************
+*/
+static const BUILTIN_st *FindBuiltin(const CMD_DATA_st *cmdData_p,
+                                     const char *cmd)
+{
+  const BUILTIN_st *builtin_p;
+  W32 len;
+  W32 slot;
+
+  len = (W32) strcspn(cmd, " ");
+  slot = BuiltinHash(cmd, len);
+
+  while (cmdData_p->builtinHash[slot] != 0)
+  {
+    builtin_p = &builtins[cmdData_p->builtinHash[slot] - 1];
+    if ((strlen(builtin_p->name) == len) &&
+        (strncmp(builtin_p->name, cmd, len) == 0))
+    {
+      return builtin_p;
+    }
+    slot = (slot + 1) & (BUILTIN_HASH_SIZE - 1);
+  }
+
+  return NULL;
+} /* FindBuiltin */
+
+
+
+/**
+***************************************************************************
+* @brief Looks up the local command of a command line to run. In
+*        automation mode only "automation" and "exit" are local, the
+*        output of the others would not be framed.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   cmd       Command line.
+*
+* @return  The local command, NULL if the command is not run locally.
+*
+***************************************************************************
+*/
+static const BUILTIN_st *FindLocalCmd(const CMD_DATA_st *cmdData_p,
+                                      const char *cmd)
+{
+  const BUILTIN_st *builtin_p;
+
+  builtin_p = FindBuiltin(cmdData_p, cmd);
+
+  if ((builtin_p != NULL) && cmdData_p->automation &&
+      (builtin_p->func != AutomationCmd) && (builtin_p->func != ExitCmd))
+  {
+    builtin_p = NULL;
+  }
+
+  return builtin_p;
+} /* FindLocalCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Keeps the prompt, the last line of a completing APPTEXT, to be
+*        printed after local commands. A line break without carriage
+*        return is written as CR LF.
+*
+* @param   cmdData_p Pointer to command execution data.
+* @param   text      APPTEXT text.
+*
+***************************************************************************
+*/
+static void SavePrompt(CMD_DATA_st *cmdData_p, const char *text)
+{
+  const char *prompt_p;
+  W32 len = 0;
+
+  prompt_p = text + LastLineOffset(text);
+  if (*prompt_p == '\n')
+  {
+    cmdData_p->prompt[len++] = '\r';
+  }
+
+  if ((len + strlen(prompt_p)) >= PROMPT_MAX)
+  {
+    /* Not a normal prompt, not kept */
+    cmdData_p->prompt[0] = '\0';
+    return;
+  }
+
+  strcpy(&cmdData_p->prompt[len], prompt_p);
+} /* SavePrompt */
+
+
+
+
+/**
+***************************************************************************
+* @brief Prints the prompt after local commands (promptPending), once the
+*        texts held or being written have been printed. The kept prompt
+*        is printed, or DEFAULT_PROMPT if no command has completed yet.
+*        Called at the end of each signal of the main loop.
+*
+* @param   cmdData_p Pointer to command execution data.
+*
+***************************************************************************
+*/
+static void FlushPrompt(CMD_DATA_st *cmdData_p)
+{
+  const char *prompt;
+
+  if (!cmdData_p->promptPending || cmdData_p->isCmdRunning ||
+      (cmdData_p->noOfHeld > 0) || (cmdData_p->replay > 0))
+  {
+    return;
+  }
+
+  cmdData_p->promptPending = FALSE;
+  prompt = (cmdData_p->prompt[0] != '\0') ? cmdData_p->prompt :
+                                              DEFAULT_PROMPT;
+  (void) TelnetWriteSimple(cmdData_p->echo_p, prompt, (int) strlen(prompt));
+} /* FlushPrompt */
+
+
+
+/**
+***************************************************************************
+* @brief Runs a completed command line. Local commands are run here,
+*        others are sent to the console handler. While a command is
+*        running, local commands and background jobs are buffered like
+*        the other commands and run in order; only "exit" is run at
+*        once.
+*
+* @param   cmdData_p   Pointer to command execution data.
+* @param   client_p    Client process data.
+* @param   root_p      Line editor, the command line is in cmdbuf.
+* @param   commandSize Length of command including terminating character.
+*
+* @return  BUILTIN_EXIT if the user logs out, else 0.
+*
+***************************************************************************
+*/
+static int RunCommandLine(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                          cmd_hist *root_p, int commandSize)
+{
+  const BUILTIN_st *builtin_p;
+  W32 kind = QUEUED_CMD;
+
+  builtin_p = FindLocalCmd(cmdData_p, root_p->cmdbuf);
+  if (builtin_p != NULL)
+  {
+    kind = QUEUED_LOCAL;
+  }
+  else if (!cmdData_p->automation && itelnet_JobIsBackground(root_p->cmdbuf))
+  {
+    kind = QUEUED_JOB;
+  }
+
+  if ((kind != QUEUED_CMD) && cmdData_p->isCmdRunning &&
+      ((builtin_p == NULL) || (builtin_p->func != ExitCmd)))
+  {
+    /* Run after the commands before it */
+    QueueCommand(cmdData_p, client_p->socketId, root_p->cmdbuf, kind);
+    root_p->cmdbuf[0] = '\0';
+    return 0;
+  }
+
+  if (builtin_p != NULL)
+  {
+    cmdData_p->noOfLocalCmds++;
+    commandSize = builtin_p->func(cmdData_p, client_p, root_p,
+                                  root_p->cmdbuf);
+  }
+  else if (kind == QUEUED_JOB)
+  {
+    /* Background job, the session stays free */
+    StartJob(cmdData_p, client_p->socketId, root_p->cmdbuf);
+    commandSize = 0;
+  }
+
+  if (commandSize == BUILTIN_EXIT)
+  {
+    return BUILTIN_EXIT;
+  }
+
+  if (commandSize > 0)
+  {
+    /* Send the command, or buffer it if another command is running. */
+    SendCommand(cmdData_p, client_p->socketId, root_p->cmdbuf, commandSize);
+  }
+  else if (!cmdData_p->isCmdRunning && !cmdData_p->automation)
+  {
+    /* Local command done, the prompt is printed when no printout is
+       pending (FlushPrompt). A running command prints the prompt when
+       it completes. */
+    cmdData_p->promptPending = TRUE;
+  }
+
+  /* Clear command buffer after copying it. */
+  root_p->cmdbuf[0] = '\0';
+  return 0;
+} /* RunCommandLine */
 
 
 
 /**
 ***************************************************************************
-* @brief Verifies user name and password for a user.
+* @brief Runs the command lines of pasted text (bracketed paste), or
+*        of the input in automation mode. The text is split into lines
+*        by itelnet_PasteScan, not passed to the line editor character
+*        by character, and the lines are run or buffered at once. A
+*        line is echoed when it is sent, as a typed command line.
 *
-* @param   userName   Login name of user.
-* @param   passWord   Password.
-* @param   user       OSE user number.
+* @param   cmdData_p   Pointer to command execution data.
+* @param   client_p    Client process data.
+* @param   root_p      Line editor.
+* @param   data_p      Data read from the client.
+* @param   i_p         Read index, moved past the pasted text.
+* @param   length      Length of the data.
 *
-* @return  0 if OK, an error code otherwise.
+* @return  BUILTIN_EXIT if the user logs out, else 0.
 *
 ***************************************************************************
 */
-static Boolean ValidateLogin(const char *userName, const char *passWord,
-                             OSUSER *user)
+static int PasteText(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                     cmd_hist *root_p, const char *data_p, W32 *i_p,
+                     W32 length)
 {
-#ifdef VALID_LOGIN
-  return zzvalidateLogin(userName, passWord, user);
-#else
-  (void) user;
-  
-  return ((Boolean)((strcmp(userName, "razor") == 0) &&
-                    (strcmp(passWord, "assar") == 0)));
-#endif
-} /* ValidateLogin */
+  TELNET_PASTE_st *paste_p = &cmdData_p->paste;
+  W32 result;
+  W32 len;
+  W32 j;
+  int commandSize;
+
+  while ((*i_p < length) && (paste_p->active || cmdData_p->automation))
+  {
+    result = itelnet_PasteScan(paste_p, data_p, i_p, length);
+    if (result == PASTE_MORE)
+    {
+      break;
+    }
+
+    if (result == PASTE_DONE)
+    {
+      /* The rest after the last line is left on the command line */
+      for (j = 0; !cmdData_p->automation && (paste_p->line[j] != '\0'); j++)
+      {
+        (void) itelnet_LEdit(root_p, (U8) paste_p->line[j],
+                             cmdData_p->isCmdRunning);
+      }
+      continue;
+    }
+
+    /* The line is added to the text typed before the paste */
+    len = strlen(root_p->cmdbuf);
+    strncpy(&root_p->cmdbuf[len], paste_p->line, MAX_LINE - 1 - len);
+    root_p->cmdbuf[MAX_LINE - 1] = '\0';
+
+    /* Echoed now if it is sent now, else when it is sent from the
+       buffer */
+    if (!cmdData_p->isCmdRunning && !cmdData_p->localEcho)
+    {
+      (void) TelnetWriteSimple(cmdData_p->echo_p, &root_p->cmdbuf[len],
+                               (int) strlen(&root_p->cmdbuf[len]));
+    }
+
+    /* Ends the line in the line editor (history), nothing is echoed */
+    root_p->pos = strlen(root_p->cmdbuf);
+    root_p->curr = NULL;
+    commandSize = itelnet_LEdit(root_p, CR, cmdData_p->isCmdRunning);
+    if (RunCommandLine(cmdData_p, client_p, root_p,
+                       commandSize) == BUILTIN_EXIT)
+    {
+      return BUILTIN_EXIT;
+    }
+  }
+
+  return 0;
+} /* PasteText */
 
 
 
 /**
 ***************************************************************************
-* @brief Calculates length of data text in APPTEXT.
-*
-* @param   ptr       Pointer to string.
+* @brief Ends the session at "exit". Does not return.
 *
-* @return  Length of apptext.text.
+* @param   cmdData_p Pointer to command execution data.
+* @param   client_p  Client process data.
+* @param   sig_pp    Signal being handled, freed.
 *
 ***************************************************************************
 */
-static W32 CalcApptextLength(const char *ptr)
+static void Logout(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                   union SIGNAL **sig_pp)
 {
-  W32 i = 0;
-  
-  for ( ; *ptr; ptr++)
+  /* Bracketed paste off, the terminal is used after the session */
+  (void) TelnetWriteSimple(cmdData_p->echo_p, PASTE_DISABLE,
+                           strlen(PASTE_DISABLE));
+
+  WrStrSocket(client_p->socketId, "\nlogout\n", client_p); /*lint !e534*/ /* Safe??? */
+  if (*sig_pp != NULL)
   {
-    i++;
+    OS_free(sig_pp);
   }
-  return i;
-} /* CalcApptextLength */
+
+  /* Free remaining buffered commands if any */
+  FreeBufCmds(cmdData_p, client_p->socketId);
+
+  CloseConnection(client_p);
+} /* Logout */
 
 
 
 /**
 ***************************************************************************
-* @brief Checks if the user needs to login.
+* @brief Drops the output of the running command that has not been
+*        sent, at CTRL_C, IAC IP, IAC AO or q at the pager prompt. The
+*        caller continues the output. A waiting APPTEXT is
+*        acknowledged so the console handler is not blocked, and the
+*        rest of the output of the command is discarded until it
+*        completes; only the prompt is printed. Synch is sent so the
+*        client discards the output already on its way.
 *
-* @return  TRUE if the user needs to login,
-*          FALSE otherwise.
+* @param   cmdData_p   Pointer to command execution data.
+* @param   client_p    Pointer to client data.
+* @param   savedSig_pp Pointer to the APPTEXT being written.
+* @param   opt_p       Telnet protocol state.
 *
 ***************************************************************************
 */
-static U8 NeedLogin(void)
+static void AbortOutput(CMD_DATA_st *cmdData_p, CLIENT_PROC_DATA_st *client_p,
+                        union SIGNAL **savedSig_pp, const TELNET_OPT_st *opt_p)
 {
-  char buffer[20];
+  W32 pending;
 
-  /* Check if the user needs to login. */
-#ifdef APT_PBOOT_USER
-  if((user_pboot_param_get("telnet_loginenable", buffer, 20) == 0) &&
-     (strcmp(buffer, "yes") == 0))
-#else
-  if((pboot_param_get("telnet_loginenable", buffer, 20) == 0) &&
-     (strcmp(buffer, "yes") == 0))
-#endif
+  pending = (W32) ((*savedSig_pp != NULL) || cmdData_p->isCmdRunning);
+
+  /* The rest of the output is not paged */
+  cmdData_p->morePrompt = FALSE;
+
+  /* Drop the buffered part of the printout */
+  client_p->buflen = 0;
+  client_p->bytesSent = 0;
+  client_p->bytesSentAcc = 0;
+  client_p->outBuffer_p = client_p->startOfOutBuffer_p;
+
+  if (*savedSig_pp != NULL)
   {
-    return TRUE;
+    if ((*savedSig_pp)->apptext.ctrl & APPTEXT_ACK)
+    {
+      /* Acknowledge now, the rest of the text is not sent */
+      SendAppAck(cmdData_p);
+      (*savedSig_pp)->apptext.ctrl &= ~APPTEXT_ACK;
+    }
+
+    if (IsCmdCompleted(*savedSig_pp))
+    {
+      /* Keep the prompt, it is written by ContinueOutput */
+      if (client_p->ptrInApptext < LastLineOffset((*savedSig_pp)->apptext.text))
+      {
+        client_p->ptrInApptext = LastLineOffset((*savedSig_pp)->apptext.text);
+      }
+      cmdData_p->pageEnd = client_p->apptextLength;
+    }
+    else
+    {
+      OS_free(savedSig_pp);
+      if (client_p->startOfOutBuffer_p != NULL)
+      {
+        OS_free((SIGNAL**) &(client_p->startOfOutBuffer_p));
+      }
+      client_p->outBuffer_p = NULL;
+      client_p->startOfOutBuffer_p = NULL;
+      client_p->ptrInApptext = 0;
+      client_p->apptextLength = 0;
+    }
   }
-  else
+
+  /* Output still to come from the console handler is discarded */
+  if ((*savedSig_pp == NULL) && cmdData_p->isCmdRunning)
   {
-    return FALSE;
+    cmdData_p->discardOutput = TRUE;
+  }
+
+  if (pending)
+  {
+    itelnet_OptSynch(opt_p);
   }
-} /* NeedLogin */
+} /* AbortOutput */
 
 
 
 /**
 ***************************************************************************
-* @brief Get login timeout value.
+* @brief This function closes a connection, returns the socket
+*        descriptor and kills the calling process.
 *
-* @return  Timeout value.
+* @param   client_p  Pointer to client data.
 *
 ***************************************************************************
 */
-static OSTIME GetTimeout(void)
+static void CloseConnection(const CLIENT_PROC_DATA_st *const client_p)
 {
-  char *parameter_p, buffer[20];
-  OSTIME timeOut;
+  SIGNAL *sig_p;
   
-  /* Request a timer used to supervise inactive users */
-#ifdef APT_PBOOT_USER
-  if(user_pboot_param_get("telnet_autologout", buffer, 20) == 0)
-#else
-  if(pboot_param_get("telnet_autologout", buffer, 20) == 0)
-#endif    
+  if (tip_shutdown(client_p -> socketId, (int)TIP_SHUT_RDWR) < 0)
   {
-    /* Time found in pboot parameter. */
-    timeOut = (OSTIME) strtol(buffer,0,0);
+    /* Error when shutting down socket. */
+    APT_RP_ERROR(ERROR_ID_R12_1886, (W32) tip_errno);
   }
-  else
-  {
-    /* No pboot parameter found. */
 
-    /* Check environment to find the parameter. */
-    parameter_p = get_env(get_bid(current_process()), "telnet_autologout");
-    
-    if(parameter_p)
-    {
-      timeOut = (OSTIME) strtol(buffer,0,0);
-      
-      OS_free((union SIGNAL**) buffer);
-    }
-    else
-    {
-      /* If no environment and no pboot parameter set, dont ever timeout. */
-      timeOut = 0;
-    }
+  if (tip_close(client_p -> socketId) < 0)
+  {
+    /* Error when closing socket. */
+    APT_RP_ERROR(ERROR_ID_R12_1887, (W32) tip_errno);
   }
 
-  return timeOut;
-} /* GetTimeout */
+#ifndef SOFTKERNEL  
+  /*
+   * The socket_proc_terminate function frees the process context
+   * variables used by the specified process and shall be called
+   * when a process that has been using the TIP-stack socket interface
+   * is to be terminated. Note! No more socket calls has to be made by
+   * the process in question after that this function is called.
+   * Then it will be inserted again in the context array.
+   */
+  socket_proc_terminate(current_process() );
+#endif
+  
+  /* Tell the Telnet server process that the client process is closed */
+  sig_p = OS_alloc(MISTOPCLIENTR_S, MISTOPCLIENTR);
+  sig_p->mistopclientr.clientInd = client_p -> clientInd;
+  OS_send(&sig_p, client_p -> serverPid);
+
+  /* Kill the telnet client process */
+  kill_proc(current_process());
+
+} /* CloseConnection */
+
+
+
+/**
+***************************************************************************
+* @brief Calculates length of data text in APPTEXT.
+*
+* @param   ptr       Pointer to string.
+*
+* @return  Length of apptext.text.
+*
+***************************************************************************
+*/
+static W32 CalcApptextLength(const char *ptr)
+{
+  W32 i = 0;
+  
+  for ( ; *ptr; ptr++)
+  {
+    i++;
+  }
+  return i;
+} /* CalcApptextLength */
 
 
 
@@ -1077,9 +3949,6 @@ APT_RP_PROCESS(IP_TELNET_CH)
   U8 loginTries = 0;
 
   W32 i;
-  W32 noOfBufCmds = 0;
-  W32 cmdIdx = 0;
-  W32 isCmdRunning = FALSE;
 
   char *data_p;
   int dataLength;
@@ -1087,17 +3956,25 @@ APT_RP_PROCESS(IP_TELNET_CH)
 
   union SIGNAL* signal_p;
   union SIGNAL* savedSig_p = NULL;
-  union SIGNAL* outSig_p;
-  union SIGNAL* bufCmds[MAX_BUF_CMDS];
+  union SIGNAL* reply_p;
+  union SIGNAL* clientCfg_p;
 
-  PROCESS       conh_ = 0;             /* Console handler PID */
-  LOGIN_st      login;
+  CMD_DATA_st   cmdData;
+  TELNET_OPT_st opt;
   cmd_hist*     root;
-  CANCEL_INFO   canTmo;
   OSTIME        timeOut;
+  Boolean       loginEnable;
+  OSTIME        autoLogout;
+  W32           pagerLines;
+  W32           peerAddress = 0;
+  W32           skip;
+  TELNET_JOB_st *job_p;
+  struct tip_sockaddr_in addr;
+  tip_socklen_t size;
   char          syncBuf[1500];
 
   static SIGSELECT startClientReq[] = {1,MISTARTCLIENT};
+  static SIGSELECT clientCfgReq[] = {1,MICLIENTCFG};
 
   /*
    * Wait for start signal from IP_TELNET_SERVER
@@ -1111,6 +3988,19 @@ APT_RP_PROCESS(IP_TELNET_CH)
   clientProcData.serverPid = OS_sender(&signal_p);
   clientProcData.socketId = (int) signal_p->mistartclient.clientSockId;
   clientProcData.clientInd = signal_p->mistartclient.clientInd;
+
+  /* Take over the echo queue of the client individual. The blocks of
+     a previous client process were freed when it was killed. */
+  if (clientProcData.clientInd >= MAX_CONNECTIONS)
+  {
+    /* Bad client individual */
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_17, clientProcData.clientInd);
+    kill_proc(current_process());
+  }
+  echoQueue[clientProcData.clientInd].fd = clientProcData.socketId;
+  echoQueue[clientProcData.clientInd].len = 0;
+  echoQueue[clientProcData.clientInd].first_p = NULL;
+  echoQueue[clientProcData.clientInd].last_p = NULL;
   clientProcData.buflen = 0;
   clientProcData.bytesSent = 0;
   clientProcData.bytesSentAcc = 0;
@@ -1121,6 +4011,14 @@ APT_RP_PROCESS(IP_TELNET_CH)
 
   OS_free(&signal_p);
 
+  /*
+   * Wait for the session configuration, sent after the start signal
+   */
+  clientCfg_p = OS_receive(clientCfgReq);
+  loginEnable = clientCfg_p->miclientcfg.loginEnable;
+  autoLogout = clientCfg_p->miclientcfg.autoLogout;
+  pagerLines = clientCfg_p->miclientcfg.pagerLines;
+
   /* Check the socket validity. */
   if(!clientProcData.socketId)
   {
@@ -1128,6 +4026,14 @@ APT_RP_PROCESS(IP_TELNET_CH)
     APT_RP_ERROR(ERROR_ID_R12_1888, (W32) clientProcData.socketId);
   }
 
+  /* Source address, used to throttle failed logins */
+  size = sizeof(addr);
+  if (tip_getpeername(clientProcData.socketId,
+                      (struct tip_sockaddr *) &addr, &size) == 0)
+  {
+    peerAddress = tip_ntohl(addr.sin_addr.s_addr);
+  }
+
   /*
    * Subscribe on socket closed events, socket read events and 
    * socket write events
@@ -1137,19 +4043,9 @@ APT_RP_PROCESS(IP_TELNET_CH)
     APT_RP_ERROR(ERROR_ID_R12_1889, (W32) tip_errno);
   }
 
-  /* Reset login structure and make server echo by default. */
-  login.hostecho_s = 1;
-  login.peerecho_s = 0;
-  login.hostsga_s = 0;
-
-  /* Send initial telnet setup commands to client. */
-  TelnetWriteCmd(clientProcData.socketId, (U8)WILL, TELOPT_SGA);
-  if(tip_errno !=0)
-  {
-    CloseConnection(&clientProcData);
-  }
-  TelnetWriteCmd(clientProcData.socketId, (U8)WILL, TELOPT_ECHO);
-  if(tip_errno !=0)
+  /* Send initial telnet setup commands to client, server echoes
+     by default. */
+  if (itelnet_OptStart(&opt, clientProcData.socketId) != 0)
   {
     CloseConnection(&clientProcData);
   }
@@ -1157,16 +4053,57 @@ APT_RP_PROCESS(IP_TELNET_CH)
   root = (cmd_hist *) OS_alloc(sizeof(cmd_hist), 0);
   memset(root, 0, sizeof(cmd_hist));
   root->fd = clientProcData.socketId;
-  root->output = TelnetWriteSimple;
-
-  /* Initialize buffer for commands */
-  for (i=0; i<MAX_BUF_CMDS; i++)
-  {
-    bufCmds[i] = NULL;
-  }
+  root->output = LEditOutput;
+
+  /* Initialize command execution data */
+  cmdData.conh_ = 0;
+  cmdData.conhPending = FALSE;
+  cmdData.conhTmoPending = FALSE;
+  cmdData.isCmdRunning = FALSE;
+  cmdData.localEcho = FALSE;
+  cmdData.discardOutput = FALSE;
+  cmdData.paused = FALSE;
+  cmdData.ackHeld = FALSE;
+  cmdData.pager = pagerLines;
+  cmdData.winWidth = 0;
+  cmdData.winHeight = 0;
+  cmdData.linesLeft = PageSize(&cmdData) - 1;
+  cmdData.pageEnd = 0;
+  cmdData.morePrompt = FALSE;
+  cmdData.filter_p = NULL;
+  cmdData.watch_p = NULL;
+  cmdData.watchTickPending = FALSE;
+  cmdData.timePending = FALSE;
+  cmdData.prompt[0] = '\0';
+  cmdData.startTick = get_ticks();
+  cmdData.noOfCmds = 0;
+  cmdData.noOfLocalCmds = 0;
+  InitBuiltins(&cmdData);
+  itelnet_JobInit(&cmdData.jobs);
+  itelnet_PasteInit(&cmdData.paste);
+  cmdData.automation = FALSE;
+  cmdData.autoBase = 0;
+  cmdData.parallel = 1;
+  cmdData.cmdReadOnly = FALSE;
+  cmdData.cfg_p = clientCfg_p;
+  cmdData.replay = 0;
+  cmdData.noOfHeld = 0;
+  cmdData.promptPending = FALSE;
+  cmdData.noOfHeldSelf = 0;
+  cmdData.heldFirst_p = NULL;
+  cmdData.heldLast_p = NULL;
+  cmdData.heldSelfLast_p = NULL;
+  cmdData.queueFirst_p = NULL;
+  cmdData.queueLast_p = NULL;
+  cmdData.noOfQueued = 0;
+  cmdData.queuedBytes = 0;
+  cmdData.inputStopped = FALSE;
+  cmdData.echo_p = &echoQueue[clientProcData.clientInd];
+  cmdData.client_p = &clientProcData;
+  cmdData.root_p = root;
 
   /* Check if login is needed. */
-  if(NeedLogin())
+  if(loginEnable)
   {
     /* Login needed. */
     clientState = CLIENT_STATE_LOGIN;
@@ -1186,10 +4123,17 @@ APT_RP_PROCESS(IP_TELNET_CH)
     clientState = CLIENT_STATE_LOGGEDIN;
     
     /* Get the timeout value. */
-    timeOut = GetTimeout();
+    timeOut = autoLogout;
     
-    /* Get the console process. */
-    conh_ = ReqConsoleHandler();
+    /* Request the console process. */
+    ReqConsoleHandler(&cmdData);
+    
+    /* Let the client edit the command lines if it can. */
+    itelnet_OptLineMode(&opt);
+
+    /* Let the terminal mark pasted text (bracketed paste). */
+    (void) TelnetWriteSimple(cmdData.echo_p, PASTE_ENABLE,
+                             strlen(PASTE_ENABLE));
     
     /* Write welcome to screen. */
     if (WrStrSocket(clientProcData.socketId,
@@ -1202,238 +4146,52 @@ APT_RP_PROCESS(IP_TELNET_CH)
     }
   }
   
-  /* Request timeout if needed. */
+  /* Request inactivity supervision by the server if needed. */
   if(timeOut)
-  {
-    APT_RP_FREQUEST_TMO(&canTmo, timeOut, current_process(), TMO_SIG);
-  }
-  
-  /* Enter main loop. */
-  while(1)                                              /*lint !e716*/
-  {
-    signal_p = OS_receive(any);
-
-    switch(signal_p->sig_no)
-    {
-      case TIP_SOCKET_CHANGED_EVENT:
-      {
-        if (signal_p->tip_socket_changed_event.event == (U16)TIP_FD_CLOSE)
-        {
-          if ((long)signal_p->tip_socket_changed_event.socket == clientProcData.socketId)
-          {
-            if(signal_p != NULL)
-            {
-              OS_free(&signal_p);
-            }
-            CloseConnection(&clientProcData);
-          }
-          else
-          {
-            /* Bad socket */
-            APT_RP_ERROR(ERROR_ID_R12_1890,
-                         signal_p->tip_socket_changed_event.socket);
-          }
-          /* The socket was closed by peer */
-        }
-        else if (signal_p->tip_socket_changed_event.event == (U16)TIP_FD_WRITE)
-        {
-          /* The socket is writable */
-          if (clientProcData.buflen)
-          {
-            /* There is still data in the buffer to send */
-            if (TelnetWrite(clientProcData.socketId,
-                            (clientProcData.startOfOutBuffer_p + clientProcData.bytesSentAcc),
-                            &clientProcData) != 0)
-            {
-              if ( (tip_errno == (int)TIP_EWOULDBLOCK) OR (tip_errno == (int)TIP_ESUCCESS) )
-              {
-                /* INETR would block or INETR couldn't send what we requested. */
-                /* Keep savedSig_p. Get out of here and wait for               */
-                /* TIP_SOCKET_CHANGED_EVENT with event TIP_FD_WRITE.           */
-                break;
-              }
-              else
-              {
-                /* INETR has reported an error we cannot handle. Close connection. */
-                if (clientProcData.outBuffer_p != NULL)
-                {
-                  OS_free((SIGNAL**) &(clientProcData.outBuffer_p));
-                }
-                if (savedSig_p != NULL)
-                {
-                  OS_free(&savedSig_p);
-                }
-                if(signal_p != NULL)
-                {
-                  OS_free(&signal_p);
-                }
-                CloseConnection(&clientProcData);
-              }
-            } 
-          }
-          
-          if ( (clientProcData.buflen == 0) AND
-               (savedSig_p != NULL) )
-          {
-            if (clientProcData.ptrInApptext < clientProcData.apptextLength)
-            {
-              /* There is still data in APPTEXT to send */
-
-              DEBUG_PRINT(("Calling WrApptextStrSocket after TIP_FD_WRITE, apptext = \"%s\"\n, clientProcData.bytesSent = %ld\n", savedSig_p->apptext.text, clientProcData.bytesSent));
-
-              if (WrApptextStrSocket(clientProcData.socketId,
-                                     &(savedSig_p -> apptext.text[clientProcData.ptrInApptext]),
-                                     &clientProcData) != 0)
-              {
-                if (tip_errno == (int)TIP_ESUCCESS)
-                {
-                  /* INETR couldn't send what we requested. Keep savedSig_p. */
-                  /* Get out of here and wait for                      */
-                  /* TIP_SOCKET_CHANGED_EVENT with event TIP_FD_WRITE. */
-                  
-                  DEBUG_PRINT(("----> TIP_ESUCCESS after TIP_FD_WRITE\n"));
-                  break;
-                }
-                else if (tip_errno == (int)TIP_EWOULDBLOCK)
-                {
-                  /* INETR would block. Keep savedSig_p.               */
-                  /* Get out of here and wait for                      */
-                  /* TIP_SOCKET_CHANGED_EVENT with event TIP_FD_WRITE. */
-
-                  DEBUG_PRINT(("----> TIP_EWOULDBLOCK after TIP_FD_WRITE\n"));
-                  break;
-                }
-                else
-                {
-                  /* INETR has reported an error we cannot handle. Close connection. */
-                  if (clientProcData.outBuffer_p != NULL)
-                  {
-                    OS_free((SIGNAL**) &(clientProcData.outBuffer_p));
-                  }
-                  if (savedSig_p != NULL)               /*lint !e774*/
-                  {
-                    OS_free(&savedSig_p);
-                  }
-                  if(signal_p != NULL)
-                  {
-                    OS_free(&signal_p);
-                  }
-                  CloseConnection(&clientProcData);
-                }
-              }
-            }
-
-            if (clientProcData.outBuffer_p != NULL)
-            {
-              OS_free((SIGNAL**) &(clientProcData.outBuffer_p));
-              clientProcData.outBuffer_p = NULL;
-              clientProcData.startOfOutBuffer_p = NULL;
-            }
-            
-            if (savedSig_p != NULL)
-            {
-              /* Check if confirm is requested. */
-              if (savedSig_p->apptext.ctrl & APPTEXT_ACK)
-              {
-/*              printf("APPCTRL_ACK sent after TIP_FD_WRITE handled\n");*/
-                
-                /* ACK (flow control) requested. */
-                outSig_p = OS_alloc(APPCTRL_S, APPCTRL);
-                outSig_p->appctrl.data = APPCTRL_ACK;
-                OS_send(&outSig_p, conh_);
-              }
-
-              /* Check if command is completed.
-                 Note: due to a probable fault in consolehandler, when executing
-                 help command "?" the apptext signal with APPTEXT_RDY is not
-                 send when command is completed. For that reason it's necessary
-                 to additionally check if prompt text without RDY flag is
-                 received, and if so behave as if command is completed. */
-              if ((savedSig_p->apptext.ctrl & APPTEXT_RDY)
-                  OR
-                  ((clientProcData.apptextLength == 9)
-                   AND
-                   (strcmp(savedSig_p->apptext.text, "\r\nOSmon> ") == 0))
-                  OR
-                  ((clientProcData.apptextLength == 8)
-                   AND
-                   (strcmp(savedSig_p->apptext.text, "\r\nOSmon>") == 0)))
-              {
-                /* The command has been completed (all output signals have
-                   been received). */
-
-                /* Unset flag indicating ongoing command */
-                isCmdRunning = FALSE;
+  {
+    itelnet_TmoRequest(clientProcData.serverPid, clientProcData.clientInd,
+                       timeOut);
+  }
+  
+  /* Enter main loop. */
+  while(1)                                              /*lint !e716*/
+  {
+    signal_p = OS_receive(any);
+    leditEcho_p = cmdData.echo_p;     /* See LEditOutput() */
 
-                /* Check the if there are any buffered (awaiting) commands
-                   and if so execute the next command. */
-                if (noOfBufCmds > 0)
-                {
-                  /* Check if previous command was not the last one */
-                  if (cmdIdx < noOfBufCmds)
-                  {
-                    /* For safety check if stored command is not NULL */
-                    if (bufCmds[cmdIdx] != NULL)
-                    {
-                      commandSize = strlen((char*)(bufCmds[cmdIdx]->appcmd.cmd));
-
-                      /* Print the command on the telnet console */
-                      if (TelnetWriteSimple(clientProcData.socketId,
-                                            (char*)(bufCmds[cmdIdx]->appcmd.cmd),
-                                            commandSize) != 0)
-                      {
-                        APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_6, (W32)tip_errno,
-                                            __LINE__, __FILE__,
-                                            0);
-                      }
-
-                      /* Send command to OSmonitor */
-                      OS_send(&(bufCmds[cmdIdx]), conh_);
-
-                      /* Set flag indicating ongoing command */
-                      isCmdRunning = TRUE;
-
-                      /* Set command index to point to the next command */
-                      cmdIdx++;
-                    }
-                    else
-                    {
-                      /* Stored command is NULL, this should never happen and
-                         indicates internal fault in RTIPGPHR. Report RPTERROR
-                         and free all remaining stored commands (if any)
-                         to avoid memory leaks. */
-                      APT_RP_ERROR2(ERROR_ID_G12B_RTIPGPHR_8, 0,
-                                    __LINE__, __FILE__,
-                                    2,           /* Num of extra parameters 0-65535 */
-                                    cmdIdx,
-                                    noOfBufCmds);
-
-                      for (cmdIdx = 0; cmdIdx < MAX_BUF_CMDS; cmdIdx++)
-                      {
-                        if (bufCmds[cmdIdx] != NULL)
-                        {
-                          OS_free(&(bufCmds[cmdIdx]));
-                        }
-                      }
-
-                      noOfBufCmds = 0;
-                      cmdIdx = 0;
-                    }
-                  }
-                  else
-                  {
-                    /* No more commands to execute, clear the variables used
-                       for handling of buffered commands */
-                    noOfBufCmds = 0;
-                    cmdIdx = 0;
-                  }
-                }
-              }
-           
-              OS_free(&savedSig_p);
-              savedSig_p = NULL;
+    switch(signal_p->sig_no)
+    {
+      case TIP_SOCKET_CHANGED_EVENT:
+      {
+        if (signal_p->tip_socket_changed_event.event == (U16)TIP_FD_CLOSE)
+        {
+          if ((long)signal_p->tip_socket_changed_event.socket == clientProcData.socketId)
+          {
+            if(signal_p != NULL)
+            {
+              OS_free(&signal_p);
             }
+            CloseConnection(&clientProcData);
+          }
+          else
+          {
+            /* Bad socket */
+            APT_RP_ERROR(ERROR_ID_R12_1890,
+                         signal_p->tip_socket_changed_event.socket);
           }
+          /* The socket was closed by peer */
+        }
+        else if (signal_p->tip_socket_changed_event.event == (U16)TIP_FD_WRITE)
+        {
+          /* The socket is writable. Continue with the echo and the
+             printout waiting for it. */
+          if (ContinueOutput(&cmdData, &clientProcData, &savedSig_p) != 0)
+          {
+            /* INETR has reported an error we cannot handle. Close connection. */
+            OS_free(&signal_p);
+            CloseConnection(&clientProcData);
+          }
+          ResumeInput(&cmdData, clientProcData.socketId);
         }
         else if (signal_p->tip_socket_changed_event.event == (int)TIP_FD_READ)
         {
@@ -1446,22 +4204,30 @@ APT_RP_PROCESS(IP_TELNET_CH)
             break;
           }
           
-          /* TELNET options to server from client. */
-          if((dataLength >= 3) && (data_p[0] == IAC))
-          {
-            i = TelnetServerOptions(&login, clientProcData.socketId, (W32) dataLength, data_p);
-
-            /*
-             * Since TelnetServerOptions does not seem to handle 
-             * suboptions correctly, avoid processing the suboptions
-             * as printable characters
-             */
-            i = (W32) dataLength;
-          }
-          else
+          /* Handle and remove the TELNET commands from client. */
+          dataLength = (int) itelnet_OptFilter(&opt, data_p, (W32) dataLength);
+          i = 0;
+
+          /* Abort output (IAC AO), the command continues */
+          if (opt.abortOutput)
           {
-            i = 0;
+            opt.abortOutput = FALSE;
+            if (clientState == CLIENT_STATE_LOGGEDIN)
+            {
+              AbortOutput(&cmdData, &clientProcData, &savedSig_p, &opt);
+              if (ContinueOutput(&cmdData, &clientProcData, &savedSig_p) != 0)
+              {
+                OS_free(&signal_p);
+                CloseConnection(&clientProcData);
+              }
+            }
           }
+
+          /* In LINEMODE the client echoes the command line. */
+          cmdData.localEcho = opt.localEdit || cmdData.automation;
+          root->output = cmdData.localEcho ? NoEcho : LEditOutput;
+          cmdData.winWidth = opt.winWidth;
+          cmdData.winHeight = opt.winHeight;
           
           /* Process received data as a character stream. */
           while(i < (W32) dataLength)
@@ -1485,7 +4251,7 @@ APT_RP_PROCESS(IP_TELNET_CH)
                 }
                 
                 /* Echo the character. */
-                if (TelnetWriteSimple(clientProcData.socketId, &ch, 1) != 0)
+                if (TelnetWriteSimple(cmdData.echo_p, &ch, 1) != 0)
                 {
                   APT_RP_DOTRACE_LEV1(ERROR_ID_R12_2101, (W32) tip_errno,
                                       __LINE__, __FILE__,
@@ -1499,139 +4265,127 @@ APT_RP_PROCESS(IP_TELNET_CH)
               case CLIENT_STATE_PASSWORD:
                 if(AddCharacter(ch, password, &position, MAX_PASSWD_LEN))
                 {
-                  if(ValidateLogin(userName, password, 0)) /*lint !e645*/
+                  /* Verify the login, the result is returned in
+                     MIAUTHREPLY */
+                  itelnet_AuthRequest(clientProcData.clientInd, peerAddress,
+                                      userName, password); /*lint !e645*/
+                  memset(password, 0, sizeof(password));
+                  
+                  clientState = CLIENT_STATE_AUTH;
+                }                
+                break;
+                
+              case CLIENT_STATE_AUTH:
+                /* Waiting for the login result, discard the input */
+                break;
+                
+              case CLIENT_STATE_LOGGEDIN:
+                /* Pasted text, or input in automation mode, split into
+                   command lines at once. The character read is part of
+                   it. CTRL_C (IAC IP) is handled below. */
+                if((cmdData.paste.active || cmdData.automation) &&
+                   (ch != CTRL_C))
+                {
+                  i--;
+                  if (PasteText(&cmdData, &clientProcData, root, data_p, &i,
+                                (W32) dataLength) == BUILTIN_EXIT)
                   {
-                    /* Login accepted. */
-                    
-                    timeOut = GetTimeout();
-                    
-                    clientState = CLIENT_STATE_LOGGEDIN;
-                    
-                    /* Get the console process. */
-                    conh_ = ReqConsoleHandler();
-                    
-                    /* Write welcome to screen. */
-                    if (WrStrSocket(clientProcData.socketId,
-                                    "\n\nWelcome to the RAZOR Telnet shell, type 'help' for a\n\r"
-                                    "list of available commands, 'exit' to end the session.",
-                                    &clientProcData) != 0)
-                    {
-/*                    printf("TelnetWrite failed at pwd, with error code = %d\n", tip_errno);*/
-                    }
+                    Logout(&cmdData, &clientProcData, &signal_p);
+                  }
+                  break;
+                }
+
+                /* Flow control, not passed to the line editor. */
+                if(ch == XOFF)
+                {
+                  cmdData.paused = TRUE;
+                  break;
+                }
+                if(ch == XON)
+                {
+                  cmdData.paused = FALSE;
+                  if (ContinueOutput(&cmdData, &clientProcData, &savedSig_p) != 0)
+                  {
+                    OS_free(&signal_p);
+                    CloseConnection(&clientProcData);
                   }
-                  else
+                  break;
+                }
+
+                /* Any key ends the watch mode. */
+                if(cmdData.watch_p != NULL)
+                {
+                  StopWatch(&cmdData, savedSig_p);
+
+                  /* In LINEMODE the rest of the line is the key too */
+                  if (cmdData.localEcho)
                   {
-                    /* Login denied. */
-                    
-                    WrStrSocket(clientProcData.socketId, "\nLogin incorrect\n",
-                                &clientProcData); /*lint !e534*/ /* Safe??? */
-                    
-                    loginTries++;
-                    if(loginTries < MAX_LOGIN_TRIES)
-                    {
-                      clientState = CLIENT_STATE_LOGIN;
-                      
-                      WrStrSocket(clientProcData.socketId, "\nlogin: ",
-                                  &clientProcData);         /*lint !e534*/ /* Safe??? */
-                    }
-                    else
-                    {
-                      CloseConnection(&clientProcData);
-                    }
+                    i = (W32) dataLength;
                   }
+                  break;
                 }
-                
-                break;
-                
-              case CLIENT_STATE_LOGGEDIN:
+
+                /* Key at the pager prompt, not passed to the line editor. */
+                if(cmdData.morePrompt)
+                {
+                  MoreKey(&cmdData, &clientProcData, &savedSig_p, &opt, ch);
+                  if (ContinueOutput(&cmdData, &clientProcData, &savedSig_p) != 0)
+                  {
+                    OS_free(&signal_p);
+                    CloseConnection(&clientProcData);
+                  }
+
+                  /* In LINEMODE the rest of the line is the answer too */
+                  if (cmdData.localEcho)
+                  {
+                    i = (W32) dataLength;
+                  }
+                  break;
+                }
+
                 /* Look for VT 100 command/control sequence. */
                 if(ch == ESC)
                 {
+                  /* Start of pasted text (bracketed paste). */
+                  if (itelnet_PasteBegin(&cmdData.paste, data_p, &i,
+                                         (W32) dataLength))
+                  {
+                    break;
+                  }
+
                   /* Preprocess the control sequence. */
                   ch = HandleEscSeq(data_p, &i);
                 }
 
                 /* Call command line edit function. Returned size includes
                    terminating character (in case size is > 0). */
-                commandSize = itelnet_LEdit(root, (U8)ch, isCmdRunning);
+                commandSize = itelnet_LEdit(root, (U8)ch, cmdData.isCmdRunning);
 
                 /* Check if command completed. */
                 if(commandSize > 0)
                 {
-                  /*
-                  ** A command has been completed, check for 'exit' before
-                  ** sending it to the console handler.
-                  */
-                  if((root->cmdbuf[0] == 'e') && !strcmp(root->cmdbuf, "exit"))
+                  if (RunCommandLine(&cmdData, &clientProcData, root,
+                                     commandSize) == BUILTIN_EXIT)
                   {
                     /* User wants to quit. */
-                    WrStrSocket(clientProcData.socketId, "\nlogout\n",
-                                &clientProcData); /*lint !e534*/ /* Safe??? */
-                    if(signal_p != NULL)
-                    {
-                      OS_free(&signal_p);
-                    }
-
-                    /* Free remaining buffered commands if any */
-                    if (noOfBufCmds > 0)
-                    {
-                      /* Free all remaining commands in the buffer */
-                      while (cmdIdx < noOfBufCmds)
-                      {
-                        if (bufCmds[cmdIdx] != NULL)
-                        {
-                          OS_free(&(bufCmds[cmdIdx]));
-                        }
-                        cmdIdx++;
-                      }
-                    }
-
-                    CloseConnection(&clientProcData);
-                  }
-
-                  /* Check if another command is not already running */
-                  if (isCmdRunning == FALSE)
-                  { 
-                    /* Send complete command to OSmonitor. */
-                    outSig_p = OS_alloc(APPCMD_S + commandSize, APPCMD); /*lint !e737*/
-                    strcpy((char*) outSig_p->appcmd.cmd, root->cmdbuf);
-                    OS_send(&outSig_p, conh_);
-
-                    /* Set flag indicating ongoing command */
-                    isCmdRunning = TRUE;
-                  }
-                  else
-                  {
-                    /* Another command is already running. This can happen in
-                       case of copy-paste of multiple commands into the telnet
-                       console. Store the new command, it will be executed after
-                       all preceding commands are finished. */
-
-                    /* Make sure there is a place in the buffer for commands */
-                    if (noOfBufCmds < MAX_BUF_CMDS)
-                    {
-                      /* Allocate the signal for the command and store it */
-                      bufCmds[noOfBufCmds] = OS_alloc(APPCMD_S + commandSize, APPCMD); /*lint !e737*/
-                      strcpy((char*)(bufCmds[noOfBufCmds]->appcmd.cmd), root->cmdbuf);
-                      noOfBufCmds++;
-                    }
-                    else
-                    {
-                      APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_4, 0,
-                                          __LINE__, __FILE__,
-                                          0);
-                    }
+                    Logout(&cmdData, &clientProcData, &signal_p);
                   }
-
-                  /* Clear command buffer after copying it. */
-                  root->cmdbuf[0] = '\0';
                 }
-                else if(ch == CTRL_C)
+                else if((ch == CTRL_C) && (cmdData.conh_ != 0))
                 {
                   /* Abort job. */
-                  outSig_p= OS_alloc(APPCTRL_S, APPCTRL);
-                  outSig_p->appctrl.data = APPCTRL_ABORT;
-                  OS_send(&outSig_p, conh_);
+                  SendAppAbort(&cmdData);
+
+                  /* Drop the commands typed ahead and the output that
+                     has not been sent, also when paused. */
+                  cmdData.paused = FALSE;
+                  FreeBufCmds(&cmdData, clientProcData.socketId);
+                  AbortOutput(&cmdData, &clientProcData, &savedSig_p, &opt);
+                  if (ContinueOutput(&cmdData, &clientProcData, &savedSig_p) != 0)
+                  {
+                    OS_free(&signal_p);
+                    CloseConnection(&clientProcData);
+                  }
                 }
                 
                 break;
@@ -1645,9 +4399,17 @@ APT_RP_PROCESS(IP_TELNET_CH)
           /* Check if timeout is active. */
           if(timeOut)
           {
-            /* Timeout is restarted. */
-            APT_RP_RESET_TMO(&canTmo, timeOut);
+            /* Record activity, the server restarts the timeout lazily. */
+            itelnet_TmoTouch(clientProcData.clientInd);
           } 
+
+          /* The echo is not dropped. While much of it waits for the
+             socket the client is not read, so TCP stops it. */
+          if (!cmdData.inputStopped &&
+              (cmdData.echo_p->len > ECHO_QUEUE_MAX_BYTES))
+          {
+            StopInput(&cmdData, clientProcData.socketId, TRUE);
+          }
         }
         else
         {
@@ -1664,178 +4426,186 @@ APT_RP_PROCESS(IP_TELNET_CH)
         /* Check if logged in. */
         if(clientState == CLIENT_STATE_LOGGEDIN)
         {
-          /* Client logged in. */
-          if (savedSig_p != NULL)
+          /* Output of a background job, kept until it is retrieved */
+          job_p = itelnet_JobFind(&cmdData.jobs, OS_sender(&signal_p));
+          if (job_p != NULL)
           {
-            DEBUG_PRINT(("Calling WrApptextStrSocket after APPTEXT, apptext = \"%s\"\n, clientProcData.bytesSent = %ld\n", savedSig_p->apptext.text, clientProcData.bytesSent));
+            JobAppText(job_p, signal_p);
+            break;
           }
 
-          clientProcData.ptrInApptext = 0;
-          clientProcData.buflen = 0;
-          clientProcData.apptextLength = CalcApptextLength(signal_p -> apptext.text);
-
-          /* Allocate memory for the out buffer used when sending data to the client */
-          clientProcData.outBuffer_p = (char*) OS_alloc(sizeof(char) * BUFFER_SIZE, 0);
-          clientProcData.startOfOutBuffer_p = clientProcData.outBuffer_p;
-          
-          /* Print the message to the client. */          
-          if (WrApptextStrSocket(clientProcData.socketId,
-                                 signal_p->apptext.text, &clientProcData) != 0)
+          /* Client logged in. */
+          if (OS_sender(&signal_p) == current_process())
           {
-            if (tip_errno == (int)TIP_ESUCCESS)
+            /* Text held while the output was stopped. It is held
+               again if the output is stopped or another text is being
+               written, or if earlier texts are held again. */
+            if (OutputStopped(&cmdData) || (savedSig_p != NULL) ||
+                (cmdData.noOfHeldSelf > 0))
             {
-              /* INETR couldn't send what we requested. Save signal. */
-              /* Get out of here and wait for                      */
-              /* TIP_SOCKET_CHANGED_EVENT with event TIP_FD_WRITE. */
-              
-              DEBUG_PRINT(("----> TIP_ESUCCESS after APPTEXT\n"));
-              savedSig_p = signal_p;
-              signal_p = NULL; /* to prevent it from being freed at the end */
+              HoldAppText(&cmdData, &signal_p);
+              if (!OutputStopped(&cmdData) && (savedSig_p == NULL) &&
+                  (cmdData.replay == 0))
+              {
+                ReplayHeld(&cmdData);
+              }
               break;
             }
-            else if (tip_errno == (int)TIP_EWOULDBLOCK)
+
+            cmdData.replay--;
+            if ((cmdData.replay == 0) && (cmdData.noOfHeld > 0))
             {
-              /* INETR would block. Save signal.                   */
-              /* Get out of here and wait for                      */
-              /* TIP_SOCKET_CHANGED_EVENT with event TIP_FD_WRITE. */
-              
-              DEBUG_PRINT(("----> TIP_EWOULDBLOCK after APPTEXT\n"));
-              savedSig_p = signal_p;
-              signal_p = NULL; /* to prevent it from being freed at the end */
-              break;
+              /* Texts received during the replay follow this one */
+              ReplayHeld(&cmdData);
             }
-            else
+          }
+          else if (OutputStopped(&cmdData) || (savedSig_p != NULL) ||
+                   (cmdData.replay > 0))
+          {
+            /* Stopped, another text is being written, or held texts
+               to print first */
+            HoldAppText(&cmdData, &signal_p);
+            break;
+          }
+
+          /* The prompt is kept for the local commands */
+          if (IsCmdCompleted(signal_p))
+          {
+            SavePrompt(&cmdData, signal_p->apptext.text);
+          }
+
+          if (cmdData.discardOutput)
+          {
+            /* The output of an aborted command is discarded, only the
+               prompt is printed when the command completes */
+            if (!IsCmdCompleted(signal_p))
             {
-              
-              /* INETR has reported an error we cannot handle. Close connection. */
-              if (clientProcData.outBuffer_p != NULL)
-              {
-                /* OS_free((SIGNAL**) &(clientProcData.outBuffer_p)); */
-                APT_RP_ERROR(ERROR_ID_R12_1893,(W32) &(clientProcData.outBuffer_p) );
-              }
-              if(signal_p != NULL)
-              {
-                OS_free(&signal_p);
-              }
-              if (savedSig_p != NULL)
+              if (signal_p->apptext.ctrl & APPTEXT_ACK)
               {
-                OS_free(&savedSig_p);
+                AckAppText(&cmdData);
               }
-              CloseConnection(&clientProcData);
+              break;
             }
+            cmdData.discardOutput = FALSE;
+            itelnet_FilterEnd(&cmdData.filter_p);
+            skip = LastLineOffset(signal_p->apptext.text);
           }
-          
-          if (clientProcData.outBuffer_p != NULL)
+          else
           {
-            OS_free((SIGNAL**) &(clientProcData.outBuffer_p));
-            clientProcData.outBuffer_p = NULL;
-            clientProcData.startOfOutBuffer_p = NULL;
+            skip = 0;
+
+            /* Output filter of the command, "| grep" etc. */
+            if ((cmdData.filter_p != NULL) &&
+                FilterAppText(&cmdData, &signal_p))
+            {
+              break;
+            }
+
+            /* In watch mode the output is drawn when the command
+               completes */
+            if ((cmdData.watch_p != NULL) &&
+                WatchAppText(&cmdData, &signal_p))
+            {
+              break;
+            }
           }
-          
-          if (signal_p != NULL)
+
+          /* In automation mode the output is framed */
+          if (cmdData.automation)
           {
-            /* Check if confirm is requested. */
-            if (signal_p->apptext.ctrl & APPTEXT_ACK)
+            if (AutoAppText(&cmdData, &signal_p, skip))
             {
-              /* ACK (flow control) requested. */
-              outSig_p = OS_alloc(APPCTRL_S, APPCTRL);
-              outSig_p->appctrl.data = APPCTRL_ACK;
-              OS_send(&outSig_p, conh_);
+              break;
             }
+            skip = 0;
+          }
 
-            /* Check if command is completed.
-               Note: due to a probable fault in consolehandler, when executing
-               help command "?" the apptext signal with APPTEXT_RDY is not
-               send when command is completed. For that reason it's necessary
-               to additionally check if prompt text without RDY flag is
-               received, and if so behave as if command is completed. */
-            if ((signal_p->apptext.ctrl & APPTEXT_RDY)
-                OR
-                ((clientProcData.apptextLength == 9)
-                 AND
-                 (strcmp(signal_p->apptext.text, "\r\nOSmon> ") == 0))
-                OR
-                ((clientProcData.apptextLength == 8)
-                 AND
-                 (strcmp(signal_p->apptext.text, "\r\nOSmon>") == 0)))
-            {
-              /* The command has been completed (all output signals have
-                 been received). */
+          clientProcData.ptrInApptext = skip;
+          clientProcData.buflen = 0;
+          clientProcData.apptextLength = CalcApptextLength(signal_p -> apptext.text);
+          cmdData.pageEnd = PageEnd(&cmdData, signal_p, skip);
 
-              /* Unset flag indicating ongoing command */
-              isCmdRunning = FALSE;
+          /* Allocate memory for the out buffer used when sending data to the client */
+          clientProcData.outBuffer_p = (char*) OS_alloc(sizeof(char) * BUFFER_SIZE, 0);
+          clientProcData.startOfOutBuffer_p = clientProcData.outBuffer_p;
+          
+          /* Print the message to the client. The signal is kept until
+             it has been written, the rest is written at TIP_FD_WRITE
+             or when the user continues at the pager prompt. */
+          savedSig_p = signal_p;
+          signal_p = NULL; /* to prevent it from being freed at the end */
+          if (ContinueOutput(&cmdData, &clientProcData, &savedSig_p) != 0)
+          {
+            /* INETR has reported an error we cannot handle. Close connection. */
+            APT_RP_ERROR(ERROR_ID_R12_1893, (W32) tip_errno);
+            CloseConnection(&clientProcData);
+          }
+        }
+        break;
+      }
 
-              /* Check the if there are any buffered (awaiting) commands
-                 and if so execute the next command. */
-              if (noOfBufCmds > 0)
-              {
-                /* Check if previous command was not the last one */
-                if (cmdIdx < noOfBufCmds)
-                {
-                  /* For safety check if stored command is not NULL */
-                  if (bufCmds[cmdIdx] != NULL)
-                  {
-                    commandSize = strlen((char*)(bufCmds[cmdIdx]->appcmd.cmd));
-
-                    /* Print the command on the telnet console */
-                    if (TelnetWriteSimple(clientProcData.socketId,
-                                          (char*)(bufCmds[cmdIdx]->appcmd.cmd),
-                                          commandSize) != 0)
-                    {
-                      APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_5, (W32)tip_errno,
-                                          __LINE__, __FILE__,
-                                          0);
-                    }
-
-                    /* Send command to OSmonitor */
-                    OS_send(&(bufCmds[cmdIdx]), conh_);
-
-                    /* Set flag indicating ongoing command */
-                    isCmdRunning = TRUE;
-
-                    /* Set command index to point to the next command */
-                    cmdIdx++;
-                  }
-                  else
-                  {
-                    /* Stored command is NULL, this should never happen and
-                       indicates internal fault in RTIPGPHR. Report RPTERROR
-                       and free all remaining stored commands (if any)
-                       to avoid memory leaks. */
-                    APT_RP_ERROR2(ERROR_ID_G12B_RTIPGPHR_7, 0,
-                                  __LINE__, __FILE__,
-                                  2,           /* Num of extra parameters 0-65535 */
-                                  cmdIdx,
-                                  noOfBufCmds);
-
-                    for (cmdIdx = 0; cmdIdx < MAX_BUF_CMDS; cmdIdx++)
-                    {
-                      if (bufCmds[cmdIdx] != NULL)
-                      {
-                        OS_free(&(bufCmds[cmdIdx]));
-                      }
-                    }
-
-                    noOfBufCmds = 0;
-                    cmdIdx = 0;
-                  }
-                }
-                else
-                {
-                  /* No more commands to execute, clear the variables used
-                     for handling of buffered commands */
-                  noOfBufCmds = 0;
-                  cmdIdx = 0;
-                }
-              }
-            }
+      /* Reply to console handler request. */
+      case APPCTRL:
+      {
+        if ((signal_p->appctrl.data == APPCTRL_READY) AND
+            (cmdData.conhPending))
+        {
+          /* The console handler is ready, execute commands typed
+             ahead while waiting for it. */
+          cmdData.conh_ = OS_sender(&signal_p);
+          cmdData.conhPending = FALSE;
+          if (cmdData.conhTmoPending)
+          {
+            APT_RP_CANCEL_TMO(&cmdData.conhTmo);
+            cmdData.conhTmoPending = FALSE;
           }
+
+          RunNextBufCmd(&cmdData, clientProcData.socketId, FALSE);
+        }
+        else if ((signal_p->appctrl.data == APPCTRL_READY) AND
+                 itelnet_JobReady(&cmdData.jobs, OS_sender(&signal_p)))
+        {
+          /* Console handler of a background job, the command of the
+             job has been sent */
+        }
+        else if ((signal_p->appctrl.data == APPCTRL_READY) AND
+                 (cmdData.conh_ == 0))
+        {
+          /* The console handler arrived after the request timed out,
+             it is used for the next command */
+          cmdData.conh_ = OS_sender(&signal_p);
+        }
+        else if ((signal_p->appctrl.data == APPCTRL_READY) AND
+                 (OS_sender(&signal_p) != cmdData.conh_))
+        {
+          /* A late console handler while another one is in use, it is
+             not needed and is aborted */
+          reply_p = OS_alloc(APPCTRL_S, APPCTRL);
+          reply_p->appctrl.data = APPCTRL_ABORT;
+          OS_send(&reply_p, OS_sender(&signal_p));
+        }
+        else if ((signal_p->appctrl.data == APPCTRL_ABORT) AND
+                 (cmdData.conhPending))
+        {
+          /* OSmonitor could not provide a console handler */
+          APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_11,
+                              signal_p->appctrl.data,
+                              __LINE__, __FILE__,
+                              0);
+          ConsoleHandlerFailed(&cmdData, clientProcData.socketId);
+        }
+        else
+        {
+          APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_18,
+                              signal_p->appctrl.data,
+                              __LINE__, __FILE__,
+                              0);
         }
         break;
       }
       
-      /* User inactive for too long time. */
-      case TMO_SIG: 
+      /* User inactive for too long time (reported by the server). */
+      case MICLIENTIDLE: 
       {
         /* Unexpected close */
         APT_RP_ERROR(ERROR_ID_R12_1894, 0);
@@ -1848,6 +4618,144 @@ APT_RP_PROCESS(IP_TELNET_CH)
         break;
       }
       
+      case MIAUTHREPLY:
+        if (clientState != CLIENT_STATE_AUTH)
+        {
+          break;
+        }
+        
+        if (signal_p->miauthreply.result == MI_AUTH_OK)
+        {
+          /* Login accepted. */
+                    
+          /* Replace the login timeout with the inactivity
+             timeout (0 stops the supervision). */
+          timeOut = autoLogout;
+          itelnet_TmoRequest(clientProcData.serverPid,
+                             clientProcData.clientInd, timeOut);
+                    
+          clientState = CLIENT_STATE_LOGGEDIN;
+                    
+          /* Request the console process. */
+          ReqConsoleHandler(&cmdData);
+                    
+          /* Let the client edit the command lines if it can. */
+          itelnet_OptLineMode(&opt);
+
+          /* Let the terminal mark pasted text (bracketed paste). */
+          (void) TelnetWriteSimple(cmdData.echo_p, PASTE_ENABLE,
+                                   strlen(PASTE_ENABLE));
+                    
+          /* Write welcome to screen. */
+          if (WrStrSocket(clientProcData.socketId,
+                          "\n\nWelcome to the RAZOR Telnet shell, type 'help' for a\n\r"
+                          "list of available commands, 'exit' to end the session.",
+                          &clientProcData) != 0)
+          {
+/*          printf("TelnetWrite failed at pwd, with error code = %d\n", tip_errno);*/
+          }
+        }
+        else if (signal_p->miauthreply.result == MI_AUTH_THROTTLED)
+        {
+          /* Too many failed logins from this address. */
+          WrStrSocket(clientProcData.socketId,
+                      "\nToo many failed logins, try again later\n",
+                      &clientProcData); /*lint !e534*/
+          
+          OS_free(&signal_p);
+          CloseConnection(&clientProcData); /* no return... */
+        }
+        else
+        {
+          /* Login denied. */
+                    
+          WrStrSocket(clientProcData.socketId, "\nLogin incorrect\n",
+                      &clientProcData); /*lint !e534*/ /* Safe??? */
+                    
+          loginTries++;
+          if(loginTries < MAX_LOGIN_TRIES)
+          {
+            clientState = CLIENT_STATE_LOGIN;
+                      
+            WrStrSocket(clientProcData.socketId, "\nlogin: ",
+                        &clientProcData);         /*lint !e534*/ /* Safe??? */
+          }
+          else
+          {
+            OS_free(&signal_p);
+            CloseConnection(&clientProcData); /* no return... */
+          }
+        }
+        break;
+        
+      case MICLIENTCFG:
+        /* The configuration has been reloaded, a new login setting
+           applies to new sessions only */
+        if ((clientState == CLIENT_STATE_LOGGEDIN) &&
+            (signal_p->miclientcfg.autoLogout != autoLogout))
+        {
+          itelnet_TmoRequest(clientProcData.serverPid,
+                             clientProcData.clientInd,
+                             signal_p->miclientcfg.autoLogout);
+        }
+        autoLogout = signal_p->miclientcfg.autoLogout;
+
+        /* A changed pager setting replaces the one set by the user */
+        if (signal_p->miclientcfg.pagerLines != pagerLines)
+        {
+          pagerLines = signal_p->miclientcfg.pagerLines;
+          cmdData.pager = pagerLines;
+        }
+
+        /* The read-only commands are taken from the new configuration */
+        OS_free(&cmdData.cfg_p);
+        cmdData.cfg_p = signal_p;
+        signal_p = NULL; /* to prevent it from being freed at the end */
+        break;
+        
+      case MICLIENTWATCH:
+        /* Time to run the watched command again */
+        cmdData.watchTickPending = FALSE;
+        if ((cmdData.watch_p != NULL) && !cmdData.isCmdRunning)
+        {
+          SendCommand(&cmdData, clientProcData.socketId,
+                      cmdData.watch_p->cmd,
+                      (int) strlen(cmdData.watch_p->cmd) + 1);
+        }
+        break;
+        
+      case MICLIENTCONHTMO:
+        /* No reply to the console handler request */
+        cmdData.conhTmoPending = FALSE;
+        if (cmdData.conhPending)
+        {
+          APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_19, 0,
+                              __LINE__, __FILE__,
+                              0);
+          ConsoleHandlerFailed(&cmdData, clientProcData.socketId);
+        }
+        break;
+        
+      case REALTIMEGETR:
+        /* Real time for the local command "time" */
+        TimeReply(&cmdData, clientProcData.socketId, signal_p);
+        break;
+
+      case MICLIENTTIMETMO:
+        /* No reply from REOS */
+        TimeReply(&cmdData, clientProcData.socketId, NULL);
+        break;
+        
+      case MIHANDOVERCLIENT:
+        /* The telnet server has been replaced, the session continues.
+         * The reply tells the old server that nothing more is sent
+         * to it */
+        clientProcData.serverPid = signal_p->mihandoverclient.serverPid;
+        reply_p = OS_alloc(MIHANDOVERCLIENTR_S, MIHANDOVERCLIENTR);
+        reply_p->mihandoverclientr.clientInd = clientProcData.clientInd;
+        OS_send(&reply_p, OS_sender(&signal_p));
+        break;
+        
       case MISTOPCLIENT:
         /* Telnet server process request to terminate client connection */
         if(signal_p != NULL)
@@ -1866,6 +4774,12 @@ APT_RP_PROCESS(IP_TELNET_CH)
         APT_RP_ERROR(ERROR_ID_R12_1895, signal_p->sig_no);
         break;
     }
+
+    /* Prompt after local commands, when the printout is done */
+    if (savedSig_p == NULL)
+    {
+      FlushPrompt(&cmdData);
+    }
     
     if(signal_p != NULL)
     {
@@ -0,0 +1,875 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_opt_c.c                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue, from TelnetServerOptions in          */
+/*                        i_telnet_main_c.c.                                */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Telnet protocol handling for the telnet client processes
+ */
+
+/**
+ * @file i_telnet_opt_c.c
+ *
+ * Telnet commands (RFC 854) in the data from the client are parsed
+ * by itelnet_OptFilter(). The commands are removed from the data and
+ * the option negotiations are answered. The parser keeps its state
+ * in TELNET_OPT_st, so commands split over several reads are
+ * handled.
+ *
+ * At start the server offers to echo and to suppress go ahead, i.e.
+ * the client sends every character and the server echoes it through
+ * the line editor (i_telnet_ledit_c.c).
+ *
+ * When the user has logged in, LINEMODE (RFC 1184) is requested with
+ * itelnet_OptLineMode(). If the client agrees it is set to MODE EDIT
+ * and TRAPSIG, the default special characters (SLC) are sent, and the
+ * server stops echoing. The client then edits the line locally and
+ * sends it when it is complete; an interrupt is sent as IAC IP, which
+ * is passed on as CTRL_C. Clients that refuse LINEMODE continue with
+ * the server side editing.
+ *
+ * The window size of the client is requested at start (NAWS, RFC
+ * 1073) and kept in winWidth and winHeight, it is used by the pager.
+ *
+ * When output is aborted (CTRL_C, IAC IP or IAC AO) the caller sends
+ * Synch with itelnet_OptSynch(), so the client also discards the
+ * output that is already on its way.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_opt_h.h"
+
+/* Module internal interfaces */
+#include "i_telnet_ledit_h.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+
+#include "tipsock.h"
+
+#include <string.h>
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  CONSTANTS  ------------------------------------*/
+
+/* TELNET PROTOCOL numbers. */
+#define IAC     255             /* interpret as command: */
+#define DONT    254             /* you are not to use option */
+#define DO      253             /* please, you use option */
+#define WONT    252             /* I won't use option */
+#define WILL    251             /* I will use option */
+#define SB      250             /* interpret as subnegotiation */
+#define AO      245             /* abort output */
+#define IP      244             /* interrupt process */
+#define BRK     243             /* break */
+#define DM      242             /* data mark, for Synch */
+#define SE      240             /* end sub negotiation */
+
+/* telnet options. */
+#define TELOPT_ECHO     1       /* echo */
+#define TELOPT_SGA      3       /* suppress go ahead */
+#define TELOPT_NAWS     31      /* negotiate about window size */
+#define TELOPT_LINEMODE 34      /* linemode */
+
+/* LINEMODE suboptions. */
+#define LM_MODE         1
+#define LM_FORWARDMASK  2
+#define LM_SLC          3
+
+/* LINEMODE MODE mask. */
+#define MODE_EDIT       0x01    /* client edits the line */
+#define MODE_TRAPSIG    0x02    /* client sends signals as commands */
+#define MODE_ACK        0x04
+
+/* LINEMODE SLC functions. */
+#define SLC_IP          3
+#define SLC_EOF         8
+#define SLC_EC          10
+#define SLC_EL          11
+#define SLC_EW          12
+
+/* LINEMODE SLC levels and flags. */
+#define SLC_NOSUPPORT   0
+#define SLC_VALUE       2
+#define SLC_DEFAULT     3
+#define SLC_LEVELBITS   0x03
+#define SLC_FLUSHOUT    0x20
+#define SLC_FLUSHIN     0x40
+#define SLC_ACK         0x80
+
+/* Command parser states. */
+#define OPT_STATE_DATA   0      /* data */
+#define OPT_STATE_IAC    1      /* IAC received */
+#define OPT_STATE_NEG    2      /* WILL/WONT/DO/DONT received */
+#define OPT_STATE_SB     3      /* in subnegotiation */
+#define OPT_STATE_SB_IAC 4      /* IAC received in subnegotiation */
+
+/*-------------------------  TYPE DEF  -------------------------------------*/
+
+/* Special character, SLC triplet */
+typedef struct OPT_SLC_st
+{
+  U8 func;
+  U8 flags;
+  U8 value;
+} OPT_SLC_st;
+
+/****************************************************************************/
+/*                           LOCAL SUBROUTINES                              */
+/****************************************************************************/
+
+static W32 AddSlcDefault(U8 *buf_p, W32 len, U8 func);
+static void LineModeSb(TELNET_OPT_st *opt_p);
+static void Negotiate(TELNET_OPT_st *opt_p, U8 cmd, U8 option);
+static void SetLocalEdit(TELNET_OPT_st *opt_p, W32 edit);
+static void Slc(TELNET_OPT_st *opt_p);
+static int Write(const TELNET_OPT_st *opt_p, const U8 *buf_p, W32 len);
+static int WriteCmd(const TELNET_OPT_st *opt_p, U8 cmd, U8 option);
+static void WriteSb(const TELNET_OPT_st *opt_p, const U8 *buf_p, W32 len);
+
+/****************************************************************************/
+/*                           DATA                                           */
+/****************************************************************************/
+
+/*-------------------------  STATIC DATA  ----------------------------------*/
+
+/* Special characters of the server, sent when LINEMODE is enabled */
+static const OPT_SLC_st slcDefault[] =
+{
+  {SLC_IP,  SLC_VALUE | SLC_FLUSHIN | SLC_FLUSHOUT, CTRL_C},
+  {SLC_EOF, SLC_VALUE, 0x04},   /* ^D */
+  {SLC_EC,  SLC_VALUE, 0x7f},   /* DEL */
+  {SLC_EL,  SLC_VALUE, 0x15},   /* ^U */
+  {SLC_EW,  SLC_VALUE, 0x17}    /* ^W */
+};
+
+#define NO_OF_SLC_DEFAULT (sizeof(slcDefault) / sizeof(slcDefault[0]))
+
+
+
+/**************************************************************************
+ * Internal function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Writes data to the socket of the session.
+*
+* @param   opt_p     Telnet protocol state.
+* @param   buf_p     Data.
+* @param   len       Length of data.
+*
+* @return  0 if tip_write is successful, tip_errno otherwise.
+*
+***************************************************************************
+*/
+static int Write(const TELNET_OPT_st *opt_p, const U8 *buf_p, W32 len)
+{
+  if (tip_write(opt_p->fd, buf_p, (int) len) < 0)
+  {
+    APT_RP_DOTRACE_LEV1(ERROR_ID_R12_1930, (W32) tip_errno,
+                        __LINE__, __FILE__,
+                        0);
+    return tip_errno;
+  }
+
+  return 0;
+} /* Write */
+
+
+
+/**
+***************************************************************************
+* @brief Writes a Telnet command (WILL/WONT/DO/DONT) to the socket.
+*
+* @param   opt_p     Telnet protocol state.
+* @param   cmd       Command to write.
+* @param   option    Option.
+*
+* @return  0 if tip_write is successful, tip_errno otherwise.
+*
+***************************************************************************
+*/
+static int WriteCmd(const TELNET_OPT_st *opt_p, U8 cmd, U8 option)
+{
+  U8 buf[3];
+
+  buf[0] = (U8) IAC;
+  buf[1] = cmd;
+  buf[2] = option;
+
+  return Write(opt_p, buf, 3);
+} /* WriteCmd */
+
+
+
+/**
+***************************************************************************
+* @brief Writes a subnegotiation (IAC SB ... IAC SE) to the socket.
+*        IAC in the data is doubled.
+*
+* @param   opt_p     Telnet protocol state.
+* @param   buf_p     Subnegotiation, option first.
+* @param   len       Length of the subnegotiation.
+*
+***************************************************************************
+*/
+static void WriteSb(const TELNET_OPT_st *opt_p, const U8 *buf_p, W32 len)
+{
+  U8  out[2 * OPT_SB_MAX + 4];
+  W32 n = 0;
+  W32 i;
+
+  out[n++] = (U8) IAC;
+  out[n++] = (U8) SB;
+
+  for (i = 0; (i < len) && (i < OPT_SB_MAX); i++)
+  {
+    if (buf_p[i] == (U8) IAC)
+    {
+      out[n++] = (U8) IAC;
+    }
+    out[n++] = buf_p[i];
+  }
+
+  out[n++] = (U8) IAC;
+  out[n++] = (U8) SE;
+
+  (void) Write(opt_p, out, n);
+} /* WriteSb */
+
+
+
+/**
+***************************************************************************
+* @brief Adds the SLC triplet of the server for a function to a
+*        subnegotiation.
+*
+* @param   buf_p     Subnegotiation.
+* @param   len       Current length.
+* @param   func      SLC function, 0 adds all functions.
+*
+* @return  New length.
+*
+***************************************************************************
+*/
+static W32 AddSlcDefault(U8 *buf_p, W32 len, U8 func)
+{
+  W32 i;
+  W32 found = FALSE;
+
+  for (i = 0; i < NO_OF_SLC_DEFAULT; i++)
+  {
+    if (((func == 0) || (slcDefault[i].func == func)) &&
+        (len + 3 <= OPT_SB_MAX))
+    {
+      buf_p[len++] = slcDefault[i].func;
+      buf_p[len++] = slcDefault[i].flags;
+      buf_p[len++] = slcDefault[i].value;
+      found = TRUE;
+    }
+  }
+
+  /* Function not supported by the server */
+  if ((found == FALSE) && (func != 0) && (len + 3 <= OPT_SB_MAX))
+  {
+    buf_p[len++] = func;
+    buf_p[len++] = SLC_NOSUPPORT;
+    buf_p[len++] = 0;
+  }
+
+  return len;
+} /* AddSlcDefault */
+
+
+
+/**
+***************************************************************************
+* @brief Switches between editing by the client (LINEMODE MODE EDIT)
+*        and by the server. The server echoes only when it edits.
+*
+* @param   opt_p     Telnet protocol state.
+* @param   edit      TRUE if the client edits.
+*
+***************************************************************************
+*/
+static void SetLocalEdit(TELNET_OPT_st *opt_p, W32 edit)
+{
+  if (edit && !opt_p->localEdit)
+  {
+    opt_p->localEdit = TRUE;
+    if (opt_p->hostEcho)
+    {
+      opt_p->hostEcho = 0;
+      (void) WriteCmd(opt_p, (U8) WONT, TELOPT_ECHO);
+    }
+  }
+  else if (!edit && opt_p->localEdit)
+  {
+    opt_p->localEdit = FALSE;
+    if (!opt_p->hostEcho)
+    {
+      opt_p->hostEcho = 1;
+      (void) WriteCmd(opt_p, (U8) WILL, TELOPT_ECHO);
+    }
+  }
+} /* SetLocalEdit */
+
+
+
+/**
+***************************************************************************
+* @brief Answers the special characters (SLC) of the client. Values
+*        set by the client are accepted, the server values are sent
+*        for functions the client leaves to the default.
+*
+* @param   opt_p     Telnet protocol state, sbBuf holds LINEMODE SLC.
+*
+***************************************************************************
+*/
+static void Slc(TELNET_OPT_st *opt_p)
+{
+  U8  reply[OPT_SB_MAX];
+  W32 len = 0;
+  W32 i;
+  U8  func;
+  U8  flags;
+
+  reply[len++] = TELOPT_LINEMODE;
+  reply[len++] = LM_SLC;
+
+  for (i = 2; i + 2 < opt_p->sbLen; i += 3)
+  {
+    func = opt_p->sbBuf[i];
+    flags = opt_p->sbBuf[i + 1];
+
+    if (flags & SLC_ACK)
+    {
+      /* Acknowledgement of a value sent by the server */
+      continue;
+    }
+
+    if ((flags & SLC_LEVELBITS) == SLC_DEFAULT)
+    {
+      /* Use the server value, function 0 requests all of them */
+      len = AddSlcDefault(reply, len, func);
+    }
+    else if (len + 3 <= OPT_SB_MAX)
+    {
+      /* Accept the value of the client */
+      reply[len++] = func;
+      reply[len++] = (U8) (flags | SLC_ACK);
+      reply[len++] = opt_p->sbBuf[i + 2];
+    }
+  }
+
+  if (len > 2)
+  {
+    WriteSb(opt_p, reply, len);
+  }
+} /* Slc */
+
+
+
+/**
+***************************************************************************
+* @brief Handles a LINEMODE subnegotiation from the client.
+*
+* @param   opt_p     Telnet protocol state, sbBuf holds the
+*                    subnegotiation.
+*
+***************************************************************************
+*/
+static void LineModeSb(TELNET_OPT_st *opt_p)
+{
+  U8 reply[3];
+  U8 mask;
+
+  switch (opt_p->sbBuf[1])
+  {
+    case LM_MODE:
+      if (opt_p->sbLen < 3)
+      {
+        break;
+      }
+
+      mask = (U8) (opt_p->sbBuf[2] & (MODE_EDIT | MODE_TRAPSIG | MODE_ACK));
+      if ((mask & MODE_ACK) == 0)
+      {
+        /* The client proposes another mode, accept it */
+        reply[0] = TELOPT_LINEMODE;
+        reply[1] = LM_MODE;
+        reply[2] = (U8) (mask | MODE_ACK);
+        WriteSb(opt_p, reply, 3);
+      }
+      SetLocalEdit(opt_p, (W32) (mask & MODE_EDIT));
+      break;
+
+    case LM_SLC:
+      Slc(opt_p);
+      break;
+
+    case DO:
+      /* The server does not use a forward mask */
+      if ((opt_p->sbLen >= 3) && (opt_p->sbBuf[2] == LM_FORWARDMASK))
+      {
+        reply[0] = TELOPT_LINEMODE;
+        reply[1] = (U8) WONT;
+        reply[2] = LM_FORWARDMASK;
+        WriteSb(opt_p, reply, 3);
+      }
+      break;
+
+    case WILL:
+      /* Lines are forwarded at end of line, no forward mask */
+      if ((opt_p->sbLen >= 3) && (opt_p->sbBuf[2] == LM_FORWARDMASK))
+      {
+        reply[0] = TELOPT_LINEMODE;
+        reply[1] = (U8) DONT;
+        reply[2] = LM_FORWARDMASK;
+        WriteSb(opt_p, reply, 3);
+      }
+      break;
+
+    default:
+      break;
+  }
+} /* LineModeSb */
+
+
+
+/**
+***************************************************************************
+* @brief This function negotiates one telnet option with the client.
+*
+* @param   opt_p     Telnet protocol state.
+* @param   cmd       WILL/WONT/DO/DONT from the client.
+* @param   option    Option.
+*
+***************************************************************************
+*/
+static void Negotiate(TELNET_OPT_st *opt_p, U8 cmd, U8 option)
+{
+  U8 sb[OPT_SB_MAX];
+  W32 len;
+
+  /*********** ECHO ***********/
+  if (option == TELOPT_ECHO)
+  {
+    switch (cmd)
+    {
+      case DO:
+        if (opt_p->localEdit)
+        {
+          /* The client echoes when it edits the lines */
+          (void) WriteCmd(opt_p, (U8) WONT, TELOPT_ECHO);
+        }
+        else if (opt_p->hostEcho == 0)
+        {
+          opt_p->hostEcho = 1;
+          (void) WriteCmd(opt_p, (U8) WILL, TELOPT_ECHO);
+        }
+        break;
+
+      case DONT:
+        if (opt_p->hostEcho == 1)
+        {
+          opt_p->hostEcho = 0;
+          (void) WriteCmd(opt_p, (U8) WONT, TELOPT_ECHO);
+        }
+        break;
+
+      case WILL:
+        if (opt_p->peerEcho == 0)
+        {
+          opt_p->peerEcho = 1;
+          (void) WriteCmd(opt_p, (U8) DO, TELOPT_ECHO);
+        }
+        break;
+
+      case WONT:
+        if (opt_p->peerEcho == 1)
+        {
+          opt_p->peerEcho = 0;
+          (void) WriteCmd(opt_p, (U8) DONT, TELOPT_ECHO);
+        }
+        break;
+
+      default:
+        break;
+    }
+    return;
+  }
+
+  /*********** NAWS ***********/
+  if (option == TELOPT_NAWS)
+  {
+    if (cmd == WILL)
+    {
+      /* Reply to DO NAWS, the size follows in a subnegotiation */
+      opt_p->peerNaws = 1;
+      return;
+    }
+
+    if (cmd == WONT)
+    {
+      if (opt_p->peerNaws == 1)
+      {
+        opt_p->peerNaws = 0;
+        (void) WriteCmd(opt_p, (U8) DONT, TELOPT_NAWS);
+      }
+      opt_p->winWidth = 0;
+      opt_p->winHeight = 0;
+      return;
+    }
+  }
+
+  /*********** LINEMODE ***********/
+  if ((option == TELOPT_LINEMODE) && opt_p->lineModeAllowed)
+  {
+    if (cmd == WILL)
+    {
+      if (!opt_p->lineMode)
+      {
+        /* Reply to DO LINEMODE, let the client edit the lines and
+           send the special characters of the server */
+        opt_p->lineMode = TRUE;
+
+        sb[0] = TELOPT_LINEMODE;
+        sb[1] = LM_MODE;
+        sb[2] = MODE_EDIT | MODE_TRAPSIG;
+        WriteSb(opt_p, sb, 3);
+
+        sb[1] = LM_SLC;
+        len = AddSlcDefault(sb, 2, 0);
+        WriteSb(opt_p, sb, len);
+      }
+      return;
+    }
+
+    if (cmd == WONT)
+    {
+      /* Refused or disabled, the server edits the lines */
+      if (opt_p->lineMode)
+      {
+        opt_p->lineMode = FALSE;
+        SetLocalEdit(opt_p, FALSE);
+        (void) WriteCmd(opt_p, (U8) DONT, TELOPT_LINEMODE);
+      }
+      return;
+    }
+  }
+
+  /*********** Other options ***********/
+  switch (cmd)
+  {
+    /* Sender wants receiver to enable option. Receiver says NO. */
+    case DO:
+      if (option == TELOPT_SGA)
+      {
+        if (opt_p->hostSga == 0)
+        {
+          opt_p->hostSga = 1;
+          (void) WriteCmd(opt_p, (U8) WILL, option);
+        }
+      }
+      else
+      {
+        (void) WriteCmd(opt_p, (U8) WONT, option);
+      }
+      break;
+
+    /* Sender wants to enable option. Receiver says NO. */
+    case WILL:
+      (void) WriteCmd(opt_p, (U8) DONT, option);
+      break;
+
+    /* Sender wants to disable option. Receiver must say OK. */
+    case WONT:
+      (void) WriteCmd(opt_p, (U8) DONT, option);
+      break;
+
+    /* Sender wants receiver to disable option. Receiver must say OK. */
+    case DONT:
+      if (option == TELOPT_SGA)
+      {
+        opt_p->hostSga = 0;
+      }
+      (void) WriteCmd(opt_p, (U8) WONT, option);
+      break;
+
+    default:
+      break;
+  }
+} /* Negotiate */
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Initialises the telnet protocol state of a session and sends
+*        the initial options (WILL SGA, WILL ECHO, DO NAWS) to the
+*        client.
+*
+* @param   opt_p     Telnet protocol state.
+* @param   fd        Socket of the session.
+*
+* @return  0 if successful, tip_errno otherwise.
+*
+***************************************************************************
+*/
+int itelnet_OptStart(TELNET_OPT_st *opt_p, int fd)
+{
+  int rc;
+
+  memset(opt_p, 0, sizeof(TELNET_OPT_st));
+  opt_p->fd = fd;
+  opt_p->state = OPT_STATE_DATA;
+
+  /* Make server echo by default. */
+  opt_p->hostEcho = 1;
+  opt_p->hostSga = 1;
+
+  rc = WriteCmd(opt_p, (U8) WILL, TELOPT_SGA);
+  if (rc == 0)
+  {
+    rc = WriteCmd(opt_p, (U8) WILL, TELOPT_ECHO);
+  }
+  if (rc == 0)
+  {
+    rc = WriteCmd(opt_p, (U8) DO, TELOPT_NAWS);
+  }
+
+  return rc;
+} /* itelnet_OptStart */
+
+
+
+/**
+***************************************************************************
+* @brief Requests LINEMODE from the client. Called when the user has
+*        logged in, the login is always edited by the server.
+*
+* @param   opt_p     Telnet protocol state.
+*
+***************************************************************************
+*/
+void itelnet_OptLineMode(TELNET_OPT_st *opt_p)
+{
+  if (!opt_p->lineModeAllowed)
+  {
+    opt_p->lineModeAllowed = TRUE;
+    (void) WriteCmd(opt_p, (U8) DO, TELOPT_LINEMODE);
+  }
+} /* itelnet_OptLineMode */
+
+
+
+/**
+***************************************************************************
+* @brief Removes the telnet commands from data received from the
+*        client and handles them. The remaining data is moved to the
+*        start of the buffer.
+*
+*        IAC IP and IAC BRK are replaced with CTRL_C. IAC AO sets
+*        abortOutput, which is cleared by the caller.
+*
+* @param   opt_p     Telnet protocol state.
+* @param   data_p    Received data.
+* @param   length    Length of received data.
+*
+* @return  Length of the remaining data.
+*
+***************************************************************************
+*/
+W32 itelnet_OptFilter(TELNET_OPT_st *opt_p, char *data_p, W32 length)
+{
+  W32 i;
+  W32 n = 0;
+  U8  c;
+
+  for (i = 0; i < length; i++)
+  {
+    c = (U8) data_p[i];
+
+    switch (opt_p->state)
+    {
+      case OPT_STATE_DATA:
+        if (c == IAC)
+        {
+          opt_p->state = OPT_STATE_IAC;
+        }
+        else
+        {
+          data_p[n++] = (char) c;
+        }
+        break;
+
+      case OPT_STATE_IAC:
+        opt_p->state = OPT_STATE_DATA;
+
+        switch (c)
+        {
+          case IAC:
+            /* Escaped data byte 255 */
+            data_p[n++] = (char) c;
+            break;
+
+          case WILL:
+          case WONT:
+          case DO:
+          case DONT:
+            opt_p->cmd = c;
+            opt_p->state = OPT_STATE_NEG;
+            break;
+
+          case SB:
+            opt_p->sbLen = 0;
+            opt_p->state = OPT_STATE_SB;
+            break;
+
+          case IP:
+          case BRK:
+            /* Interrupt, sent as a command by LINEMODE TRAPSIG */
+            data_p[n++] = (char) CTRL_C;
+            break;
+
+          case AO:
+            /* Abort output, handled by the caller */
+            opt_p->abortOutput = TRUE;
+            break;
+
+          default:
+            /* NOP, GA, DM, AYT, EC, EL etc. are ignored */
+            break;
+        }
+        break;
+
+      case OPT_STATE_NEG:
+        opt_p->state = OPT_STATE_DATA;
+        Negotiate(opt_p, opt_p->cmd, c);
+        break;
+
+      case OPT_STATE_SB:
+        if (c == IAC)
+        {
+          opt_p->state = OPT_STATE_SB_IAC;
+        }
+        else if (opt_p->sbLen < OPT_SB_MAX)
+        {
+          opt_p->sbBuf[opt_p->sbLen++] = c;
+        }
+        break;
+
+      case OPT_STATE_SB_IAC:
+        if (c == SE)
+        {
+          opt_p->state = OPT_STATE_DATA;
+
+          if ((opt_p->sbLen >= 2) &&
+              (opt_p->sbBuf[0] == TELOPT_LINEMODE) && opt_p->lineMode)
+          {
+            LineModeSb(opt_p);
+          }
+          else if ((opt_p->sbLen >= 5) && (opt_p->sbBuf[0] == TELOPT_NAWS))
+          {
+            /* Window size, width and height in network order */
+            opt_p->winWidth = ((W32) opt_p->sbBuf[1] << 8) | opt_p->sbBuf[2];
+            opt_p->winHeight = ((W32) opt_p->sbBuf[3] << 8) | opt_p->sbBuf[4];
+          }
+        }
+        else
+        {
+          /* IAC IAC is a data byte 255 in the subnegotiation */
+          if ((c == IAC) && (opt_p->sbLen < OPT_SB_MAX))
+          {
+            opt_p->sbBuf[opt_p->sbLen++] = c;
+          }
+          opt_p->state = OPT_STATE_SB;
+        }
+        break;
+
+      default:
+        opt_p->state = OPT_STATE_DATA;
+        break;
+    }
+  }
+
+  return n;
+} /* itelnet_OptFilter */
+
+
+
+/**
+***************************************************************************
+* @brief Sends Synch (IAC DM, DM as urgent data) to the client. The
+*        client discards the output received before the data mark.
+*        Sent when the output of a command has been aborted.
+*
+* @param   opt_p     Telnet protocol state.
+*
+***************************************************************************
+*/
+void itelnet_OptSynch(const TELNET_OPT_st *opt_p)
+{
+  U8 buf[2];
+
+  buf[0] = (U8) IAC;
+  buf[1] = (U8) DM;
+
+  if (tip_send(opt_p->fd, buf, 2, TIP_MSG_OOB) < 0)
+  {
+    APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_20, (W32) tip_errno,
+                        __LINE__, __FILE__,
+                        0);
+  }
+} /* itelnet_OptSynch */
@@ -0,0 +1,83 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_opt_h.h                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the telnet protocol handling (commands and        */
+/*          option negotiation) of the IP_TELNET_CH_n processes.            */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_OPT_H_H
+#define I_TELNET_OPT_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/* Max length of a subnegotiation, longer ones are truncated */
+#define OPT_SB_MAX 80
+
+/****************************************************************************/
+/*                           TYPE DEFINITIONS                               */
+/****************************************************************************/
+
+/* Telnet protocol state of a session */
+typedef struct TELNET_OPT_st
+{
+  int     fd;                 /* Socket of the session */
+  W32     hostEcho;           /* Server echoes (WILL ECHO) */
+  W32     peerEcho;           /* Client echoes (DO ECHO) */
+  W32     hostSga;            /* Server suppresses go ahead */
+  W32     lineModeAllowed;    /* LINEMODE may be negotiated */
+  W32     lineMode;           /* LINEMODE enabled by the client */
+  W32     localEdit;          /* MODE EDIT acknowledged, the client edits
+                                 and echoes the lines */
+  W32     abortOutput;        /* IAC AO received */
+  W32     peerNaws;           /* Client sends its window size */
+  W32     winWidth;           /* Window size (NAWS), 0 = unknown */
+  W32     winHeight;
+  W32     state;              /* Command parser state */
+  U8      cmd;                /* WILL/WONT/DO/DONT being parsed */
+  W32     sbLen;              /* Length of the subnegotiation */
+  U8      sbBuf[OPT_SB_MAX];  /* Subnegotiation, option first */
+} TELNET_OPT_st;
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_CH_n processes */
+extern int itelnet_OptStart(TELNET_OPT_st *opt_p, int fd);
+extern void itelnet_OptLineMode(TELNET_OPT_st *opt_p);
+extern W32 itelnet_OptFilter(TELNET_OPT_st *opt_p, char *data_p, W32 length);
+extern void itelnet_OptSynch(const TELNET_OPT_st *opt_p);
+
+#endif /* I_TELNET_OPT_H_H */
@@ -0,0 +1,275 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_paste_c.c                                      */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Bracketed paste for the telnet client processes
+ */
+
+/**
+ * @file i_telnet_paste_c.c
+ *
+ * With bracketed paste turned on (PASTE_ENABLE) the terminal sends
+ * text pasted by the user between the markers ESC[200~ and ESC[201~.
+ * The client process passes the text to itelnet_PasteScan() instead
+ * of the line editor, one character at a time: the text is split into
+ * command lines in one pass over the received data, without the echo
+ * and history handling of each character.
+ *
+ * @li Lines end at CR or LF, empty lines are skipped.
+ * @li TAB is read as a space, other control characters and escape
+ *     sequences are dropped.
+ * @li Lines are cut at the length of the command line of the line
+ *     editor.
+ *
+ * The end marker may be split over several reads of the socket. The
+ * text after the last line end is returned at the end of the paste,
+ * it is left on the command line. The scan stops at CTRL_C, which
+ * aborts the running command as when it is typed.
+ *
+ * The client process uses the scan for all input in automation mode
+ * too.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_paste_h.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+
+#include <string.h>
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  CONSTANTS  ------------------------------------*/
+
+/* Final byte of a control sequence (ESC [ ...) */
+#define IS_CSI_FINAL(c)    (((c) >= 0x40) && ((c) <= 0x7e))
+
+/* Markers of the pasted text, the ESC is not included in PASTE_START */
+#define PASTE_START        "[200~"
+#define PASTE_START_LEN    5
+#define PASTE_END          "\033[201~"
+#define PASTE_END_LEN      6
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Initiates the bracketed paste of a session.
+*
+* @param   paste_p   Bracketed paste.
+*
+***************************************************************************
+*/
+void itelnet_PasteInit(TELNET_PASTE_st *paste_p)
+{
+  paste_p->active = FALSE;
+  paste_p->endMatch = 0;
+  paste_p->csi = FALSE;
+  paste_p->len = 0;
+  paste_p->lineDone = FALSE;
+} /* itelnet_PasteInit */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if an ESC read from the client starts pasted text.
+*
+* @param   paste_p   Bracketed paste.
+* @param   data_p    Data read from the client.
+* @param   i_p       Read index, after the ESC. Moved past the start
+*                    marker if found.
+* @param   length    Length of the data.
+*
+* @return  TRUE if the paste has started, FALSE if not.
+*
+***************************************************************************
+*/
+W32 itelnet_PasteBegin(TELNET_PASTE_st *paste_p, const char *data_p,
+                       W32 *i_p, W32 length)
+{
+  if ((*i_p + PASTE_START_LEN > length) ||
+      (memcmp(&data_p[*i_p], PASTE_START, PASTE_START_LEN) != 0))
+  {
+    return FALSE;
+  }
+
+  *i_p += PASTE_START_LEN;
+  paste_p->active = TRUE;
+  paste_p->endMatch = 0;
+  paste_p->csi = FALSE;
+  paste_p->len = 0;
+  paste_p->lineDone = FALSE;
+  return TRUE;
+} /* itelnet_PasteBegin */
+
+
+
+/**
+***************************************************************************
+* @brief Splits pasted text into command lines. Reads the data until a
+*        line is complete, the paste ends, a CTRL_C, or the data is
+*        used up.
+*
+* @param   paste_p   Bracketed paste.
+* @param   data_p    Data read from the client.
+* @param   i_p       Read index, moved past the data used.
+* @param   length    Length of the data.
+*
+* @return  PASTE_LINE when a line is complete, PASTE_DONE at the end of
+*          the paste, else PASTE_MORE. The line is terminated in
+*          paste_p->line and valid until the next call.
+*
+***************************************************************************
+*/
+W32 itelnet_PasteScan(TELNET_PASTE_st *paste_p, const char *data_p,
+                      W32 *i_p, W32 length)
+{
+  W32 i = *i_p;
+  char ch;
+
+  /* The line returned at the last call */
+  if (paste_p->lineDone)
+  {
+    paste_p->lineDone = FALSE;
+    paste_p->len = 0;
+  }
+
+  while (i < length)
+  {
+    ch = data_p[i];
+
+    /* CTRL_C (IAC IP) is left to the caller */
+    if (ch == CTRL_C)
+    {
+      break;
+    }
+    i++;
+
+    /* Rest of another control sequence, also when split over several
+       reads. A control character ends it and is used. */
+    if (paste_p->csi && (ch != ESC) && ((unsigned char) ch >= ' '))
+    {
+      if (IS_CSI_FINAL(ch))
+      {
+        paste_p->csi = FALSE;
+      }
+      continue;
+    }
+    paste_p->csi = FALSE;
+
+    /* End marker, also when split over several reads */
+    if ((paste_p->endMatch > 0) || (ch == ESC))
+    {
+      if (ch == PASTE_END[paste_p->endMatch])
+      {
+        paste_p->endMatch++;
+        if (paste_p->endMatch == PASTE_END_LEN)
+        {
+          paste_p->active = FALSE;
+          paste_p->endMatch = 0;
+          paste_p->line[paste_p->len] = '\0';
+          paste_p->len = 0;
+          *i_p = i;
+          return PASTE_DONE;
+        }
+        continue;
+      }
+
+      /* Another escape sequence, dropped: ESC and one character, or
+         ESC [ up to the final byte */
+      if (ch == ESC)
+      {
+        paste_p->endMatch = 1;
+        continue;
+      }
+      if ((paste_p->endMatch >= 2) && !IS_CSI_FINAL(ch))
+      {
+        paste_p->csi = TRUE;
+      }
+      paste_p->endMatch = 0;
+      if ((unsigned char) ch >= ' ')
+      {
+        continue;
+      }
+      paste_p->csi = FALSE;
+    }
+
+    if ((ch == CR) || (ch == '\n'))
+    {
+      if (paste_p->len > 0)
+      {
+        paste_p->line[paste_p->len] = '\0';
+        paste_p->lineDone = TRUE;
+        *i_p = i;
+        return PASTE_LINE;
+      }
+      continue;
+    }
+
+    if (ch == '\t')
+    {
+      ch = ' ';
+    }
+
+    if (((unsigned char) ch >= ' ') && (ch != 0x7f) &&
+        (paste_p->len < MAX_LINE - 1))
+    {
+      paste_p->line[paste_p->len++] = ch;
+    }
+  }
+
+  /* The line continues in the next read */
+  *i_p = i;
+  return PASTE_MORE;
+} /* itelnet_PasteScan */
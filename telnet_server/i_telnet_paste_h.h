@@ -0,0 +1,85 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_paste_h.h                                      */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the bracketed paste (text pasted into the        */
+/*          terminal, split into command lines) of the IP_TELNET_CH_n       */
+/*          processes.                                                      */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_PASTE_H_H
+#define I_TELNET_PASTE_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+#include "i_telnet_ledit_h.h"
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/* Turns bracketed paste on/off in an xterm compatible terminal, other
+   terminals ignore the sequences */
+#define PASTE_ENABLE       "\033[?2004h"
+#define PASTE_DISABLE      "\033[?2004l"
+
+/* Result of itelnet_PasteScan */
+#define PASTE_MORE         0    /* All data used, the paste continues */
+#define PASTE_LINE         1    /* A command line is in line[] */
+#define PASTE_DONE         2    /* End of the paste, the rest of the
+                                   last line is in line[] */
+
+/****************************************************************************/
+/*                           TYPE DEFINITIONS                               */
+/****************************************************************************/
+
+/* Bracketed paste of a session */
+typedef struct TELNET_PASTE_st
+{
+  W32     active;               /* Between the start and end markers */
+  W32     endMatch;             /* Characters of the end marker read */
+  W32     csi;                  /* In another control sequence, dropped
+                                   up to its final byte */
+  W32     len;                  /* Length of the line being split */
+  W32     lineDone;             /* line[] returned, a new line starts */
+  char    line[MAX_LINE + 1];
+} TELNET_PASTE_st;
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_CH_n processes */
+extern void itelnet_PasteInit(TELNET_PASTE_st *paste_p);
+extern W32 itelnet_PasteBegin(TELNET_PASTE_st *paste_p, const char *data_p,
+                              W32 *i_p, W32 length);
+extern W32 itelnet_PasteScan(TELNET_PASTE_st *paste_p, const char *data_p,
+                             W32 *i_p, W32 length);
+
+#endif /* I_TELNET_PASTE_H_H */
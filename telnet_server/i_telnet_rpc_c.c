@@ -0,0 +1,1700 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_rpc_c.c                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Command RPC listener for the telnet server
+ */
+
+/**
+ * @file i_telnet_rpc_c.c
+ *
+ * The IP_TELNET_RPC process is started by IP_TELNET_SERVER. When the
+ * flash (pboot) parameter telnet_rpc_port is set it listens on that
+ * port for programs that run many OSmonitor commands. The frame
+ * protocol (see i_telnet_rpc_h.h) has no telnet negotiation, line
+ * editing or CR LF conversion: a request carries an id and a command,
+ * and the output of the command is returned as it arrives, one
+ * response per APPTEXT, the last one flagged RPC_FLAG_DONE.
+ *
+ * There is no login, so connections are only accepted from loopback
+ * and from telnet_privileged_net.
+ *
+ * Processes on the node can run commands without TIP, telnet or
+ * login: IP_TELNET_RPC is found with hunt() and is sent MIRPCREQ, the
+ * output is returned in MIRPCREPLY signals, the last one flagged
+ * MI_RPC_DONE. The process runs while the telnet server runs, also
+ * when telnet_rpc_port is not set.
+ *
+ * The requests of all connections and processes are run in order of
+ * arrival on a pool of at most RPC_CONH_MAX console handlers, which
+ * are kept when connections close. Requests of a connection may run
+ * at the same time, the responses are told apart by the request id.
+ * The replies to a process that has terminated are discarded by the
+ * OS.
+ *
+ * Result cache: the output of the commands set in the flash (pboot)
+ * parameters telnet_cache_1 .. telnet_cache_8 (read-only status
+ * commands) is kept for their time to live. The commands are compared
+ * normalised (see itelnet_CfgNormalise()).
+ * @li A request for a command with a fresh result gets the stored
+ *     responses, OSmonitor is not used.
+ * @li Otherwise the command is run once, on its own request, and all
+ *     requests for it meanwhile get the same responses. Output longer
+ *     than RPC_CACHE_MAX_BYTES is not stored, and requests coming
+ *     after that run the command themselves.
+ *
+ * Flow control:
+ * @li A connection with more than RPC_MAX_QUEUED requests waiting or
+ *     running is not read (no TIP_FD_READ) until half of them are done,
+ *     so TCP stops the client.
+ * @li When a response can not be written at once the rest is kept, and
+ *     the acknowledge of the APPTEXT (APPCTRL_ACK) is held until it has
+ *     been written, so the console handler waits for the client. For a
+ *     command run for the result cache it is held until the responses
+ *     have been written to all waiting connections.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_rpc_h.h"
+
+/* Module internal interfaces */
+#include "i_telnet_conh_h.h"
+#include "i_telnet_sig_def.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+#include "tipsock.h"
+
+#include <string.h>
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  CONSTANTS  ------------------------------------*/
+
+/* Connections of the RPC port */
+#define RPC_MAX_CONNS      8
+
+/* Console handlers running the requests */
+#define RPC_CONH_MAX       4
+
+/* Requests of a connection, waiting or running, before it is not read */
+#define RPC_MAX_QUEUED     64
+
+/* Request of a process, or of a closed connection (the output is
+   discarded) */
+#define RPC_NO_CONN        0xFFFFFFFFUL
+
+/* State of a console handler of the pool */
+#define RPC_CONH_NONE      0
+#define RPC_CONH_PENDING   1        /* APPCTRL_INIT sent */
+#define RPC_CONH_IDLE      2
+#define RPC_CONH_BUSY      3
+
+/* Request that does not fill a result cache entry */
+#define RPC_NO_CACHE       0xFFFFFFFFUL
+
+/* Output stored in a result cache entry */
+#define RPC_CACHE_MAX_BYTES 16384
+
+/* State of a result cache entry */
+#define RPC_CACHE_EMPTY    0
+#define RPC_CACHE_FILLING  1        /* The command runs */
+#define RPC_CACHE_FRESH    2        /* Result stored, may have expired */
+
+/* Seconds to system ticks, system_tick() is in microseconds */
+#define SEC_TO_TICKS(s) ((OSTICK) (((s) * 1000000UL) / system_tick()))
+
+/* Loopback network 127.0.0.0/8 */
+#define LOOPBACK_NET       0x7F000000UL
+#define LOOPBACK_MASK      0xFF000000UL
+
+#define RPC_NOT_AVAILABLE  "OSmonitor not available"
+#define RPC_TOO_LONG       "Command too long"
+
+/*-------------------------  TYPE DEF  -------------------------------------*/
+
+/* Request, waiting or running */
+typedef struct RPC_REQ_st
+{
+  struct RPC_REQ_st *next_p;
+  W32     conn;                 /* Connection, RPC_NO_CONN if closed */
+  PROCESS pid;                  /* Process (MIRPCREQ), 0 if connection */
+  W32     id;                   /* Request id of the client */
+  W32     cache;                /* Result cache entry run for, else
+                                   RPC_NO_CACHE */
+  char    cmd[1];               /* Allocated to its length */
+} RPC_REQ_st;
+
+/* Response stored in the result cache */
+typedef struct RPC_TEXT_st
+{
+  struct RPC_TEXT_st *next_p;
+  W32     len;
+  char    text[1];              /* Allocated to its length */
+} RPC_TEXT_st;
+
+/* Result cache entry, one per command of the configuration */
+typedef struct RPC_CACHE_st
+{
+  char    cmd[CFG_CACHE_CMD_LEN];  /* Normalised command */
+  W32     ttl;                  /* Time to live, s */
+  W32     state;
+  OSTICK  stored;               /* When the result was stored */
+  Boolean overflow;             /* Output above RPC_CACHE_MAX_BYTES,
+                                   not stored */
+  W32     bytes;                /* Output stored */
+  RPC_TEXT_st *textFirst_p;     /* Responses, the last one completes */
+  RPC_TEXT_st *textLast_p;
+  RPC_REQ_st  *waitFirst_p;     /* Requests getting the responses of the
+                                   running command */
+} RPC_CACHE_st;
+
+/* Response not yet written */
+typedef struct RPC_TX_st
+{
+  struct RPC_TX_st *next_p;
+  W32     len;
+  W32     pos;                  /* Bytes written */
+  U8      data[1];              /* Allocated to its length */
+} RPC_TX_st;
+
+/* Connection of the RPC port */
+typedef struct RPC_CONN_st
+{
+  Boolean used;
+  int     sockId;
+  W32     queued;               /* Requests waiting or running */
+  Boolean inputStopped;         /* TIP_FD_READ not subscribed */
+  W32     rxLen;                /* Bytes of the request being read */
+  U8      rxBuf[RPC_REQ_HEADER + RPC_CMD_MAX];
+  RPC_TX_st *txFirst_p;         /* Responses not yet written */
+  RPC_TX_st *txLast_p;
+} RPC_CONN_st;
+
+/* Console handler of the pool */
+typedef struct RPC_CONH_st
+{
+  W32     state;
+  PROCESS pid;
+  RPC_REQ_st *req_p;            /* Running request, if busy */
+  Boolean ackHeld;              /* APPCTRL_ACK held, the response has
+                                   not been written */
+} RPC_CONH_st;
+
+/****************************************************************************/
+/*                           LOCAL SUBROUTINES                              */
+/****************************************************************************/
+
+static W32 Get32(const U8 *p);
+static void Put32(U8 *p, W32 value);
+static W32 TextLength(const union SIGNAL *sig_p, W32 *completed_p);
+static void Listen(void);
+static void Accept(void);
+static void SetInput(RPC_CONN_st *conn_p, Boolean stop);
+static void CloseConn(W32 c);
+static void Read(W32 c);
+static void LocalRequest(union SIGNAL *sig_p);
+static void Enqueue(W32 c, PROCESS pid, W32 id, const char *cmd, W32 len);
+static void Queue(RPC_REQ_st *req_p);
+static Boolean CacheRequest(RPC_REQ_st *req_p);
+static void CacheReplay(const RPC_CACHE_st *cache_p, const RPC_REQ_st *req_p,
+                        Boolean fresh);
+static void CacheText(const RPC_REQ_st *req_p, W32 flags,
+                      const char *text, W32 len);
+static void CacheClear(RPC_CACHE_st *cache_p);
+static void Dispatch(void);
+static void FailRequests(void);
+static void Respond(const RPC_REQ_st *req_p, W32 flags,
+                    const char *text, W32 len);
+static void Flush(W32 c);
+static Boolean TxPending(const RPC_REQ_st *req_p);
+static void ReleaseAcks(void);
+static void SendCtrl(PROCESS pid, W32 data);
+static RPC_CONH_st *FindConh(PROCESS pid);
+static void ConhReady(PROCESS pid);
+static void ConhLost(PROCESS pid);
+static void AppText(union SIGNAL *sig_p);
+static void RequestDone(RPC_CONH_st *conh_p);
+static void Finished(RPC_REQ_st *req_p);
+static void Terminate(void);
+
+/****************************************************************************/
+/*                           DATA                                           */
+/****************************************************************************/
+
+/*-------------------------  STATIC DATA  ----------------------------------*/
+
+/* RPC process and its address, written by IP_TELNET_SERVER before the
+   process is started */
+static PROCESS rpcPid = 0;
+static W32     rpcIpAddress;
+static W32     rpcPort;
+static W32     rpcPrivNet;
+static W32     rpcPrivMask;
+static W32     rpcCacheCount;
+static RPC_CACHE_st rpcCache[CFG_CACHE_MAX];
+
+/* The following data is only used by the IP_TELNET_RPC process */
+static int          listenSockId = -1;
+static RPC_CONN_st  conn[RPC_MAX_CONNS];
+static RPC_CONH_st  conh[RPC_CONH_MAX];
+static RPC_REQ_st  *reqFirst_p = NULL;      /* Waiting requests */
+static RPC_REQ_st  *reqLast_p = NULL;
+
+
+
+/**************************************************************************
+ * Internal function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Reads a W32 in network byte order.
+*
+* @param   p         Data.
+*
+* @return  Value.
+*
+***************************************************************************
+*/
+static W32 Get32(const U8 *p)
+{
+  return ((W32) p[0] << 24) | ((W32) p[1] << 16) | ((W32) p[2] << 8) |
+         (W32) p[3];
+} /* Get32 */
+
+
+
+/**
+***************************************************************************
+* @brief Writes a W32 in network byte order.
+*
+* @param   p         Data.
+* @param   value     Value.
+*
+***************************************************************************
+*/
+static void Put32(U8 *p, W32 value)
+{
+  p[0] = (U8) (value >> 24);
+  p[1] = (U8) (value >> 16);
+  p[2] = (U8) (value >> 8);
+  p[3] = (U8) value;
+} /* Put32 */
+
+
+
+/**
+***************************************************************************
+* @brief Returns the length of the output in an APPTEXT, without the
+*        prompt that completes a command.
+*
+* @param   sig_p       APPTEXT.
+* @param   completed_p Set to TRUE if the command has completed.
+*
+* @return  Length of the output.
+*
+***************************************************************************
+*/
+static W32 TextLength(const union SIGNAL *sig_p, W32 *completed_p)
+{
+  const char *text = sig_p->apptext.text;
+  const char *nl_p;
+
+  *completed_p = (W32) ((sig_p->apptext.ctrl & APPTEXT_RDY) ||
+                        (strcmp(text, "\r\nOSmon> ") == 0) ||
+                        (strcmp(text, "\r\nOSmon>") == 0));
+  if (!*completed_p)
+  {
+    return (W32) strlen(text);
+  }
+
+  /* The last line is the prompt, with the line break before it */
+  nl_p = strrchr(text, '\n');
+  if (nl_p == NULL)
+  {
+    return 0;
+  }
+  if ((nl_p > text) && (nl_p[-1] == '\r'))
+  {
+    nl_p--;
+  }
+  return (W32) (nl_p - text);
+} /* TextLength */
+
+
+
+/**
+***************************************************************************
+* @brief Creates the listen socket of the RPC port. A failure, e.g.
+*        the port is in use, is traced and the socket is closed; the
+*        process then serves the processes on the node only.
+*
+***************************************************************************
+*/
+static void Listen(void)
+{
+  struct tip_sockaddr_in addr;
+  W32 flag;
+
+  listenSockId = tip_socket((int)TIP_AF_INET, (int)TIP_SOCK_STREAM, 0);
+  if (listenSockId < 0)
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_34, (W32) tip_errno);
+    listenSockId = -1;
+    return;
+  }
+
+  flag = 1;
+  if (tip_setsockopt(listenSockId, TIP_SOL_SOCKET, TIP_SO_REUSEADDR, /*lint !e641*/
+                     (void *)&flag, sizeof(flag)) < 0)
+  {
+    APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_35, (W32) tip_errno,
+                        __LINE__, __FILE__,
+                        0);
+  }
+
+  addr.sin_family      = (int)TIP_AF_INET;
+  addr.sin_addr.s_addr = tip_htonl(rpcIpAddress);
+  addr.sin_port        = tip_htons((unsigned short) rpcPort);
+
+  if (tip_bind(listenSockId, (struct tip_sockaddr *) &addr,
+               sizeof(struct tip_sockaddr_in)) < 0)
+  {
+    APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_36, (W32) tip_errno,
+                        __LINE__, __FILE__,
+                        1,
+                        rpcPort);
+  }
+  else if (tip_asyncselect(listenSockId, TIP_FD_CLOSE | TIP_FD_ACCEPT) < 0) /*lint !e641 !e655*/
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_37, (W32) tip_errno);
+  }
+  else if (tip_listen(listenSockId, RPC_MAX_CONNS) < 0)
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_38, (W32) tip_errno);
+  }
+  else
+  {
+    return;
+  }
+
+  (void) tip_close(listenSockId);
+  listenSockId = -1;
+} /* Listen */
+
+
+
+/**
+***************************************************************************
+* @brief Accepts a connection to the RPC port. Connections from other
+*        than loopback and telnet_privileged_net, and connections
+*        above RPC_MAX_CONNS, are closed.
+*
+***************************************************************************
+*/
+static void Accept(void)
+{
+  struct tip_sockaddr_in addr;
+  tip_socklen_t size = sizeof(addr);
+  int sockId;
+  W32 ipAddress;
+  W32 c;
+
+  sockId = tip_accept(listenSockId, (struct tip_sockaddr *) &addr, &size);
+  if (sockId < 0)
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_39, (W32) tip_errno);
+    return;
+  }
+
+  ipAddress = tip_ntohl(addr.sin_addr.s_addr);
+  for (c = 0; c < RPC_MAX_CONNS; c++)
+  {
+    if (!conn[c].used)
+    {
+      break;
+    }
+  }
+
+  if ((c == RPC_MAX_CONNS) ||
+      !(((ipAddress & LOOPBACK_MASK) == LOOPBACK_NET) ||
+        ((rpcPrivMask != 0) && ((ipAddress & rpcPrivMask) == rpcPrivNet))))
+  {
+    APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_40, c,
+                        __LINE__, __FILE__,
+                        1,
+                        ipAddress);
+    (void) tip_close(sockId);
+    return;
+  }
+
+  conn[c].used = TRUE;
+  conn[c].sockId = sockId;
+  conn[c].queued = 0;
+  conn[c].rxLen = 0;
+  conn[c].txFirst_p = NULL;
+  conn[c].txLast_p = NULL;
+  conn[c].inputStopped = TRUE;
+  SetInput(&conn[c], FALSE);
+} /* Accept */
+
+
+
+/**
+***************************************************************************
+* @brief Stops or resumes reading from a connection, by the
+*        subscription of TIP_FD_READ.
+*
+* @param   conn_p    Connection.
+* @param   stop      TRUE to stop reading, FALSE to resume.
+*
+***************************************************************************
+*/
+static void SetInput(RPC_CONN_st *conn_p, Boolean stop)
+{
+  int result;
+
+  if (conn_p->inputStopped == stop)
+  {
+    return;
+  }
+
+  if (stop)
+  {
+    result = tip_asyncselect(conn_p->sockId, TIP_FD_CLOSE | TIP_FD_WRITE); /*lint !e641 !e655*/
+  }
+  else
+  {
+    result = tip_asyncselect(conn_p->sockId, TIP_FD_CLOSE | TIP_FD_READ | TIP_FD_WRITE); /*lint !e641 !e655*/
+  }
+
+  if (result < 0)
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_41, (W32) tip_errno);
+    return;
+  }
+
+  conn_p->inputStopped = stop;
+} /* SetInput */
+
+
+
+/**
+***************************************************************************
+* @brief Closes a connection. Its waiting requests are dropped and its
+*        running requests are aborted, their console handlers are kept.
+*        A command run for the result cache is not aborted.
+*
+* @param   c         Connection.
+*
+***************************************************************************
+*/
+static void CloseConn(W32 c)
+{
+  RPC_REQ_st **prev_pp;
+  RPC_REQ_st *req_p;
+  RPC_TX_st *tx_p;
+  W32 i;
+
+  (void) tip_close(conn[c].sockId);
+  conn[c].used = FALSE;
+
+  while (conn[c].txFirst_p != NULL)
+  {
+    tx_p = conn[c].txFirst_p;
+    conn[c].txFirst_p = tx_p->next_p;
+    OS_free((union SIGNAL **) &tx_p);
+  }
+  conn[c].txLast_p = NULL;
+
+  prev_pp = &reqFirst_p;
+  reqLast_p = NULL;
+  while (*prev_pp != NULL)
+  {
+    req_p = *prev_pp;
+    if (req_p->conn == c)
+    {
+      *prev_pp = req_p->next_p;
+      OS_free((union SIGNAL **) &req_p);
+    }
+    else
+    {
+      reqLast_p = req_p;
+      prev_pp = &req_p->next_p;
+    }
+  }
+
+  for (i = 0; i < rpcCacheCount; i++)
+  {
+    prev_pp = &rpcCache[i].waitFirst_p;
+    while (*prev_pp != NULL)
+    {
+      req_p = *prev_pp;
+      if (req_p->conn == c)
+      {
+        *prev_pp = req_p->next_p;
+        OS_free((union SIGNAL **) &req_p);
+      }
+      else
+      {
+        prev_pp = &req_p->next_p;
+      }
+    }
+  }
+
+  for (i = 0; i < RPC_CONH_MAX; i++)
+  {
+    if ((conh[i].state == RPC_CONH_BUSY) && (conh[i].req_p->conn == c))
+    {
+      conh[i].req_p->conn = RPC_NO_CONN;
+      SendCtrl(conh[i].pid, APPCTRL_ABORT);
+    }
+  }
+
+  /* Also the commands run for the result cache, if this connection
+     was the one not written */
+  ReleaseAcks();
+} /* CloseConn */
+
+
+
+/**
+***************************************************************************
+* @brief Reads requests from a connection. A request longer than
+*        RPC_CMD_MAX closes the connection.
+*
+* @param   c         Connection.
+*
+***************************************************************************
+*/
+static void Read(W32 c)
+{
+  RPC_CONN_st *conn_p = &conn[c];
+  int n;
+  W32 len;
+
+  n = tip_read(conn_p->sockId, &conn_p->rxBuf[conn_p->rxLen],
+               (int) (sizeof(conn_p->rxBuf) - conn_p->rxLen));
+  if (n <= 0)
+  {
+    if ((n < 0) && (tip_errno != (int)TIP_EWOULDBLOCK))
+    {
+      APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_42, (W32) tip_errno);
+    }
+    return;
+  }
+  conn_p->rxLen += (W32) n;
+
+  while (conn_p->rxLen >= RPC_REQ_HEADER)
+  {
+    len = Get32(conn_p->rxBuf);
+    if ((len < 4) || (len - 4 > RPC_CMD_MAX))
+    {
+      /* Not a request of the protocol */
+      APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_43, len,
+                          __LINE__, __FILE__,
+                          0);
+      CloseConn(c);
+      return;
+    }
+
+    if (conn_p->rxLen < 4 + len)
+    {
+      break;
+    }
+
+    Enqueue(c, 0, Get32(&conn_p->rxBuf[4]), (char *) &conn_p->rxBuf[8],
+            len - 4);
+
+    conn_p->rxLen -= 4 + len;
+    memmove(conn_p->rxBuf, &conn_p->rxBuf[4 + len], conn_p->rxLen);
+  }
+
+  if (conn_p->queued > RPC_MAX_QUEUED)
+  {
+    SetInput(conn_p, TRUE);
+  }
+
+  Dispatch();
+} /* Read */
+
+
+
+/**
+***************************************************************************
+* @brief Queues the request of a process (MIRPCREQ). A command longer
+*        than RPC_CMD_MAX is answered with MI_RPC_ERROR.
+*
+* @param   sig_p     MIRPCREQ.
+*
+***************************************************************************
+*/
+static void LocalRequest(union SIGNAL *sig_p)
+{
+  RPC_REQ_st req;
+  const char *end_p;
+  W32 len;
+
+  /* The command must be terminated within the signal */
+  end_p = memchr(sig_p->mirpcreq.cmd, '\0',
+                 sigsize(&sig_p) - (MIRPCREQ_SIZE(0) - 1));
+  len = (end_p != NULL) ? (W32) (end_p - sig_p->mirpcreq.cmd) : 0;
+  if ((end_p == NULL) || (len > RPC_CMD_MAX))
+  {
+    req.next_p = NULL;
+    req.conn = RPC_NO_CONN;
+    req.pid = OS_sender(&sig_p);
+    req.cache = RPC_NO_CACHE;
+    req.id = sig_p->mirpcreq.id;
+    Respond(&req, RPC_FLAG_DONE | RPC_FLAG_ERROR,
+            RPC_TOO_LONG, strlen(RPC_TOO_LONG));
+    return;
+  }
+
+  Enqueue(RPC_NO_CONN, OS_sender(&sig_p), sig_p->mirpcreq.id,
+          sig_p->mirpcreq.cmd, len);
+  Dispatch();
+} /* LocalRequest */
+
+
+
+/**
+***************************************************************************
+* @brief Queues a request, or gives it to the result cache.
+*
+* @param   c         Connection, RPC_NO_CONN for a process.
+* @param   pid       Process, 0 for a connection.
+* @param   id        Request id.
+* @param   cmd       Command, not terminated.
+* @param   len       Length of the command.
+*
+***************************************************************************
+*/
+static void Enqueue(W32 c, PROCESS pid, W32 id, const char *cmd, W32 len)
+{
+  RPC_REQ_st *req_p;
+
+  req_p = (RPC_REQ_st *) OS_alloc(sizeof(RPC_REQ_st) + len, 0);
+  req_p->next_p = NULL;
+  req_p->conn = c;
+  req_p->pid = pid;
+  req_p->id = id;
+  req_p->cache = RPC_NO_CACHE;
+  memcpy(req_p->cmd, cmd, len);
+  req_p->cmd[len] = '\0';
+
+  if (c != RPC_NO_CONN)
+  {
+    conn[c].queued++;
+  }
+
+  if (!CacheRequest(req_p))
+  {
+    Queue(req_p);
+  }
+} /* Enqueue */
+
+
+
+/**
+***************************************************************************
+* @brief Puts a request last in the queue of waiting requests.
+*
+* @param   req_p     Request.
+*
+***************************************************************************
+*/
+static void Queue(RPC_REQ_st *req_p)
+{
+  req_p->next_p = NULL;
+  if (reqLast_p != NULL)
+  {
+    reqLast_p->next_p = req_p;
+  }
+  else
+  {
+    reqFirst_p = req_p;
+  }
+  reqLast_p = req_p;
+} /* Queue */
+
+
+
+/**
+***************************************************************************
+* @brief Gives a request to the result cache if its command is cached.
+*        A fresh result is replayed. Otherwise the request gets the
+*        responses of the running command, which is started if it does
+*        not run.
+*
+* @param   req_p     Request.
+*
+* @return  TRUE if the request was taken by the cache, FALSE if it shall
+*          be queued.
+*
+***************************************************************************
+*/
+static Boolean CacheRequest(RPC_REQ_st *req_p)
+{
+  RPC_CACHE_st *cache_p;
+  RPC_REQ_st *run_p;
+  char key[RPC_CMD_MAX + 1];
+  W32 i;
+
+  if (rpcCacheCount == 0)
+  {
+    return FALSE;
+  }
+
+  strcpy(key, req_p->cmd);
+  itelnet_CfgNormalise(key);
+  for (i = 0; i < rpcCacheCount; i++)
+  {
+    if (strcmp(rpcCache[i].cmd, key) == 0)
+    {
+      break;
+    }
+  }
+  if (i == rpcCacheCount)
+  {
+    return FALSE;
+  }
+
+  cache_p = &rpcCache[i];
+  if ((cache_p->state == RPC_CACHE_FRESH) &&
+      ((get_ticks() - cache_p->stored) < SEC_TO_TICKS(cache_p->ttl)))
+  {
+    CacheReplay(cache_p, req_p, TRUE);
+    Finished(req_p);
+    return TRUE;
+  }
+
+  if (cache_p->state == RPC_CACHE_FILLING)
+  {
+    if (cache_p->overflow)
+    {
+      /* The start of the output is lost */
+      return FALSE;
+    }
+
+    CacheReplay(cache_p, req_p, FALSE);
+    req_p->next_p = cache_p->waitFirst_p;
+    cache_p->waitFirst_p = req_p;
+    return TRUE;
+  }
+
+  /* Run the command on a request of its own, kept when the requesters
+     go away */
+  CacheClear(cache_p);
+  cache_p->state = RPC_CACHE_FILLING;
+  cache_p->overflow = FALSE;
+
+  run_p = (RPC_REQ_st *) OS_alloc(sizeof(RPC_REQ_st) + strlen(key), 0);
+  run_p->conn = RPC_NO_CONN;
+  run_p->pid = 0;
+  run_p->id = 0;
+  run_p->cache = i;
+  strcpy(run_p->cmd, key);
+  Queue(run_p);
+
+  req_p->next_p = NULL;
+  cache_p->waitFirst_p = req_p;
+  return TRUE;
+} /* CacheRequest */
+
+
+
+/**
+***************************************************************************
+* @brief Returns the responses stored in a result cache entry.
+*
+* @param   cache_p   Result cache entry.
+* @param   req_p     Request.
+* @param   fresh     TRUE if the result is complete, the last response
+*                    is flagged RPC_FLAG_DONE.
+*
+***************************************************************************
+*/
+static void CacheReplay(const RPC_CACHE_st *cache_p, const RPC_REQ_st *req_p,
+                        Boolean fresh)
+{
+  RPC_TEXT_st *text_p;
+
+  for (text_p = cache_p->textFirst_p; text_p != NULL; text_p = text_p->next_p)
+  {
+    Respond(req_p, (fresh && (text_p->next_p == NULL)) ? RPC_FLAG_DONE : 0,
+            text_p->text, text_p->len);
+  }
+} /* CacheReplay */
+
+
+
+/**
+***************************************************************************
+* @brief Handles a response of a command run for the result cache. It
+*        is returned to the waiting requests and stored. When the
+*        command has completed the result is fresh, unless it failed or
+*        was too long.
+*
+* @param   req_p     Request of the command.
+* @param   flags     RPC_FLAG_xxx.
+* @param   text      Text.
+* @param   len       Length of the text.
+*
+***************************************************************************
+*/
+static void CacheText(const RPC_REQ_st *req_p, W32 flags,
+                      const char *text, W32 len)
+{
+  RPC_CACHE_st *cache_p = &rpcCache[req_p->cache];
+  RPC_REQ_st *wait_p;
+  RPC_TEXT_st *text_p;
+
+  for (wait_p = cache_p->waitFirst_p; wait_p != NULL; wait_p = wait_p->next_p)
+  {
+    Respond(wait_p, flags, text, len);
+  }
+
+  if (!cache_p->overflow && !(flags & RPC_FLAG_ERROR))
+  {
+    if (cache_p->bytes + len > RPC_CACHE_MAX_BYTES)
+    {
+      cache_p->overflow = TRUE;
+      CacheClear(cache_p);
+    }
+    else
+    {
+      text_p = (RPC_TEXT_st *) OS_alloc(sizeof(RPC_TEXT_st) + len, 0);
+      text_p->next_p = NULL;
+      text_p->len = len;
+      memcpy(text_p->text, text, len);
+      if (cache_p->textLast_p != NULL)
+      {
+        cache_p->textLast_p->next_p = text_p;
+      }
+      else
+      {
+        cache_p->textFirst_p = text_p;
+      }
+      cache_p->textLast_p = text_p;
+      cache_p->bytes += len;
+    }
+  }
+
+  if (flags & RPC_FLAG_DONE)
+  {
+    while (cache_p->waitFirst_p != NULL)
+    {
+      wait_p = cache_p->waitFirst_p;
+      cache_p->waitFirst_p = wait_p->next_p;
+      Finished(wait_p);
+    }
+
+    if (cache_p->overflow || (flags & RPC_FLAG_ERROR))
+    {
+      CacheClear(cache_p);
+      cache_p->state = RPC_CACHE_EMPTY;
+    }
+    else
+    {
+      cache_p->state = RPC_CACHE_FRESH;
+      cache_p->stored = get_ticks();
+    }
+  }
+} /* CacheText */
+
+
+
+/**
+***************************************************************************
+* @brief Frees the responses stored in a result cache entry.
+*
+* @param   cache_p   Result cache entry.
+*
+***************************************************************************
+*/
+static void CacheClear(RPC_CACHE_st *cache_p)
+{
+  RPC_TEXT_st *text_p;
+
+  while (cache_p->textFirst_p != NULL)
+  {
+    text_p = cache_p->textFirst_p;
+    cache_p->textFirst_p = text_p->next_p;
+    OS_free((union SIGNAL **) &text_p);
+  }
+  cache_p->textLast_p = NULL;
+  cache_p->bytes = 0;
+} /* CacheClear */
+
+
+
+/**
+***************************************************************************
+* @brief Runs waiting requests on idle console handlers. Another console
+*        handler is requested when all are busy, one at a time, up to
+*        RPC_CONH_MAX.
+*
+***************************************************************************
+*/
+static void Dispatch(void)
+{
+  union SIGNAL *sig_p;
+  RPC_REQ_st *req_p;
+  W32 idle;
+  W32 none;
+  W32 i;
+
+  while (reqFirst_p != NULL)
+  {
+    idle = RPC_CONH_MAX;
+    none = RPC_CONH_MAX;
+    for (i = 0; i < RPC_CONH_MAX; i++)
+    {
+      if (conh[i].state == RPC_CONH_PENDING)
+      {
+        /* Wait for it, the replies are told apart by order */
+        return;
+      }
+      if ((conh[i].state == RPC_CONH_IDLE) && (idle == RPC_CONH_MAX))
+      {
+        idle = i;
+      }
+      if ((conh[i].state == RPC_CONH_NONE) && (none == RPC_CONH_MAX))
+      {
+        none = i;
+      }
+    }
+
+    if (idle == RPC_CONH_MAX)
+    {
+      if (none == RPC_CONH_MAX)
+      {
+        /* All busy */
+        return;
+      }
+
+      if (itelnet_ConhRequest())
+      {
+        conh[none].state = RPC_CONH_PENDING;
+      }
+      else if (none == 0)
+      {
+        /* No console handler at all */
+        FailRequests();
+      }
+      return;
+    }
+
+    req_p = reqFirst_p;
+    reqFirst_p = req_p->next_p;
+    if (reqFirst_p == NULL)
+    {
+      reqLast_p = NULL;
+    }
+    req_p->next_p = NULL;
+
+    sig_p = OS_alloc(APPCMD_S + strlen(req_p->cmd), APPCMD); /*lint !e737*/
+    strcpy((char *) sig_p->appcmd.cmd, req_p->cmd);
+    OS_send(&sig_p, conh[idle].pid);
+
+    conh[idle].state = RPC_CONH_BUSY;
+    conh[idle].req_p = req_p;
+    conh[idle].ackHeld = FALSE;
+  }
+} /* Dispatch */
+
+
+
+/**
+***************************************************************************
+* @brief Answers all waiting requests with RPC_FLAG_ERROR, when OSmonitor
+*        does not exist.
+*
+***************************************************************************
+*/
+static void FailRequests(void)
+{
+  RPC_REQ_st *req_p;
+
+  while (reqFirst_p != NULL)
+  {
+    req_p = reqFirst_p;
+    reqFirst_p = req_p->next_p;
+
+    Respond(req_p, RPC_FLAG_DONE | RPC_FLAG_ERROR,
+            RPC_NOT_AVAILABLE, strlen(RPC_NOT_AVAILABLE));
+    Finished(req_p);
+  }
+  reqLast_p = NULL;
+} /* FailRequests */
+
+
+
+/**
+***************************************************************************
+* @brief Returns a response to the requester. A process is sent
+*        MIRPCREPLY. To a connection the response is written, what can
+*        not be written at once is kept and written at TIP_FD_WRITE.
+*        The responses of a command run for the result cache are
+*        handled by the cache.
+*
+* @param   req_p     Request.
+* @param   flags     RPC_FLAG_xxx.
+* @param   text      Text.
+* @param   len       Length of the text.
+*
+***************************************************************************
+*/
+static void Respond(const RPC_REQ_st *req_p, W32 flags,
+                    const char *text, W32 len)
+{
+  union SIGNAL *sig_p;
+  RPC_TX_st *tx_p;
+  W32 c = req_p->conn;
+  W32 id = req_p->id;
+
+  if (req_p->cache != RPC_NO_CACHE)
+  {
+    CacheText(req_p, flags, text, len);
+    return;
+  }
+
+  if (req_p->pid != 0)
+  {
+    sig_p = OS_alloc(MIRPCREPLY_SIZE(len), MIRPCREPLY);
+    sig_p->mirpcreply.id = id;
+    sig_p->mirpcreply.flags = flags;
+    sig_p->mirpcreply.length = len;
+    memcpy(sig_p->mirpcreply.text, text, len);
+    sig_p->mirpcreply.text[len] = '\0';
+    OS_send(&sig_p, req_p->pid);
+    return;
+  }
+
+  if ((c == RPC_NO_CONN) || !conn[c].used)
+  {
+    return;
+  }
+
+  tx_p = (RPC_TX_st *) OS_alloc(sizeof(RPC_TX_st) + RPC_RSP_HEADER + len, 0);
+  tx_p->next_p = NULL;
+  tx_p->len = RPC_RSP_HEADER + len;
+  tx_p->pos = 0;
+  Put32(tx_p->data, RPC_RSP_HEADER - 4 + len);
+  Put32(&tx_p->data[4], id);
+  tx_p->data[8] = (U8) flags;
+  memcpy(&tx_p->data[RPC_RSP_HEADER], text, len);
+
+  if (conn[c].txLast_p != NULL)
+  {
+    conn[c].txLast_p->next_p = tx_p;
+  }
+  else
+  {
+    conn[c].txFirst_p = tx_p;
+  }
+  conn[c].txLast_p = tx_p;
+
+  Flush(c);
+} /* Respond */
+
+
+
+/**
+***************************************************************************
+* @brief Writes the responses kept for a connection. When all have been
+*        written the acknowledges held for it are sent.
+*
+* @param   c         Connection.
+*
+***************************************************************************
+*/
+static void Flush(W32 c)
+{
+  RPC_CONN_st *conn_p = &conn[c];
+  RPC_TX_st *tx_p;
+  int sent;
+
+  while (conn_p->txFirst_p != NULL)
+  {
+    tx_p = conn_p->txFirst_p;
+    sent = tip_write(conn_p->sockId, &tx_p->data[tx_p->pos],
+                     (int) (tx_p->len - tx_p->pos));
+    if (sent < 0)
+    {
+      if (tip_errno != (int)TIP_EWOULDBLOCK)
+      {
+        APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_44, (W32) tip_errno);
+      }
+      return;
+    }
+
+    tx_p->pos += (W32) sent;
+    if (tx_p->pos < tx_p->len)
+    {
+      return;
+    }
+
+    conn_p->txFirst_p = tx_p->next_p;
+    OS_free((union SIGNAL **) &tx_p);
+  }
+  conn_p->txLast_p = NULL;
+
+  ReleaseAcks();
+} /* Flush */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if responses of a request are not yet written. For a
+*        command run for the result cache the connections of all
+*        waiting requests are checked.
+*
+* @param   req_p     Request.
+*
+* @return  TRUE if a connection has responses kept, else FALSE.
+*
+***************************************************************************
+*/
+static Boolean TxPending(const RPC_REQ_st *req_p)
+{
+  const RPC_REQ_st *wait_p;
+
+  if (req_p->cache != RPC_NO_CACHE)
+  {
+    for (wait_p = rpcCache[req_p->cache].waitFirst_p; wait_p != NULL;
+         wait_p = wait_p->next_p)
+    {
+      if (TxPending(wait_p))
+      {
+        return TRUE;
+      }
+    }
+    return FALSE;
+  }
+
+  return (Boolean) ((req_p->conn != RPC_NO_CONN) &&
+                    (conn[req_p->conn].txFirst_p != NULL));
+} /* TxPending */
+
+
+
+/**
+***************************************************************************
+* @brief Sends the acknowledges held for responses that have now been
+*        written, or that no longer have a connection to be written to.
+*
+***************************************************************************
+*/
+static void ReleaseAcks(void)
+{
+  W32 i;
+
+  for (i = 0; i < RPC_CONH_MAX; i++)
+  {
+    if (conh[i].ackHeld && !TxPending(conh[i].req_p))
+    {
+      conh[i].ackHeld = FALSE;
+      SendCtrl(conh[i].pid, APPCTRL_ACK);
+    }
+  }
+} /* ReleaseAcks */
+
+
+
+/**
+***************************************************************************
+* @brief Sends APPCTRL to a console handler.
+*
+* @param   pid       Console handler.
+* @param   data      APPCTRL_ACK or APPCTRL_ABORT.
+*
+***************************************************************************
+*/
+static void SendCtrl(PROCESS pid, W32 data)
+{
+  union SIGNAL *sig_p;
+
+  sig_p = OS_alloc(APPCTRL_S, APPCTRL);
+  sig_p->appctrl.data = data;
+  OS_send(&sig_p, pid);
+} /* SendCtrl */
+
+
+
+/**
+***************************************************************************
+* @brief Finds a console handler of the pool.
+*
+* @param   pid       Console handler.
+*
+* @return  The console handler, NULL if not in the pool.
+*
+***************************************************************************
+*/
+static RPC_CONH_st *FindConh(PROCESS pid)
+{
+  W32 i;
+
+  for (i = 0; i < RPC_CONH_MAX; i++)
+  {
+    if ((conh[i].state >= RPC_CONH_IDLE) && (conh[i].pid == pid))
+    {
+      return &conh[i];
+    }
+  }
+
+  return NULL;
+} /* FindConh */
+
+
+
+/**
+***************************************************************************
+* @brief Adds a new console handler (APPCTRL_READY) to the pool. The
+*        console handler is supervised, OSmonitor may be restarted.
+*
+* @param   pid       Console handler.
+*
+***************************************************************************
+*/
+static void ConhReady(PROCESS pid)
+{
+  W32 i;
+
+  for (i = 0; i < RPC_CONH_MAX; i++)
+  {
+    if (conh[i].state == RPC_CONH_PENDING)
+    {
+      conh[i].state = RPC_CONH_IDLE;
+      conh[i].pid = pid;
+      conh[i].req_p = NULL;
+      conh[i].ackHeld = FALSE;
+      (void) attach(NULL, pid);
+      Dispatch();
+      return;
+    }
+  }
+
+  APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_45, APPCTRL_READY,
+                      __LINE__, __FILE__,
+                      0);
+} /* ConhReady */
+
+
+
+/**
+***************************************************************************
+* @brief Removes a console handler that has terminated from the pool.
+*        Its running request is answered with RPC_FLAG_ERROR.
+*
+* @param   pid       Console handler.
+*
+***************************************************************************
+*/
+static void ConhLost(PROCESS pid)
+{
+  RPC_CONH_st *conh_p;
+
+  conh_p = FindConh(pid);
+  if (conh_p == NULL)
+  {
+    return;
+  }
+
+  if (conh_p->state == RPC_CONH_BUSY)
+  {
+    Respond(conh_p->req_p, RPC_FLAG_DONE | RPC_FLAG_ERROR,
+            RPC_NOT_AVAILABLE, strlen(RPC_NOT_AVAILABLE));
+    RequestDone(conh_p);
+  }
+  conh_p->state = RPC_CONH_NONE;
+  Dispatch();
+} /* ConhLost */
+
+
+
+/**
+***************************************************************************
+* @brief Returns the output of a request (APPTEXT) to its connection.
+*        The acknowledge is held until the response has been written.
+*
+* @param   sig_p     APPTEXT.
+*
+***************************************************************************
+*/
+static void AppText(union SIGNAL *sig_p)
+{
+  RPC_CONH_st *conh_p;
+  W32 completed;
+  W32 len;
+
+  conh_p = FindConh(OS_sender(&sig_p));
+  if ((conh_p == NULL) || (conh_p->state != RPC_CONH_BUSY))
+  {
+    APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_46, APPTEXT,
+                        __LINE__, __FILE__,
+                        0);
+    if (sig_p->apptext.ctrl & APPTEXT_ACK)
+    {
+      SendCtrl(OS_sender(&sig_p), APPCTRL_ACK);
+    }
+    return;
+  }
+
+  len = TextLength(sig_p, &completed);
+  if ((len > 0) || completed)
+  {
+    Respond(conh_p->req_p, completed ? RPC_FLAG_DONE : 0,
+            sig_p->apptext.text, len);
+  }
+
+  if (sig_p->apptext.ctrl & APPTEXT_ACK)
+  {
+    if (TxPending(conh_p->req_p))
+    {
+      conh_p->ackHeld = TRUE;
+    }
+    else
+    {
+      SendCtrl(conh_p->pid, APPCTRL_ACK);
+    }
+  }
+
+  if (completed)
+  {
+    RequestDone(conh_p);
+    Dispatch();
+  }
+} /* AppText */
+
+
+
+/**
+***************************************************************************
+* @brief Ends the running request of a console handler, which becomes
+*        idle.
+*
+* @param   conh_p    Console handler.
+*
+***************************************************************************
+*/
+static void RequestDone(RPC_CONH_st *conh_p)
+{
+  Finished(conh_p->req_p);
+  conh_p->req_p = NULL;
+  conh_p->ackHeld = FALSE;
+  conh_p->state = RPC_CONH_IDLE;
+} /* RequestDone */
+
+
+
+/**
+***************************************************************************
+* @brief Frees a request that has been answered. A connection stopped by
+*        RPC_MAX_QUEUED is read again when half of its requests are
+*        done.
+*
+* @param   req_p     Request.
+*
+***************************************************************************
+*/
+static void Finished(RPC_REQ_st *req_p)
+{
+  W32 c = req_p->conn;
+
+  if (c != RPC_NO_CONN)
+  {
+    conn[c].queued--;
+    if (conn[c].inputStopped && (conn[c].queued <= RPC_MAX_QUEUED / 2))
+    {
+      SetInput(&conn[c], FALSE);
+    }
+  }
+
+  OS_free((union SIGNAL **) &req_p);
+} /* Finished */
+
+
+
+/**
+***************************************************************************
+* @brief Closes the sockets and terminates the process. Does not return.
+*
+***************************************************************************
+*/
+static void Terminate(void)
+{
+  W32 c;
+
+  for (c = 0; c < RPC_MAX_CONNS; c++)
+  {
+    if (conn[c].used)
+    {
+      CloseConn(c);
+    }
+  }
+
+  if (listenSockId >= 0)
+  {
+    (void) tip_close(listenSockId);
+    listenSockId = -1;
+  }
+
+#ifndef SOFTKERNEL
+  /* Frees the TIP context of the process */
+  socket_proc_terminate(current_process());
+#endif
+
+  kill_proc(current_process());
+} /* Terminate */
+
+
+
+/****************************************************************************/
+/*                                                                          */
+/*                   PROCESS                                                */
+/*                                                                          */
+/*                   IP_TELNET_RPC                                          */
+/*                                                                          */
+/*--------------------------------------------------------------------------*/
+/*                                                                          */
+/*  Purpose: Runs the requests of the RPC port (telnet_rpc_port) and of     */
+/*           processes (MIRPCREQ) on a pool of console handlers.            */
+/*                                                                          */
+/****************************************************************************/
+
+APT_RP_PROCESS(IP_TELNET_RPC)
+{
+  static SIGSELECT allSignals[] = {0};
+  union SIGNAL *sig_p;
+  int sockId;
+  W32 c;
+
+  for (c = 0; c < RPC_MAX_CONNS; c++)
+  {
+    conn[c].used = FALSE;
+  }
+  for (c = 0; c < RPC_CONH_MAX; c++)
+  {
+    conh[c].state = RPC_CONH_NONE;
+  }
+  for (c = 0; c < rpcCacheCount; c++)
+  {
+    rpcCache[c].state = RPC_CACHE_EMPTY;
+    rpcCache[c].bytes = 0;
+    rpcCache[c].textFirst_p = NULL;
+    rpcCache[c].textLast_p = NULL;
+    rpcCache[c].waitFirst_p = NULL;
+  }
+
+  /* Without the RPC port only processes on the node are served, also
+     when the port can not be listened to */
+  if (rpcPort != 0)
+  {
+    Listen();
+  }
+
+  while(1)                                              /*lint !e716*/
+  {
+    sig_p = OS_receive(allSignals);
+
+    switch(sig_p->sig_no)
+    {
+      case TIP_SOCKET_CHANGED_EVENT:
+        sockId = (int) sig_p->tip_socket_changed_event.socket;
+        if ((listenSockId >= 0) && (sockId == listenSockId))
+        {
+          if (sig_p->tip_socket_changed_event.event == (int)TIP_FD_ACCEPT)
+          {
+            Accept();
+          }
+          else
+          {
+            APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_47,
+                         sig_p->tip_socket_changed_event.error);
+          }
+          break;
+        }
+
+        for (c = 0; c < RPC_MAX_CONNS; c++)
+        {
+          if (conn[c].used && (conn[c].sockId == sockId))
+          {
+            break;
+          }
+        }
+        if (c == RPC_MAX_CONNS)
+        {
+          break;
+        }
+
+        switch (sig_p->tip_socket_changed_event.event)
+        {
+          case TIP_FD_READ:
+            Read(c);
+            break;
+          case TIP_FD_WRITE:
+            Flush(c);
+            break;
+          case TIP_FD_CLOSE:
+            CloseConn(c);
+            break;
+          default:
+            break;
+        }
+        break;
+
+      case APPCTRL:
+        if (sig_p->appctrl.data == APPCTRL_READY)
+        {
+          ConhReady(OS_sender(&sig_p));
+        }
+        break;
+
+      case APPTEXT:
+        AppText(sig_p);
+        break;
+
+      case OS_ATTACH_SIG:
+        /* Console handler terminated */
+        ConhLost(OS_sender(&sig_p));
+        break;
+
+      case MIRPCREQ:
+        LocalRequest(sig_p);
+        break;
+
+      case MIRPCSTOP:
+        OS_free(&sig_p);
+        Terminate();
+        break;
+
+      default:
+        APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_48, sig_p->sig_no);
+        break;
+    }
+
+    if (sig_p != NULL)
+    {
+      OS_free(&sig_p);
+    }
+  }
+} /* IP_TELNET_RPC */
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Starts IP_TELNET_RPC if it is not already running (e.g.
+*        started by a previous telnet server). The RPC port is listened
+*        to if it is configured. A changed port or result cache
+*        configuration is used when the process is started again.
+*
+* @param   cfg_p     Configuration snapshot.
+* @param   ipAddress Address of the telnet server.
+*
+***************************************************************************
+*/
+void itelnet_RpcStart(const TELNET_CFG_st *cfg_p, W32 ipAddress)
+{
+  W32 i;
+
+  if (rpcPid != 0)
+  {
+    return;
+  }
+
+  rpcIpAddress = ipAddress;
+  rpcPort = cfg_p->rpcPort;
+  rpcPrivNet = cfg_p->privNet;
+  rpcPrivMask = cfg_p->privMask;
+
+  rpcCacheCount = cfg_p->cacheCount;
+  for (i = 0; i < rpcCacheCount; i++)
+  {
+    strcpy(rpcCache[i].cmd, cfg_p->cache[i].cmd);
+    rpcCache[i].ttl = cfg_p->cache[i].ttl;
+  }
+
+  rpcPid = OS_create_proc((OSADDRESS) IP_TELNET_RPC,
+                          OWN_REF,
+                          "IP_TELNET_RPC",
+                          15,
+                          2000,
+                          2,
+                          TRH_USER_MODE);
+} /* itelnet_RpcStart */
+
+
+
+/**
+***************************************************************************
+* @brief Stops IP_TELNET_RPC. Called when the telnet server stops.
+*
+***************************************************************************
+*/
+void itelnet_RpcStop(void)
+{
+  union SIGNAL *sig_p;
+
+  if (rpcPid != 0)
+  {
+    sig_p = OS_alloc(MIRPCSTOP_S, MIRPCSTOP);
+    OS_send(&sig_p, rpcPid);
+    rpcPid = 0;
+  }
+} /* itelnet_RpcStop */
@@ -0,0 +1,74 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_rpc_h.h                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the command RPC listener (IP_TELNET_RPC) in the   */
+/*          telnet module, and its frame protocol.                          */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_RPC_H_H
+#define I_TELNET_RPC_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+#include "i_telnet_cfg_h.h"
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/*
+ * Frame protocol of the RPC port, all fields in network byte order.
+ *
+ * Request:  W32 length (of the rest), W32 request id, command (length - 4
+ *           bytes, not terminated, at most RPC_CMD_MAX)
+ * Response: W32 length (of the rest), W32 request id, U8 flags, text
+ *           (length - 5 bytes)
+ *
+ * A request gets one or more responses, the last one with RPC_FLAG_DONE.
+ * The text is the APPTEXT text as is, without the prompt. The flags
+ * are those of MIRPCREPLY.
+ */
+#define RPC_CMD_MAX        MI_RPC_CMD_MAX
+#define RPC_REQ_HEADER     8
+#define RPC_RSP_HEADER     9
+
+/* Flags of a response */
+#define RPC_FLAG_DONE      MI_RPC_DONE
+#define RPC_FLAG_ERROR     MI_RPC_ERROR
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_SERVER process */
+extern void itelnet_RpcStart(const TELNET_CFG_st *cfg_p, W32 ipAddress);
+extern void itelnet_RpcStop(void);
+
+#endif /* I_TELNET_RPC_H_H */
@@ -0,0 +1,417 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_sig_def.h                                      */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Signals internal to the telnet module, i.e. signals sent        */
+/*          between the telnet administration, IP_TELNET_SERVER, the        */
+/*          IP_TELNET_CH_n processes and the supervised OSmonitor process.  */
+/*                                                                          */
+/*          MIRPCREQ and MIRPCREPLY are also used by processes on the       */
+/*          node to run OSmonitor commands, see i_telnet_rpc_c.c.           */
+/*                                                                          */
+/*          The file is included by sigunion.h.                             */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_SIG_DEF_H
+#define I_TELNET_SIG_DEF_H
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/* Base for the signal numbers of the module internal signals */
+#define MI_TELNET_SIGBASE 77666000
+
+/* Max number of clients waiting in the admission queue */
+#define MI_MAX_WAITING_CLIENTS 16
+
+/* Length of the client start time string in MISERVERHANDOVER */
+#define MI_START_TIME_STR_LEN 24
+
+/* Length of user name and password in MIAUTHREQ, incl. terminator */
+#define MI_AUTH_NAME_LEN   16
+#define MI_AUTH_PASSWD_LEN 16
+
+/* Result of an authentication, MIAUTHREPLY */
+#define MI_AUTH_OK         0
+#define MI_AUTH_DENIED     1
+#define MI_AUTH_THROTTLED  2    /* Too many failed logins from source */
+
+/* Pager setting of a session, MICLIENTCFG. Other values are the
+   number of lines of a page. */
+#define MI_PAGER_OFF       0
+#define MI_PAGER_WINDOW    1    /* Page size from the window size (NAWS) */
+#define MI_PAGER_MAX_LINES 1000
+
+/* Max length of the command of MIRPCREQ, without terminator */
+#define MI_RPC_CMD_MAX     256
+
+/* Max number of read-only commands (telnet_cache_n), MICLIENTCFG */
+#define MI_READONLY_MAX    8
+
+/* Flags of MIRPCREPLY */
+#define MI_RPC_DONE        0x01     /* Last reply of the request */
+#define MI_RPC_ERROR       0x02     /* The command was not run, the text
+                                       tells why */
+
+/****************************************************************************/
+/*                           SIGNALS                                        */
+/****************************************************************************/
+
+/*
+ * MIOSMONHUNT
+ * Hunt signal returned to IP_TELNET_SERVER when OSmonitor
+ * (re)appears. The sender of the signal is the OSmonitor process.
+ */
+#define MIOSMONHUNT (MI_TELNET_SIGBASE + 1)  /* !-SIGNO(struct miosmonhunt_s)-! */
+#define MIOSMONHUNT_S sizeof(struct miosmonhunt_s)
+
+struct miosmonhunt_s
+{
+  SIGSELECT sigNo;
+};
+
+/*
+ * MISESSIONTMO
+ * Sent from a client process to IP_TELNET_SERVER to set the
+ * inactivity timeout of the session. A timeout of 0 disables
+ * the supervision.
+ */
+#define MISESSIONTMO (MI_TELNET_SIGBASE + 2)  /* !-SIGNO(struct misessiontmo_s)-! */
+#define MISESSIONTMO_S sizeof(struct misessiontmo_s)
+
+struct misessiontmo_s
+{
+  SIGSELECT sigNo;
+  W32       clientInd;      /* Client individual */
+  OSTIME    timeOut;        /* Inactivity timeout in ms, 0 = none */
+};
+
+/*
+ * MICLIENTIDLE
+ * Sent from IP_TELNET_SERVER to a client process when the session
+ * has been inactive for longer than its timeout.
+ */
+#define MICLIENTIDLE (MI_TELNET_SIGBASE + 3)  /* !-SIGNO(struct miclientidle_s)-! */
+#define MICLIENTIDLE_S sizeof(struct miclientidle_s)
+
+struct miclientidle_s
+{
+  SIGSELECT sigNo;
+};
+
+/*
+ * MISERVERTICK
+ * Periodic timeout signal of IP_TELNET_SERVER, requested with
+ * APT_RP_FREQUEST_TMO. Drives the session timer wheel.
+ */
+#define MISERVERTICK (MI_TELNET_SIGBASE + 4)
+
+/*
+ * MITELNETHANDOVER
+ * Sent from the telnet administration to the running IP_TELNET_SERVER
+ * to hand over the listen socket and the sessions to a new
+ * IP_TELNET_SERVER process.
+ */
+#define MITELNETHANDOVER (MI_TELNET_SIGBASE + 5)  /* !-SIGNO(struct mitelnethandover_s)-! */
+#define MITELNETHANDOVER_S sizeof(struct mitelnethandover_s)
+
+struct mitelnethandover_s
+{
+  SIGSELECT sigNo;
+  PROCESS   serverPid;      /* The new IP_TELNET_SERVER */
+};
+
+/*
+ * MISERVERHANDOVER
+ * Sent from the old to the new IP_TELNET_SERVER. The ownership of
+ * the listen socket and of the sockets of waiting clients has been
+ * given to the new server. The new server replies MITELNETSTARTR
+ * to parentPid. If resultCode is not TELNET_START_OK nothing is
+ * handed over and the new server replies resultCode and terminates.
+ * The signal is allocated with MISERVERHANDOVER_SIZE(noOfClients).
+ */
+#define MISERVERHANDOVER (MI_TELNET_SIGBASE + 6)  /* !-SIGNO(struct miserverhandover_s)-! */
+#define MISERVERHANDOVER_SIZE(n) \
+  (sizeof(struct miserverhandover_s) + \
+   ((n) - 1) * sizeof(struct mihandoverclient_data_s))
+
+struct mihandoverclient_data_s
+{
+  W32       status;                 /* TELNET_CLIENT_IDLE/USED */
+  PROCESS   clientPid;
+  W32       clientSockId;
+  W32       clientIpAddress;
+  W32       clientPortNumber;
+  OSTIME    timeOut;                /* Inactivity timeout in ms */
+  char      clientStartTime[MI_START_TIME_STR_LEN];
+};
+
+struct mihandoverwaiting_data_s
+{
+  W32       clientSockId;
+  W32       clientIpAddress;
+  W32       clientPortNumber;
+};
+
+struct miserverhandover_s
+{
+  SIGSELECT sigNo;
+  PROCESS   parentPid;
+  W32       resultCode;     /* TELNET_START_OK or TELNET_START_FAIL */
+  W32       serverSockId;
+  W32       ipAddress;
+  W32       portNumber;
+  W32       noOfWaiting;
+  struct mihandoverwaiting_data_s waiting[MI_MAX_WAITING_CLIENTS];
+  W32       noOfClients;
+  struct mihandoverclient_data_s  client[1];     /* noOfClients entries */
+};
+
+/*
+ * MIHANDOVERCLIENT
+ * Sent from the old IP_TELNET_SERVER to each client process at
+ * handover. The client sends its signals to the new server and
+ * replies MIHANDOVERCLIENTR to the old server.
+ */
+#define MIHANDOVERCLIENT (MI_TELNET_SIGBASE + 7)  /* !-SIGNO(struct mihandoverclient_s)-! */
+#define MIHANDOVERCLIENT_S sizeof(struct mihandoverclient_s)
+
+struct mihandoverclient_s
+{
+  SIGSELECT sigNo;
+  PROCESS   serverPid;      /* The new IP_TELNET_SERVER */
+};
+
+/*
+ * MISTOPDEADLINE
+ * Timeout signal of IP_TELNET_SERVER, requested with
+ * APT_RP_FREQUEST_TMO when the server is stopped. Client processes
+ * that have not stopped when it expires are killed.
+ */
+#define MISTOPDEADLINE (MI_TELNET_SIGBASE + 8)
+
+/*
+ * MITELNETSTOPSTAT
+ * Sent from IP_TELNET_SERVER to the telnet administration just before
+ * MITELNETSTOPR.
+ */
+#define MITELNETSTOPSTAT (MI_TELNET_SIGBASE + 9)  /* !-SIGNO(struct mitelnetstopstat_s)-! */
+#define MITELNETSTOPSTAT_S sizeof(struct mitelnetstopstat_s)
+
+struct mitelnetstopstat_s
+{
+  SIGSELECT sigNo;
+  W32       duration;       /* Time to stop in ms */
+  W32       noOfClients;    /* Sessions when the stop was requested */
+  W32       noOfForced;     /* Sessions killed at the deadline */
+};
+
+/*
+ * MICLIENTCFG
+ * Sent from IP_TELNET_SERVER to a client process directly after
+ * MISTARTCLIENT, and to all running clients when the configuration
+ * has been reloaded.
+ */
+#define MICLIENTCFG (MI_TELNET_SIGBASE + 10)  /* !-SIGNO(struct miclientcfg_s)-! */
+#define MICLIENTCFG_S sizeof(struct miclientcfg_s)
+
+struct miclientcfg_s
+{
+  SIGSELECT sigNo;
+  Boolean   loginEnable;    /* Login required */
+  OSTIME    autoLogout;     /* Inactivity timeout in ms, 0 = none */
+  W32       generation;     /* Configuration generation */
+  W32       pagerLines;     /* Lines per page, MI_PAGER_OFF/WINDOW */
+  W32       noOfReadOnly;   /* Commands that may be run ahead */
+  char      readOnly[MI_READONLY_MAX][MI_RPC_CMD_MAX + 1];  /* Normalised */
+};
+
+/*
+ * MITELNETRELOAD
+ * Sent to IP_TELNET_SERVER to reload the configuration snapshot from
+ * the flash (pboot) parameters. The new configuration applies to the
+ * running server and sessions without a restart.
+ */
+#define MITELNETRELOAD (MI_TELNET_SIGBASE + 11)  /* !-SIGNO(struct mitelnetreload_s)-! */
+#define MITELNETRELOAD_S sizeof(struct mitelnetreload_s)
+
+struct mitelnetreload_s
+{
+  SIGSELECT sigNo;
+};
+
+/*
+ * MIAUTHREQ
+ * Sent from a client process to IP_TELNET_AUTH to verify a login.
+ * Forwarded by IP_TELNET_AUTH to an IP_TELNET_AUTHW_n worker when
+ * the login is not in the cache. The password is cleared before the
+ * signal is freed.
+ */
+#define MIAUTHREQ (MI_TELNET_SIGBASE + 12)  /* !-SIGNO(struct miauthreq_s)-! */
+#define MIAUTHREQ_S sizeof(struct miauthreq_s)
+
+struct miauthreq_s
+{
+  SIGSELECT sigNo;
+  PROCESS   clientPid;      /* Set by IP_TELNET_AUTH */
+  W32       clientInd;      /* Client individual */
+  W32       ipAddress;      /* Source address of the session */
+  char      userName[MI_AUTH_NAME_LEN];
+  char      password[MI_AUTH_PASSWD_LEN];
+};
+
+/*
+ * MIAUTHREPLY
+ * Reply to MIAUTHREQ, sent to the client process.
+ */
+#define MIAUTHREPLY (MI_TELNET_SIGBASE + 13)  /* !-SIGNO(struct miauthreply_s)-! */
+#define MIAUTHREPLY_S sizeof(struct miauthreply_s)
+
+struct miauthreply_s
+{
+  SIGSELECT sigNo;
+  W32       clientInd;      /* Client individual */
+  W32       result;         /* MI_AUTH_OK/DENIED/THROTTLED */
+};
+
+/*
+ * MIAUTHVERIFYR
+ * Sent from an IP_TELNET_AUTHW_n worker to IP_TELNET_AUTH with the
+ * result of a verification by the authentication backend. The
+ * request is returned with the result, the password is cleared
+ * before the signal is freed.
+ */
+#define MIAUTHVERIFYR (MI_TELNET_SIGBASE + 14)  /* !-SIGNO(struct miauthverifyr_s)-! */
+#define MIAUTHVERIFYR_S sizeof(struct miauthverifyr_s)
+
+struct miauthverifyr_s
+{
+  SIGSELECT sigNo;
+  W32       result;         /* MI_AUTH_OK/DENIED */
+  struct miauthreq_s req;   /* The request, sigNo not used */
+};
+
+/*
+ * MICLIENTWATCH
+ * Timeout signal of a client process in watch mode, requested with
+ * APT_RP_FREQUEST_TMO when the watched command has completed. The
+ * command is run again when it expires.
+ */
+#define MICLIENTWATCH (MI_TELNET_SIGBASE + 15)
+
+/*
+ * MIRPCSTOP
+ * Sent from IP_TELNET_SERVER to IP_TELNET_RPC when the server stops.
+ * The RPC listener closes its connections and terminates.
+ */
+#define MIRPCSTOP (MI_TELNET_SIGBASE + 16)  /* !-SIGNO(struct mirpcstop_s)-! */
+#define MIRPCSTOP_S sizeof(struct mirpcstop_s)
+
+struct mirpcstop_s
+{
+  SIGSELECT sigNo;
+};
+
+/*
+ * MIRPCREQ
+ * Sent from a process on the node to IP_TELNET_RPC (found with hunt)
+ * to run an OSmonitor command, at most MI_RPC_CMD_MAX characters. The requests
+ * are run in order of arrival; several may run at the same time.
+ * The signal is allocated with MIRPCREQ_SIZE(strlen(cmd)).
+ */
+#define MIRPCREQ (MI_TELNET_SIGBASE + 17)  /* !-SIGNO(struct mirpcreq_s)-! */
+#define MIRPCREQ_SIZE(n) (sizeof(struct mirpcreq_s) + (n))
+
+struct mirpcreq_s
+{
+  SIGSELECT sigNo;
+  W32       id;             /* Request id, returned in MIRPCREPLY */
+  char      cmd[1];         /* Command, terminated */
+};
+
+/*
+ * MIRPCREPLY
+ * Output of a MIRPCREQ command, sent to the requesting process as it
+ * arrives from OSmonitor. The last reply of a request has MI_RPC_DONE
+ * set. The prompt is not included.
+ * The signal is allocated with MIRPCREPLY_SIZE(length).
+ */
+#define MIRPCREPLY (MI_TELNET_SIGBASE + 18)  /* !-SIGNO(struct mirpcreply_s)-! */
+#define MIRPCREPLY_SIZE(n) (sizeof(struct mirpcreply_s) + (n))
+
+struct mirpcreply_s
+{
+  SIGSELECT sigNo;
+  W32       id;             /* Request id of MIRPCREQ */
+  W32       flags;          /* MI_RPC_DONE/ERROR */
+  W32       length;         /* Length of the text */
+  char      text[1];        /* Text, terminated */
+};
+
+/*
+ * MIHANDOVERCLIENTR
+ * Reply to MIHANDOVERCLIENT, sent from the client process to the old
+ * IP_TELNET_SERVER. The client sends no more signals to the old
+ * server, which terminates when all clients have replied.
+ */
+#define MIHANDOVERCLIENTR (MI_TELNET_SIGBASE + 19)  /* !-SIGNO(struct mihandoverclientr_s)-! */
+#define MIHANDOVERCLIENTR_S sizeof(struct mihandoverclientr_s)
+
+struct mihandoverclientr_s
+{
+  SIGSELECT sigNo;
+  W32       clientInd;
+};
+
+/*
+ * MICLIENTCONHTMO
+ * Timeout signal of a client process, requested with
+ * APT_RP_FREQUEST_TMO when a console handler is requested from
+ * OSmonitor (APPCTRL_INIT). The request has failed if it expires
+ * before APPCTRL_READY.
+ */
+#define MICLIENTCONHTMO (MI_TELNET_SIGBASE + 20)
+
+/*
+ * MICLIENTTIMETMO
+ * Timeout signal of a client process, requested with
+ * APT_RP_FREQUEST_TMO when the local command "time" asks REOS for the
+ * real time (REALTIMEGET). The time is not available if it expires
+ * before REALTIMEGETR.
+ */
+#define MICLIENTTIMETMO (MI_TELNET_SIGBASE + 21)
+
+/*
+ * MIBINDRETRY
+ * Timeout signal of IP_TELNET_SERVER, requested with
+ * APT_RP_FREQUEST_TMO when the server address is still in use at the
+ * start. The bind is retried when it expires, MITELNETSTARTR is sent
+ * when the bind has succeeded or the attempts are used up.
+ */
+#define MIBINDRETRY (MI_TELNET_SIGBASE + 22)
+
+#endif /* I_TELNET_SIG_DEF_H */
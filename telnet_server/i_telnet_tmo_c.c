@@ -0,0 +1,439 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_tmo_c.c                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Session inactivity supervision for the telnet server
+ */
+
+/**
+ * @file i_telnet_tmo_c.c
+ *
+ * The inactivity timeouts of all sessions are supervised by one
+ * hashed timer wheel in IP_TELNET_SERVER, driven by a single
+ * periodic timeout (MISERVERTICK, TMO_WHEEL_TICK_MS).
+ *
+ * A client process registers its timeout with itelnet_TmoRequest()
+ * (signal MISESSIONTMO) when the session starts and when the user
+ * has logged in. On input from the user the client only stores the
+ * current tick count with itelnet_TmoTouch(); no timer is
+ * reprogrammed.
+ *
+ * Each armed session is hashed into the wheel slot of its deadline.
+ * When the slot is reached the deadline is recalculated from the
+ * last activity: the session has either expired, or it is moved to
+ * the slot of its new deadline. Expired sessions are returned to the
+ * server in one batch.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_tmo_h.h"
+
+/* Module internal interfaces */
+#include "i_telnet_sig_def.h"
+#include "i_telnetproc_def.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  CONSTANTS  ------------------------------------*/
+
+/* Number of slots in the wheel */
+#define TMO_WHEEL_SLOTS 64
+
+/* End of slot list */
+#define TMO_NONE MAX_CONNECTIONS
+
+/*-------------------------  MACROS  ---------------------------------------*/
+
+/* TRUE if tick a is at or after tick b (handles wrap-around) */
+#define TICK_REACHED(a, b) ((OSTICK)((a) - (b)) < (OSTICK) 0x80000000UL)
+
+/****************************************************************************/
+/*                           LOCAL SUBROUTINES                              */
+/****************************************************************************/
+
+static void Insert(W32 clientInd, OSTICK deadline);
+static void Unlink(W32 clientInd);
+
+/****************************************************************************/
+/*                           DATA                                           */
+/****************************************************************************/
+
+/*-------------------------  STATIC DATA  ----------------------------------*/
+
+/* Last activity per session. Written by the client processes. */
+static volatile OSTICK lastActivity[MAX_CONNECTIONS];
+
+/* The following data is only used by the IP_TELNET_SERVER process */
+static OSTICK   tmoTicks[MAX_CONNECTIONS];    /* Timeout, 0 = not armed */
+static OSTIME   tmoMs[MAX_CONNECTIONS];       /* Timeout as requested */
+static W32      tmoSlot[MAX_CONNECTIONS];     /* Slot the session is in */
+static W32      tmoNext[MAX_CONNECTIONS];     /* Next session in slot */
+static W32      slotHead[TMO_WHEEL_SLOTS];    /* First session in slot */
+static OSTICK   slotTicks = 1;                /* Ticks per slot */
+static OSTICK   wheelTime = 0;                /* Last processed slot time */
+static W32      armed = 0;                    /* Number of armed sessions */
+
+
+
+/**************************************************************************
+ * Internal function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Inserts a session in the slot of its deadline.
+*
+* @param   clientInd Client individual.
+* @param   deadline  Deadline in system ticks.
+*
+***************************************************************************
+*/
+static void Insert(W32 clientInd, OSTICK deadline)
+{
+  OSTICK time;
+  W32 slot;
+
+  /* A deadline in an already processed slot is handled in the next */
+  time = deadline / slotTicks;
+  if (TICK_REACHED(wheelTime, time))
+  {
+    time = wheelTime + 1;
+  }
+
+  slot = (W32) (time % TMO_WHEEL_SLOTS);
+
+  tmoSlot[clientInd] = slot;
+  tmoNext[clientInd] = slotHead[slot];
+  slotHead[slot] = clientInd;
+} /* Insert */
+
+
+
+/**
+***************************************************************************
+* @brief Removes a session from its slot.
+*
+* @param   clientInd Client individual.
+*
+***************************************************************************
+*/
+static void Unlink(W32 clientInd)
+{
+  W32 *ind_p;
+
+  ind_p = &slotHead[tmoSlot[clientInd]];
+  while (*ind_p != TMO_NONE)
+  {
+    if (*ind_p == clientInd)
+    {
+      *ind_p = tmoNext[clientInd];
+      break;
+    }
+    ind_p = &tmoNext[*ind_p];
+  }
+  tmoNext[clientInd] = TMO_NONE;
+} /* Unlink */
+
+
+ 
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Initialises the timer wheel. Called by IP_TELNET_SERVER at
+*        start.
+*
+***************************************************************************
+*/
+void itelnet_TmoInit(void)
+{
+  W32 i;
+
+  /* system_tick() is the length of a system tick in microseconds */
+  slotTicks = (OSTICK) ((TMO_WHEEL_TICK_MS * 1000UL) / system_tick());
+  if (slotTicks == 0)
+  {
+    slotTicks = 1;
+  }
+
+  for (i = 0; i < TMO_WHEEL_SLOTS; i++)
+  {
+    slotHead[i] = TMO_NONE;
+  }
+
+  for (i = 0; i < MAX_CONNECTIONS; i++)
+  {
+    tmoTicks[i] = 0;
+    tmoMs[i] = 0;
+    tmoSlot[i] = 0;
+    tmoNext[i] = TMO_NONE;
+    lastActivity[i] = 0;
+  }
+
+  wheelTime = get_ticks() / slotTicks;
+  armed = 0;
+} /* itelnet_TmoInit */
+
+
+
+/**
+***************************************************************************
+* @brief Sets the inactivity timeout of a session, see MISESSIONTMO.
+*
+* @param   clientInd Client individual.
+* @param   timeOut   Timeout in ms, 0 disarms the supervision.
+*
+***************************************************************************
+*/
+void itelnet_TmoArm(W32 clientInd, OSTIME timeOut)
+{
+  OSTICK now;
+
+  if (clientInd >= MAX_CONNECTIONS)
+  {
+    return;
+  }
+
+  itelnet_TmoDisarm(clientInd);
+
+  if (timeOut != 0)
+  {
+    now = get_ticks();
+    lastActivity[clientInd] = now;
+
+    /* Split so that the product cannot overflow for long timeouts */
+    tmoTicks[clientInd] =
+      (OSTICK) ((timeOut / system_tick()) * 1000UL +
+                ((timeOut % system_tick()) * 1000UL) / system_tick());
+    if (tmoTicks[clientInd] == 0)
+    {
+      tmoTicks[clientInd] = 1;
+    }
+
+    tmoMs[clientInd] = timeOut;
+
+    Insert(clientInd, now + tmoTicks[clientInd]);
+    armed++;
+  }
+} /* itelnet_TmoArm */
+
+
+
+/**
+***************************************************************************
+* @brief Stops the inactivity supervision of a session.
+*
+* @param   clientInd Client individual.
+*
+***************************************************************************
+*/
+void itelnet_TmoDisarm(W32 clientInd)
+{
+  if ((clientInd < MAX_CONNECTIONS) && (tmoTicks[clientInd] != 0))
+  {
+    Unlink(clientInd);
+    tmoTicks[clientInd] = 0;
+    tmoMs[clientInd] = 0;
+    armed--;
+  }
+} /* itelnet_TmoDisarm */
+
+
+
+/**
+***************************************************************************
+* @brief Returns the inactivity timeout of a session.
+*
+* @param   clientInd Client individual.
+*
+* @return  Timeout in ms, 0 if the session is not supervised.
+*
+***************************************************************************
+*/
+OSTIME itelnet_TmoTimeout(W32 clientInd)
+{
+  if ((clientInd < MAX_CONNECTIONS) && (tmoTicks[clientInd] != 0))
+  {
+    return tmoMs[clientInd];
+  }
+
+  return 0;
+} /* itelnet_TmoTimeout */
+
+
+
+/**
+***************************************************************************
+* @brief Advances the wheel to the current time. Called by
+*        IP_TELNET_SERVER at MISERVERTICK.
+*
+*        Expired sessions are disarmed and returned to the caller.
+*
+* @param   expired_p  Array for the expired client individuals.
+* @param   maxExpired Size of the array.
+*
+* @return  Number of expired sessions.
+*
+***************************************************************************
+*/
+W32 itelnet_TmoExpire(W32 *expired_p, W32 maxExpired)
+{
+  OSTICK now;
+  OSTICK nowTime;
+  OSTICK deadline;
+  W32 noOfExpired = 0;
+  W32 steps = 0;
+  W32 slot;
+  W32 ind;
+  W32 next;
+
+  now = get_ticks();
+  nowTime = now / slotTicks;
+
+  while ((wheelTime != nowTime) && (steps < TMO_WHEEL_SLOTS))
+  {
+    wheelTime++;
+    steps++;
+
+    /* Take the whole slot, sessions not expired are inserted again */
+    slot = (W32) (wheelTime % TMO_WHEEL_SLOTS);
+    ind = slotHead[slot];
+    slotHead[slot] = TMO_NONE;
+
+    while (ind != TMO_NONE)
+    {
+      next = tmoNext[ind];
+      tmoNext[ind] = TMO_NONE;
+
+      deadline = lastActivity[ind] + tmoTicks[ind];
+
+      if (TICK_REACHED(now, deadline) && (noOfExpired < maxExpired))
+      {
+        /* Session has expired */
+        expired_p[noOfExpired++] = ind;
+        tmoTicks[ind] = 0;
+        tmoMs[ind] = 0;
+        armed--;
+      }
+      else
+      {
+        /* There has been activity, move to the slot of the new deadline */
+        Insert(ind, deadline);
+      }
+
+      ind = next;
+    }
+  }
+
+  /* The server was late for more than one turn, all slots processed */
+  wheelTime = nowTime;
+
+  return noOfExpired;
+} /* itelnet_TmoExpire */
+
+
+
+/**
+***************************************************************************
+* @brief Checks if any session is supervised, i.e. if the periodic
+*        MISERVERTICK is needed.
+*
+* @return  TRUE if at least one session is armed.
+*
+***************************************************************************
+*/
+Boolean itelnet_TmoActive(void)
+{
+  return (Boolean) (armed != 0);
+} /* itelnet_TmoActive */
+
+
+
+/**
+***************************************************************************
+* @brief Requests IP_TELNET_SERVER to supervise the session with the
+*        given inactivity timeout.
+*
+* @param   serverPid IP_TELNET_SERVER PID.
+* @param   clientInd Client individual.
+* @param   timeOut   Timeout in ms, 0 disables the supervision.
+*
+***************************************************************************
+*/
+void itelnet_TmoRequest(PROCESS serverPid, W32 clientInd, OSTIME timeOut)
+{
+  union SIGNAL *sig_p;
+
+  sig_p = OS_alloc(MISESSIONTMO_S, MISESSIONTMO);
+  sig_p->misessiontmo.clientInd = clientInd;
+  sig_p->misessiontmo.timeOut = timeOut;
+  OS_send(&sig_p, serverPid);
+} /* itelnet_TmoRequest */
+
+
+
+/**
+***************************************************************************
+* @brief Records activity on a session. Only the tick count is stored.
+*
+* @param   clientInd Client individual.
+*
+***************************************************************************
+*/
+void itelnet_TmoTouch(W32 clientInd)
+{
+  if (clientInd < MAX_CONNECTIONS)
+  {
+    lastActivity[clientInd] = get_ticks();
+  }
+} /* itelnet_TmoTouch */
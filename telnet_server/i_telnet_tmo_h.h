@@ -0,0 +1,64 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_tmo_h.h                                        */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the session inactivity supervision (timer         */
+/*          wheel) in the telnet module.                                    */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_TMO_H_H
+#define I_TELNET_TMO_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/* Resolution of the timer wheel, i.e. the period of MISERVERTICK */
+#define TMO_WHEEL_TICK_MS 1000
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_SERVER process */
+extern void itelnet_TmoInit(void);
+extern void itelnet_TmoArm(W32 clientInd, OSTIME timeOut);
+extern void itelnet_TmoDisarm(W32 clientInd);
+extern OSTIME itelnet_TmoTimeout(W32 clientInd);
+extern W32 itelnet_TmoExpire(W32 *expired_p, W32 maxExpired);
+extern Boolean itelnet_TmoActive(void);
+
+/* Used by the IP_TELNET_CH_n processes */
+extern void itelnet_TmoRequest(PROCESS serverPid, W32 clientInd, OSTIME timeOut);
+extern void itelnet_TmoTouch(W32 clientInd);
+
+#endif /* I_TELNET_TMO_H_H */
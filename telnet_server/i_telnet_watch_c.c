@@ -0,0 +1,355 @@
+/** @file
+*/
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_watch_c.c                                      */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/* @(#) APPROVED    EAB/RJK/MC                                              */
+/****************************************************************************/
+
+/******************  HISTORY OF DEVELOPMENT  ********************************/
+/*                                                                          */
+/* Date    Sign     Mark  Description                                       */
+/* ----    ----     ----  -----------                                       */
+/* 261019                 First issue.                                      */
+/*									    */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Watch mode for the telnet client processes
+ */
+
+/**
+ * @file i_telnet_watch_c.c
+ *
+ * In watch mode ("watch N <cmd>") the client process runs a command
+ * every N seconds. The output of a run is not printed as it arrives,
+ * it is kept by itelnet_WatchText() and drawn by itelnet_WatchDraw()
+ * when the command completes:
+ *
+ * @li At the first run the screen is cleared and a header and all
+ *     lines are drawn.
+ * @li At the following runs only the lines that differ from the last
+ *     run are drawn, at their row (cursor addressing), and the rows
+ *     below the output are cleared if it got shorter.
+ *
+ * The output is cut to the window of the client, so the screen does
+ * not scroll and the rows stay in place.
+ */
+
+/*lint -elib(14)*/
+/*lint -elib(46)*/
+/*lint -elib(628)*/
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+/*-------------------------  INTERFACES  -----------------------------------*/
+
+/* Own interface */
+#include "i_telnet_watch_h.h"
+
+/* Module external interfaces */
+#include "i_blockproc_h.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/****************************************************************************/
+/*                           LOCAL DECLARATIONS                             */
+/****************************************************************************/
+
+/*-------------------------  CONSTANTS  ------------------------------------*/
+
+/* Max size of a screen update: the lines, the cursor addressing and
+   line clearing of each row, and the header */
+#define WATCH_DRAW_SIZE (WATCH_BUF_SIZE + (WATCH_MAX_ROWS + 2) * 16 + \
+                         WATCH_CMD_MAX + 32)
+
+/****************************************************************************/
+/*                           LOCAL SUBROUTINES                              */
+/****************************************************************************/
+
+static W32 EndLine(TELNET_WATCH_st *watch_p);
+
+
+
+/**************************************************************************
+ * Internal function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Ends the line being received.
+*
+* @param   watch_p   Watch mode.
+*
+* @return  TRUE if the line is kept, FALSE if the rows or the buffer
+*          are full.
+*
+***************************************************************************
+*/
+static W32 EndLine(TELNET_WATCH_st *watch_p)
+{
+  W32 cur = watch_p->cur;
+
+  watch_p->lineLen = 0;
+
+  if ((watch_p->lines[cur] >= watch_p->rows) ||
+      (watch_p->len[cur] >= WATCH_BUF_SIZE))
+  {
+    return FALSE;
+  }
+
+  watch_p->buf[cur][watch_p->len[cur]++] = '\n';
+  watch_p->lines[cur]++;
+  return TRUE;
+} /* EndLine */
+
+
+
+/**************************************************************************
+ * External function definitions.
+ **************************************************************************/
+
+/**
+***************************************************************************
+* @brief Starts watch mode.
+*
+* @param   cmd       Command, shorter than WATCH_CMD_MAX.
+* @param   interval  Seconds between the runs.
+* @param   height    Rows of the window of the client.
+* @param   width     Columns of the window of the client.
+*
+* @return  Watch mode, freed with itelnet_WatchEnd.
+*
+***************************************************************************
+*/
+TELNET_WATCH_st *itelnet_WatchStart(const char *cmd, W32 interval,
+                                    W32 height, W32 width)
+{
+  TELNET_WATCH_st *watch_p;
+
+  watch_p = (TELNET_WATCH_st *) OS_alloc(sizeof(TELNET_WATCH_st), 0);
+
+  watch_p->interval = interval;
+  watch_p->drawn = FALSE;
+  watch_p->cur = 0;
+  watch_p->len[0] = 0;
+  watch_p->len[1] = 0;
+  watch_p->lines[0] = 0;
+  watch_p->lines[1] = 0;
+  watch_p->lineLen = 0;
+
+  /* The last row is left free, so the screen does not scroll */
+  watch_p->rows = (height > WATCH_FIRST_ROW + 1) ?
+                  height - WATCH_FIRST_ROW : 1;
+  if (watch_p->rows > WATCH_MAX_ROWS)
+  {
+    watch_p->rows = WATCH_MAX_ROWS;
+  }
+  watch_p->width = (width > 1) ? width - 1 : 1;
+
+  strncpy(watch_p->cmd, cmd, WATCH_CMD_MAX - 1);
+  watch_p->cmd[WATCH_CMD_MAX - 1] = '\0';
+
+  return watch_p;
+} /* itelnet_WatchStart */
+
+
+
+/**
+***************************************************************************
+* @brief Keeps output of the running command. Lines are cut at the
+*        width of the window, and lines below the rows of the window
+*        are dropped.
+*
+* @param   watch_p   Watch mode.
+* @param   text      APPTEXT text.
+* @param   len       Length of the text, without the prompt.
+*
+***************************************************************************
+*/
+void itelnet_WatchText(TELNET_WATCH_st *watch_p, const char *text, W32 len)
+{
+  W32 cur = watch_p->cur;
+  W32 i;
+  char c;
+
+  for (i = 0; i < len; i++)
+  {
+    c = text[i];
+
+    if (c == '\n')
+    {
+      /* Leading empty lines are dropped */
+      if ((watch_p->lines[cur] > 0) || (watch_p->lineLen > 0))
+      {
+        (void) EndLine(watch_p);
+      }
+      continue;
+    }
+
+    if (c == '\t')
+    {
+      c = ' ';
+    }
+
+    /* Control characters would move the cursor. A place is kept for
+       the end of the line. */
+    if (((U8) c < ' ') ||
+        (watch_p->lines[cur] >= watch_p->rows) ||
+        (watch_p->lineLen >= watch_p->width) ||
+        (watch_p->len[cur] + 2 > WATCH_BUF_SIZE))
+    {
+      continue;
+    }
+
+    watch_p->buf[cur][watch_p->len[cur]++] = c;
+    watch_p->lineLen++;
+  }
+} /* itelnet_WatchText */
+
+
+
+/**
+***************************************************************************
+* @brief Draws the output of the completed run. The APPTEXT completing
+*        the command is replaced with the screen update, which also
+*        completes the command.
+*
+* @param   watch_p   Watch mode.
+* @param   sig_pp    APPTEXT, replaced with the screen update.
+*
+***************************************************************************
+*/
+void itelnet_WatchDraw(TELNET_WATCH_st *watch_p, union SIGNAL **sig_pp)
+{
+  union SIGNAL *out_p;
+  char *out;
+  const char *new_p;
+  const char *old_p;
+  const char *end_p;
+  W32 cur = watch_p->cur;
+  W32 oldLines;
+  W32 newLen;
+  W32 oldLen;
+  W32 row;
+  W32 n = 0;
+
+  if (watch_p->lineLen > 0)
+  {
+    (void) EndLine(watch_p);
+  }
+
+  out_p = OS_alloc(APPTEXT_S + WATCH_DRAW_SIZE, APPTEXT); /*lint !e737*/
+  out_p->apptext.ctrl = (*sig_pp)->apptext.ctrl | APPTEXT_RDY;
+  out = (char *) out_p->apptext.text;
+
+  if (!watch_p->drawn)
+  {
+    /* Clear the screen, draw the header and all lines */
+    n += (W32) sprintf(&out[n], "\033[2J\033[HEvery %lus: %s",
+                       (unsigned long) watch_p->interval, watch_p->cmd);
+    oldLines = 0;
+  }
+  else
+  {
+    oldLines = watch_p->lines[1 - cur];
+  }
+
+  new_p = watch_p->buf[cur];
+  old_p = watch_p->buf[1 - cur];
+
+  for (row = 0; row < watch_p->lines[cur]; row++)
+  {
+    end_p = strchr(new_p, '\n');
+    newLen = (W32) (end_p - new_p);
+
+    if (row < oldLines)
+    {
+      end_p = strchr(old_p, '\n');
+      oldLen = (W32) (end_p - old_p);
+    }
+    else
+    {
+      oldLen = 0;
+    }
+
+    if ((row >= oldLines) || (newLen != oldLen) ||
+        (memcmp(new_p, old_p, newLen) != 0))
+    {
+      /* The line has changed */
+      n += (W32) sprintf(&out[n], "\033[%lu;1H",
+                         (unsigned long) (row + WATCH_FIRST_ROW));
+      memcpy(&out[n], new_p, newLen);
+      n += newLen;
+      n += (W32) sprintf(&out[n], "\033[K");
+    }
+
+    new_p += newLen + 1;
+    if (row < oldLines)
+    {
+      old_p += oldLen + 1;
+    }
+  }
+
+  /* Clear the rows of the last output that are not used, and leave the
+     cursor below the output */
+  n += (W32) sprintf(&out[n], "\033[%lu;1H",
+                     (unsigned long) (watch_p->lines[cur] + WATCH_FIRST_ROW));
+  if (oldLines > watch_p->lines[cur])
+  {
+    n += (W32) sprintf(&out[n], "\033[J");
+  }
+  out[n] = '\0';
+
+  OS_free(sig_pp);
+  *sig_pp = out_p;
+
+  /* The output of this run is compared with the next one */
+  watch_p->drawn = TRUE;
+  watch_p->cur = 1 - cur;
+  watch_p->len[1 - cur] = 0;
+  watch_p->lines[1 - cur] = 0;
+  watch_p->lineLen = 0;
+} /* itelnet_WatchDraw */
+
+
+
+/**
+***************************************************************************
+* @brief Ends watch mode.
+*
+* @param   watch_pp  Watch mode, set to NULL.
+*
+***************************************************************************
+*/
+void itelnet_WatchEnd(TELNET_WATCH_st **watch_pp)
+{
+  if (*watch_pp != NULL)
+  {
+    OS_free((union SIGNAL **) watch_pp);
+    *watch_pp = NULL;
+  }
+} /* itelnet_WatchEnd */
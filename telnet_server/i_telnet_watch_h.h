@@ -0,0 +1,89 @@
+/****************************************************************************/
+/*                                                                          */
+/*                 Copyright (C) ERICSSON RADIO SYSTEMS AB, 2004            */
+/*                                                                          */
+/*              The copyright to the computer program(s) herein is          */
+/*              the property of ERICSSON RADIO SYSTEMS AB, Sweden.          */
+/*              The program(s) may be used and/or copied only with          */
+/*              the written permission from ERICSSON RADIO SYSTEMS          */
+/*              AB or in accordance with the terms and conditions           */
+/*              stipulated in the agreement/contract under which            */
+/*              the program(s) have been supplied.                          */
+/*                                                                          */
+/****************************************************************************/
+
+/**************************  IDENTIFICATION  ********************************/
+/*                                                                          */
+/*      Unit:       RTIPGPHR                                                */
+/* @(#) ID          i_telnet_watch_h.h                                      */
+/* @(#) REVISION    -                                                       */
+/* @(#) DATE        2026-10-19                                              */
+/* @(#) DESIGNED    EAB/RJK/M                                               */
+/* @(#) RESPONSIBLE EAB/RJK/M                                               */
+/****************************************************************************/
+
+/**************************  GENERAL  ***************************************/
+/*                                                                          */
+/* Purpose: Interface for the watch mode (periodic command with updates    */
+/*          of the changed lines) of the IP_TELNET_CH_n processes.          */
+/*                                                                          */
+/****************************************************************************/
+
+#ifndef I_TELNET_WATCH_H_H
+#define I_TELNET_WATCH_H_H
+
+/****************************************************************************/
+/*                           INCLUDE                                        */
+/****************************************************************************/
+
+#include "sigunion.h"
+
+/****************************************************************************/
+/*                           CONSTANTS                                      */
+/****************************************************************************/
+
+/* Max length of the watched command */
+#define WATCH_CMD_MAX      80
+
+/* Size of the output kept of one run of the command */
+#define WATCH_BUF_SIZE     4096
+
+/* Max rows of output drawn */
+#define WATCH_MAX_ROWS     60
+
+/* Screen row of the first line of output, after the header */
+#define WATCH_FIRST_ROW    3
+
+/****************************************************************************/
+/*                           TYPE DEFINITIONS                               */
+/****************************************************************************/
+
+/* Watch mode of a session, allocated by itelnet_WatchStart */
+typedef struct TELNET_WATCH_st
+{
+  W32     interval;             /* Seconds between the runs */
+  W32     rows;                 /* Rows of output drawn */
+  W32     width;                /* Lines are cut at the width */
+  W32     drawn;                /* The screen has been drawn */
+  char    cmd[WATCH_CMD_MAX];
+  W32     cur;                  /* Buffer of the run in progress */
+  W32     len[2];               /* Output of the current and the last
+                                   run, lines ended by '\n' */
+  W32     lines[2];
+  W32     lineLen;              /* Line being received */
+  char    buf[2][WATCH_BUF_SIZE];
+} TELNET_WATCH_st;
+
+/****************************************************************************/
+/*                           FUNCTION PROTOTYPES                            */
+/****************************************************************************/
+
+/* Used by the IP_TELNET_CH_n processes */
+extern TELNET_WATCH_st *itelnet_WatchStart(const char *cmd, W32 interval,
+                                           W32 height, W32 width);
+extern void itelnet_WatchText(TELNET_WATCH_st *watch_p, const char *text,
+                              W32 len);
+extern void itelnet_WatchDraw(TELNET_WATCH_st *watch_p, union SIGNAL **sig_pp);
+extern void itelnet_WatchEnd(TELNET_WATCH_st **watch_pp);
+
+#endif /* I_TELNET_WATCH_H_H */
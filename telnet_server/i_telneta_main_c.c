@@ -87,6 +87,30 @@
  * "telneton".
  * The telnet server can be stopped at any time with the apt command
  * "telnetoff".
+ * A "telneton" received while the server is stopping starts the
+ * server again as soon as the stop is completed. The listen socket
+ * is bound with address reuse, so the restarted server does not have
+ * to wait for connections of the previous server in TIME_WAIT.
+ *
+ * The apt command "telnetrestart" replaces a running telnet server
+ * process without closing the sessions. The new IP_TELNET_SERVER takes
+ * over the listen socket, the sessions and the waiting clients from
+ * the old one (MITELNETHANDOVER, MISERVERHANDOVER). The IP_TELNET_CH_n
+ * processes keep running, i.e. logins, command history and commands
+ * in progress are not affected; they only start to report to the new
+ * server. A restart while the server is stopped starts it.
+ *
+ * When the telnet server is stopped all sessions are requested to stop
+ * at the same time. Sessions that have not stopped within the flash
+ * (pboot) parameter "telnet_stop_deadline" seconds (default 5) are
+ * killed, so the stop always completes. The time the stop took is
+ * printed to the user of the last apt command.
+ *
+ * The telnet parameters are read by the telnet server into a
+ * configuration snapshot when it starts. The apt command
+ * "telnetreload" makes the running server read them again; the new
+ * values apply to new connections and to the inactivity timeout of the
+ * running sessions.
  *
  */
 
@@ -125,6 +149,7 @@
 /* Module internal interfaces */
 #include "i_blockproc_h.h"
 #include "i_telneta_data_def.h"
+#include "i_telnet_sig_def.h"
 
 /* Module external interfaces */
 #include "t_rp_h.h"
@@ -135,6 +160,8 @@
 #endif
 #include "i_telnetproc_h.h"
 
+#include <stdio.h>
+
 /*-------------------------  COMMON DECLARATIONS  --------------------------*/
 
 #include "i_telnet_def.h"
@@ -164,8 +191,10 @@
 static void  GetModData(PROCESS_DATA_st *processData_p);
 static void  StartTelnet(PROCESS_DATA_st *processData_p);
 static void  StopTelnet(PROCESS_DATA_st *processData_p);
+static void  RestartTelnet(PROCESS_DATA_st *processData_p);
 static void  HandleTelnetStartReply(PROCESS_DATA_st *processData_p);
 static void  HandleTelnetStopReply(PROCESS_DATA_st *processData_p);
+static void  HandleTelnetStopStat(PROCESS_DATA_st *processData_p);
 
 /****************************************************************************/
 /*                           DATA                                           */
@@ -178,6 +207,9 @@ static void  HandleTelnetStopReply(PROCESS_DATA_st *processData_p);
 /* Flash (pboot) parameter name string */
 static char *telnetConfigParam="telnet";
 
+/* Telnet server to be started again when the stop is completed */
+static Boolean restartPending = FALSE;
+
 /*
 ******************************************************************************
 *                                            
@@ -284,6 +316,11 @@ void itelneta_Receive (PROCESS_DATA_st *processData_p)
       case MITELNETSTOPR:
         HandleTelnetStopReply(processData_p);
         break; 
+
+        /* Receive and report the telnet server stop duration */
+      case MITELNETSTOPSTAT:
+        HandleTelnetStopStat(processData_p);
+        break; 
        
       default:
         /* Unknown signal */
@@ -299,7 +336,8 @@ void itelneta_Receive (PROCESS_DATA_st *processData_p)
 *                                            
 *-----------------------------------------------------------------------------
 *                                            
-*  Purpose: Handles apt commands telneton and telnetoff
+*  Purpose: Handles apt commands telneton, telnetoff, telnetrestart
+*           and telnetreload
 *                                            
 *  Parameters:                               
 *                                            
@@ -316,6 +354,8 @@ static void  GetModData(PROCESS_DATA_st *processData_p)
 {
 /*-------------------------  LOCAL DATA   ----------------------------------*/
 
+  SIGNAL *sig_p;
+
 /*-------------------------  CODE  -----------------------------------------*/
 
   TELNETA_P -> printReceiverPid = OS_sender(&RECSIG);
@@ -332,9 +372,42 @@ static void  GetModData(PROCESS_DATA_st *processData_p)
           {
             StartTelnet(processData_p);
           }
+          /* If state is STOPPING start telnet when stopped */
+          else if (TELNETA_P->state == ST_TELNETA_STOPPING)
+          {
+            restartPending = TRUE;
+          }
+          break;
+
+        case OC_MOD_SET_TELNET_RESTART:
+          /* If state is RUNNING hand over to a new telnet server */
+          if (TELNETA_P->state == ST_TELNETA_RUNNING)
+          {
+            RestartTelnet(processData_p);
+          }
+          else if (TELNETA_P->state == ST_TELNETA_STOPPED)
+          {
+            StartTelnet(processData_p);
+          }
+          else if (TELNETA_P->state == ST_TELNETA_STOPPING)
+          {
+            restartPending = TRUE;
+          }
+          break;
+
+        case OC_MOD_SET_TELNET_RELOAD:
+          /* If state is RUNNING reload the telnet configuration */
+          if (TELNETA_P->state == ST_TELNETA_RUNNING)
+          {
+            sig_p = OS_alloc(MITELNETRELOAD_S,MITELNETRELOAD);
+            OS_send(&sig_p,TELNETA_P->telnetPid);
+          }
           break;
 
         case OC_MOD_SET_TELNET_OFF:
+          /* A pending start is cancelled */
+          restartPending = FALSE;
+
           /* If state is STARTED stop telnet */
           if (TELNETA_P->state == ST_TELNETA_RUNNING)
           {
@@ -464,6 +537,66 @@ static void  StopTelnet(PROCESS_DATA_st *processData_p)
   
 } /* StopTelnet */
 
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  RestartTelnet
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Replaces the running telnet server with a new telnet server
+*           process. The running server hands over its listen socket
+*           and sessions to the new server and terminates.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+
+static void  RestartTelnet(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+
+  SIGNAL *sig_p;
+  PROCESS newPid;
+  
+/*-------------------------  CODE  -----------------------------------------*/
+
+  newPid = OS_create_proc((OSADDRESS) IP_TELNET_SERVER,
+                          OWN_REF,
+                          "IP_TELNET_SERVER",
+                          15,
+                          2000,
+                          2,
+                          TRH_USER_MODE);
+
+  if (newPid)
+  {
+    /* Request the running IP_TELNET_SERVER to hand over, the new
+     * IP_TELNET_SERVER replies MITELNETSTARTR when it has taken over */
+    sig_p = OS_alloc(MITELNETHANDOVER_S,MITELNETHANDOVER);
+    sig_p->mitelnethandover.serverPid = newPid;
+
+    OS_send(&sig_p,TELNETA_P->telnetPid);
+
+    TELNETA_P->telnetPid = newPid;
+
+    /* State change
+     * New state STARTING
+     * The new telnet server takes over.
+     * Wait for MITELNETSTARTR from the new IP_TELNET_SERVER process
+     */
+    TELNETA_P->state = ST_TELNETA_STARTING;
+  }
+  
+} /* RestartTelnet */
+
 /*
 ******************************************************************************
 *
@@ -513,7 +646,7 @@ static void HandleTelnetStartReply(PROCESS_DATA_st *processData_p)
 
       if (TELNETA_P->printReceiverPid != (PROCESS) NULL)
       {
-        printString = "Error: Socket bind failed. Try again in 4 minutes.";
+        printString = "Error: Socket bind failed, telnet port is in use.";
       
         sig_p = OS_alloc(sizeof(struct rtprintdata_s) +
                          strlen(printString), RTPRINTDATA);
@@ -579,6 +712,13 @@ static void  HandleTelnetStopReply(PROCESS_DATA_st *processData_p)
      */
   
     TELNETA_P->state = ST_TELNETA_STOPPED;
+
+    /* Start again if requested while stopping */
+    if (restartPending)
+    {
+      restartPending = FALSE;
+      StartTelnet(processData_p);
+    }
   }
   else
   {
@@ -586,3 +726,54 @@ static void  HandleTelnetStopReply(PROCESS_DATA_st *processData_p)
     APT_RP_ERROR(ERROR_ID_R12_1916,(W32)TELNETA_P->state);
   }
 } /* HandleTelnetStopReply */
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  HandleTelnetStopStat
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Handles the telnet stop statistics signal, MITELNETSTOPSTAT
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+
+static void  HandleTelnetStopStat(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+
+  char printString[80];
+  SIGNAL *sig_p;
+  
+/*-------------------------  CODE  -----------------------------------------*/
+
+  if (TELNETA_P->printReceiverPid != (PROCESS) NULL)
+  {
+    sprintf(printString,
+            "Telnet server stopped in %lu ms, %lu sessions, %lu killed.",
+            (unsigned long) RECSIG->mitelnetstopstat.duration,
+            (unsigned long) RECSIG->mitelnetstopstat.noOfClients,
+            (unsigned long) RECSIG->mitelnetstopstat.noOfForced);
+
+    sig_p = OS_alloc(sizeof(struct rtprintdata_s) +
+                     strlen(printString), RTPRINTDATA);
+    sig_p->rtprintdata.sigVersion = RTPRINTDATA_SECOND_VERSION;
+    sig_p->rtprintdata.typeOfValue = TYPE_ONLY_STRING;
+    sig_p->rtprintdata.noOfPrintValues = 0;
+    sig_p->rtprintdata.printValue[0] = 0;
+    sig_p->rtprintdata.printValue[1] = 0;
+        
+    strcpy( (char *)sig_p->rtprintdata.outPutStr, printString); /*lint !e419*/
+      
+    OS_send(&sig_p, TELNETA_P -> printReceiverPid);
+  }
+} /* HandleTelnetStopStat */
@@ -71,6 +71,12 @@
 /* Module internal interfaces */
 /*#include "i_blockproc_h.h"*/
 #include "i_telnet_main_h.h"
+#include "i_telnet_conh_h.h"
+#include "i_telnet_tmo_h.h"
+#include "i_telnet_cfg_h.h"
+#include "i_telnet_auth_h.h"
+#include "i_telnet_rpc_h.h"
+#include "i_telnet_sig_def.h"
 #include "i_def.h"
 
 /* Module external interfaces */
@@ -78,14 +84,9 @@
 #include "i_telnet_main_h.h"
 #include "tipsock.h"
 
-#ifdef APT_PBOOT_USER
-#include "user_pboot.h"
-#else
-#include "pboot.h"
-#endif
-
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*-------------------------  COMMON DECLARATIONS  --------------------------*/
 
@@ -100,28 +101,118 @@
 
 #define TCP_TIMESTAMP_OFF 0
 
-#define SEND_BUFFER_SIZE 131072
+#define REUSE_ADDRESS_ON 1
+
+/* Bind retry while the address is still in use, the delay is doubled
+   for each attempt (10 + 20 + 40 + 80 + 160 ms). The server handles
+   signals meanwhile, the retry is MIBINDRETRY. */
+#define BIND_ATTEMPTS             6
+#define BIND_RETRY_DELAY          10    /* ms */
+#define BIND_PENDING              0xFFFFFFFFUL  /* MIBINDRETRY requested,
+                                                   not a result code */
 
 /* The size of the string used in RTPRINTDATA */
 #define SIZE_OF_OUTPUT_STR        200
 
+/* Token bucket scale, one accept costs one token */
+#define TOKEN                     1000
+
+/* Loopback network 127.0.0.0/8 */
+#define LOOPBACK_NET              0x7F000000UL
+#define LOOPBACK_MASK             0xFF000000UL
+
+/* Max admission queue depth */
+#define MAX_QUEUE_DEPTH           MI_MAX_WAITING_CLIENTS
+
+/* Admission control result */
+#define ADMIT_OK                  0
+#define ADMIT_FULL                1
+#define ADMIT_PER_ADDR            2
+#define ADMIT_RATE                3
+
 /*-------------------------  MACROS  ---------------------------------------*/
 
 /*-------------------------  TYPE DEF  -------------------------------------*/
 
+/* Admission control of incoming connections, the configuration is
+   in the configuration snapshot */
+typedef struct ADMISSION_st
+{
+  /* Token bucket */
+  W32    tokens;              /* Available tokens, scaled by TOKEN */
+  OSTICK lastRefill;          /* Tick count at last refill */
+
+  /* Statistics */
+  W32    rejectedFull;
+  W32    rejectedPerAddr;
+  W32    rejectedRate;
+} ADMISSION_st;
+
+/* Accepted client waiting for a free connection */
+typedef struct WAITING_CLIENT_st
+{
+  int    clientSockId;
+  W32    clientIpAddress;
+  W32    clientPortNumber;
+  OSTICK queuedAt;            /* Tick count when queued */
+} WAITING_CLIENT_st;
+
+/* Admission queue */
+typedef struct WAIT_QUEUE_st
+{
+  W32    length;              /* Number of waiting clients */
+  WAITING_CLIENT_st client[MAX_QUEUE_DEPTH];
+
+  /* Statistics */
+  W32    queued;
+  W32    promoted;
+  W32    expired;
+} WAIT_QUEUE_st;
+
+/* Telnet server stop */
+typedef struct STOP_st
+{
+  OSTICK startTick;           /* Tick count when the stop was requested */
+  W32    clients;             /* Sessions when the stop was requested */
+  W32    forced;              /* Sessions killed at the deadline */
+} STOP_st;
 
 /****************************************************************************/
 /*                           LOCAL SUBROUTINES                              */
 /****************************************************************************/
 static W32 CreateAndActivateServer(PROCESS_DATA_st *processData_p);
+static W32 BindServer(PROCESS_DATA_st *processData_p);
+static void ServerStarted(PROCESS_DATA_st *processData_p, W32 result);
 static void HandleSocketChangedEvent(PROCESS_DATA_st *processData_p);
 static void CreateClient(PROCESS_DATA_st *processData_p, W32 clientInd);
 static W32 AllocateClient(PROCESS_DATA_st *processData_p, int clientSockId);
 static void InitiateClientTermination(PROCESS_DATA_st *processData_p);
 static void HandleStopClientReply(PROCESS_DATA_st *processData_p);
+static void HandleClientLost(PROCESS_DATA_st *processData_p);
+static void ForceStopClients(PROCESS_DATA_st *processData_p);
+static void ReleaseClient(PROCESS_DATA_st *processData_p, W32 clientInd);
+static void HandoverServer(PROCESS_DATA_st *processData_p);
+static W32 AdoptServer(PROCESS_DATA_st *processData_p);
 static void ProcessInit(PROCESS_DATA_st *processData_p);
 static void CheckAndStopServer(const PROCESS_DATA_st *const processData_p);
+static void StartServerTick(void);
+static void HandleServerTick(const PROCESS_DATA_st *const processData_p);
 static void GetClock1(char *str_p);
+static void AdmissionInit(void);
+static void ReloadConfig(PROCESS_DATA_st *processData_p);
+static Boolean IsPrivileged(W32 ipAddress);
+static W32 AdmitClient(const PROCESS_DATA_st *const processData_p,
+                       W32 ipAddress);
+static void RejectClient(int clientSockId, W32 reason);
+static void StartClient(PROCESS_DATA_st *processData_p, int clientSockId,
+                        W32 ipAddress, W32 portNumber);
+static Boolean QueueClient(int clientSockId, W32 ipAddress, W32 portNumber);
+static void DequeueClient(W32 pos);
+static void TellQueuePositions(W32 fromPos);
+static Boolean HandleQueuedSocketEvent(PROCESS_DATA_st *processData_p);
+static void PromoteQueuedClients(PROCESS_DATA_st *processData_p);
+static void ExpireQueuedClients(void);
+static void CloseQueuedClients(void);
 static void ReportModuleData (PROCESS_DATA_st *processData_p);
 static void SendLine (PROCESS_DATA_st *processData_p,
                       const char *printString,
@@ -137,9 +228,31 @@ static void SendLine (PROCESS_DATA_st *processData_p,
 
 /*-------------------------  STATIC DATA  ----------------------------------*/
 
-static W32 sendBufferSize = SEND_BUFFER_SIZE;
 static const char dotStr[] = ".";
 
+/* Configuration snapshot */
+static TELNET_CFG_st config;
+
+/* Periodic timeout driving the session timer wheel */
+static CANCEL_INFO serverTickTmo;
+static Boolean serverTickActive = FALSE;
+
+/* Admission control data */
+static ADMISSION_st admission;
+
+/* Clients waiting for a free connection */
+static WAIT_QUEUE_st waitQueue;
+
+/* Deadline for the clients to stop */
+static CANCEL_INFO stopDeadlineTmo;
+static Boolean stopDeadlineActive = FALSE;
+static STOP_st stopData;
+
+/* Bind retry at the start */
+static CANCEL_INFO bindRetryTmo;
+static W32 bindAttempt;
+static OSTIME bindRetryDelay;
+
 
 
 /****************************************************************************/
@@ -164,42 +277,61 @@ APT_RP_PROCESS(IP_TELNET_SERVER)
   
   SIGNAL* sig_p;
   W32 result;
-  static SIGSELECT startTelnetReq[] = {1,MITELNETSTART};
+  static SIGSELECT startTelnetReq[] = {2,MITELNETSTART,MISERVERHANDOVER};
   static SIGSELECT allSignals[] = {0};     /* Signal select array */
-  static char buf[32] ="";	/* Text buffer. */
 
 /*-------------------------  CODE  -----------------------------------------*/
 
-#ifdef APT_PBOOT_USER
-  if(!user_pboot_param_get("send_buffer_size", buf, 31))  
-#else
-  if(!pboot_param_get("send_buffer_size", buf, 31))
-#endif  
+  /* Wait for start signal, from the creator or from a previous
+   * telnet server handing over its sessions */
+  RECSIG = OS_receive(startTelnetReq);
+
+  if ((RECSIG->sig_no == MISERVERHANDOVER) &&
+      (RECSIG->miserverhandover.resultCode != TELNET_START_OK))
   {
-    sendBufferSize = atoi(buf);
-    printf("i_telnetproc, send_buffer_size: %ld\n", sendBufferSize);
+    /* The previous telnet server is stopping and keeps its static
+     * data, reply the failure and terminate */
+    sig_p = OS_alloc(MITELNETSTARTR_S,MITELNETSTARTR);
+    sig_p->mitelnetstartr.resultCode = RECSIG->miserverhandover.resultCode;
+    OS_send(&sig_p, RECSIG->miserverhandover.parentPid);
+
+    OS_free(&RECSIG);
+    kill_proc(current_process());
   }
-  
+
+  /* The static data is shared with a previous telnet server until it
+   * has handed over, so it is not initialised before this point */
+  itelnet_CfgLoad(&config);
   ProcessInit(processData_p);
-  
-  /* Wait for start signal */
-  RECSIG = OS_receive(startTelnetReq);
-  /* Save the Process ID for the creator */
-  processData_p->parentPid = OS_sender(&RECSIG);
-  /* Save server IP address and port number */
-  processData_p->ipAddress = RECSIG->mitelnetstart.ipAddress;
-  processData_p->portNumber = RECSIG->mitelnetstart.portNumber;  
+  AdmissionInit();
 
-  OS_free(&RECSIG);
-  
-  /* Create and activate the server socket */
-  result = CreateAndActivateServer(processData_p);
+  if (RECSIG->sig_no == MISERVERHANDOVER)
+  {
+    /* Take over the server socket and the sessions */
+    processData_p->parentPid = RECSIG->miserverhandover.parentPid;
+    result = AdoptServer(processData_p);
+
+    OS_free(&RECSIG);
+  }
+  else
+  {
+    /* Save the Process ID for the creator */
+    processData_p->parentPid = OS_sender(&RECSIG);
+    /* Save server IP address and port number */
+    processData_p->ipAddress = RECSIG->mitelnetstart.ipAddress;
+    processData_p->portNumber = RECSIG->mitelnetstart.portNumber;  
+
+    OS_free(&RECSIG);
   
-  /* Telnet server was started send reply signal to our creator (parent) */
-  sig_p = OS_alloc(MITELNETSTARTR_S,MITELNETSTARTR);
-  sig_p->mitelnetstartr.resultCode = result;
+    /* Create and activate the server socket */
+    result = CreateAndActivateServer(processData_p);
+  }
   
-  OS_send(&sig_p, processData_p->parentPid);
+  /* Reply to our creator (parent), unless the bind is retried */
+  if (result != BIND_PENDING)
+  {
+    ServerStarted(processData_p, result);
+  }
   
   /* Enter main loop */
   while(1)                                              /*lint !e716*/
@@ -232,10 +364,63 @@ APT_RP_PROCESS(IP_TELNET_SERVER)
       case MISTOPCLIENTR:
         HandleStopClientReply(processData_p);
         break;
+
+      case MITELNETRELOAD:
+        /* Reload the configuration snapshot */
+        ReloadConfig(processData_p);
+        break;
+
+      case MISTOPDEADLINE:
+        /* Clients still running are killed, no return... */
+        stopDeadlineActive = FALSE;
+        ForceStopClients(processData_p);
+        break;
+
+      case MITELNETHANDOVER:
+        /* Hand over to a new telnet server, no return unless stopping */
+        HandoverServer(processData_p);
+        break;
         
       case RTGETMODDATA:
         ReportModuleData(processData_p);
         break;
+
+      case MISESSIONTMO:
+        /* Client sets its inactivity timeout */
+        itelnet_TmoArm(RECSIG->misessiontmo.clientInd,
+                       RECSIG->misessiontmo.timeOut);
+        StartServerTick();
+        break;
+
+      case MISERVERTICK:
+        serverTickActive = FALSE;
+        HandleServerTick(processData_p);
+        break;
+
+      case MIBINDRETRY:
+        /* The server address was in use at the start, bind again */
+        result = BindServer(processData_p);
+        if (result != BIND_PENDING)
+        {
+          ServerStarted(processData_p, result);
+        }
+        break;
+
+      case MIOSMONHUNT:
+        /* OSmonitor found */
+        if (!itelnet_ConhHandleSig(RECSIG))
+        {
+          APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_22,RECSIG->sig_no);
+        }
+        break;
+
+      case OS_ATTACH_SIG:
+        /* OSmonitor or a client process taken over at handover lost */
+        if (!itelnet_ConhHandleSig(RECSIG))
+        {
+          HandleClientLost(processData_p);
+        }
+        break;
         
       default:
         /* Unexpected signal */
@@ -268,16 +453,14 @@ APT_RP_PROCESS(IP_TELNET_SERVER)
 *
 *      *processData_p   in      Pointer to the process data.
 *
-*  Return value: void
+*  Return value: TELNET_START_xxx, or BIND_PENDING if the bind is
+*                retried (MIBINDRETRY)
 *
 *****************************************************************************
 */
 static W32 CreateAndActivateServer(PROCESS_DATA_st *processData_p)
 {
 /*-------------------------  LOCAL DATA   ----------------------------------*/
-  struct tip_sockaddr_in addr;
-  tip_socklen_t size;
-  int returnValue;
   W32 result = TELNET_START_FAIL;
   W32 flag;
 /*-------------------------  CODE  -----------------------------------------*/
@@ -290,76 +473,194 @@ static W32 CreateAndActivateServer(PROCESS_DATA_st *processData_p)
   else
   {
   
-    /* Create and fill in address structure. */
-    size = sizeof(struct tip_sockaddr_in);
-    addr.sin_family      = (int)TIP_AF_INET;
-    addr.sin_addr.s_addr = tip_htonl(processData_p->ipAddress); 
-    addr.sin_port        = tip_htons(processData_p->portNumber);
+    /* Allow the address to be bound although connections from a
+       previous server are in TIME_WAIT. */
+    flag = REUSE_ADDRESS_ON;
+    if(tip_setsockopt(processData_p->serverSockId,
+                      TIP_SOL_SOCKET, TIP_SO_REUSEADDR,          /*lint !e641*/
+                      (void *)&flag,
+                      sizeof(flag)) < 0)
+    {
+      APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_12, (W32) tip_errno,
+                          __LINE__, __FILE__,
+                          0);
+    }
   
-    /* Bind the socket to the address. */
-    returnValue = tip_bind(processData_p->serverSockId, (struct tip_sockaddr *) &addr, size);
-    if(returnValue < 0)
+    /* Bind the socket to the address and activate it */
+    bindAttempt = 0;
+    bindRetryDelay = BIND_RETRY_DELAY;
+    result = BindServer(processData_p);
+  }
+
+  return(result);
+} /* CreateAndActivateServer */
+
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  BindServer
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Bind the telnet server socket to the address, and start
+*           listening. While the address is in use the bind is retried
+*           at MIBINDRETRY, with increasing delay.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: TELNET_START_xxx, or BIND_PENDING if the bind is
+*                retried
+*
+*****************************************************************************
+*/
+static W32 BindServer(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  struct tip_sockaddr_in addr;
+  tip_socklen_t size;
+  int returnValue;
+  W32 result = TELNET_START_FAIL;
+  W32 flag;
+/*-------------------------  CODE  -----------------------------------------*/
+  /* Create and fill in address structure. */
+  size = sizeof(struct tip_sockaddr_in);
+  addr.sin_family      = (int)TIP_AF_INET;
+  addr.sin_addr.s_addr = tip_htonl(processData_p->ipAddress); 
+  addr.sin_port        = tip_htons(processData_p->portNumber);
+
+  /* Bind the socket to the address. */
+  bindAttempt++;
+  returnValue = tip_bind(processData_p->serverSockId, (struct tip_sockaddr *) &addr, size);
+  if ((returnValue < 0) &&
+      (tip_errno == (int)TIP_EADDRINUSE) &&
+      (bindAttempt < BIND_ATTEMPTS))
+  {
+    /* Still in use, retry later */
+    APT_RP_FREQUEST_TMO(&bindRetryTmo, bindRetryDelay,
+                        current_process(), MIBINDRETRY);
+    bindRetryDelay *= 2;
+    return BIND_PENDING;
+  }
+
+  if(returnValue < 0)
+  {
+    /* Error when binding socket. */
+    APT_RP_DOTRACE_LEV1(ERROR_ID_R12_2102,
+                        (W32) tip_errno,
+                        __LINE__,
+                        __FILE__,
+                        4,           /* Num of extra parameters 0-65535 */
+                        addr.sin_addr.s_addr,
+                        addr.sin_port,
+                        size,
+                        bindAttempt);
+    
+    result = TELNET_START_FAIL_BIND;
+  }
+  else
+  {
+    /* Subscribe on client connection request and socket closed events */
+    returnValue = tip_asyncselect(processData_p->serverSockId, TIP_FD_CLOSE|TIP_FD_ACCEPT); /*lint !e641 !e655*/
+    if (returnValue < 0)
     {
-      /* Error when binding socket. */
-      APT_RP_DOTRACE_LEV1(ERROR_ID_R12_2102,
-                          (W32) tip_errno,
-                          __LINE__,
-                          __FILE__,
-                          3,           /* Num of extra parameters 0-65535 */
-                          addr.sin_addr.s_addr,
-                          addr.sin_port,
-                          size);
-      
-      result = TELNET_START_FAIL_BIND;
+      APT_RP_ERROR(ERROR_ID_R12_1899, (W32) tip_errno);
     }
     else
     {
-      /* Subscribe on client connection request and socket closed events */
-      returnValue = tip_asyncselect(processData_p->serverSockId, TIP_FD_CLOSE|TIP_FD_ACCEPT); /*lint !e641 !e655*/
-      if (returnValue < 0)
+      
+      /* Disable the TCP Timestamp option */
+      flag = TCP_TIMESTAMP_OFF;
+      if(tip_setsockopt(processData_p->serverSockId,
+                        TIP_IPPROTO_TCP, TIP_TCP_TIMESTAMP,      /*lint !e641*/
+                        (void *)&flag,
+                        sizeof(flag)) < 0)
       {
-        APT_RP_ERROR(ERROR_ID_R12_1899, (W32) tip_errno);
+        APT_RP_ERROR(ERROR_ID_R12_1900, (W32) tip_errno);
       }
-      else
-      {
-        
-        /* Disable the TCP Timestamp option */
-        flag = TCP_TIMESTAMP_OFF;
-        if(tip_setsockopt(processData_p->serverSockId,
-                          TIP_IPPROTO_TCP, TIP_TCP_TIMESTAMP,      /*lint !e641*/
-                          (void *)&flag,
-                          sizeof(flag)) < 0)
-        {
-          APT_RP_ERROR(ERROR_ID_R12_1900, (W32) tip_errno);
-        }
 
-        /* Set the Send buffer size */
-        flag = sendBufferSize;
-        if(tip_setsockopt(processData_p->serverSockId,
-                          TIP_SOL_SOCKET, TIP_SO_SNDBUF,          /*lint !e641*/
-                          (void *)&flag,
-                          sizeof(flag)) < 0)
-        {
-          APT_RP_ERROR(ERROR_ID_R12_1901, (W32) tip_errno);
-        }
+      /* Set the Send buffer size */
+      flag = config.sendBufferSize;
+      if(tip_setsockopt(processData_p->serverSockId,
+                        TIP_SOL_SOCKET, TIP_SO_SNDBUF,          /*lint !e641*/
+                        (void *)&flag,
+                        sizeof(flag)) < 0)
+      {
+        APT_RP_ERROR(ERROR_ID_R12_1901, (W32) tip_errno);
+      }
 
-        /* Start listening for connections. */
-        returnValue = tip_listen(processData_p->serverSockId, MAX_CONNECTIONS);
-        if(returnValue < 0)
-        {
-          /* Error when listening to socket. */
-          APT_RP_ERROR(ERROR_ID_R12_1902, (W32) tip_errno);
-        }
-        else
-        {
-          result = TELNET_START_OK;
-        }
+      /* Start listening for connections. */
+      returnValue = tip_listen(processData_p->serverSockId, MAX_CONNECTIONS);
+      if(returnValue < 0)
+      {
+        /* Error when listening to socket. */
+        APT_RP_ERROR(ERROR_ID_R12_1902, (W32) tip_errno);
+      }
+      else
+      {
+        result = TELNET_START_OK;
       }
     }
   }
 
   return(result);
-} /* CreateAndActivateServer */
+} /* BindServer */
+
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  ServerStarted
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Reply the result of the start to the creator, and start the
+*           OSmonitor supervision, login verification and RPC process
+*           if the server was started.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*      result           in      TELNET_START_xxx.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void ServerStarted(PROCESS_DATA_st *processData_p, W32 result)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  SIGNAL* sig_p;
+/*-------------------------  CODE  -----------------------------------------*/
+  /* Telnet server was started send reply signal to our creator (parent) */
+  sig_p = OS_alloc(MITELNETSTARTR_S,MITELNETSTARTR);
+  sig_p->mitelnetstartr.resultCode = result;
+  
+  OS_send(&sig_p, processData_p->parentPid);
+
+  /* Supervise OSmonitor, the PID is cached for the client processes */
+  if (result == TELNET_START_OK)
+  {
+    itelnet_ConhSupervise();
+
+    /* Login verification, kept when taking over from a previous
+     * telnet server */
+    itelnet_AuthStart();
+
+    /* Commands of processes and of telnet_rpc_port, if set */
+    itelnet_RpcStart(&config, processData_p->ipAddress);
+  }
+} /* ServerStarted */
 
 
 
@@ -388,7 +689,7 @@ static void HandleSocketChangedEvent(PROCESS_DATA_st *processData_p)
   struct tip_sockaddr_in addr;
   tip_socklen_t size;
   int clientSockId;
-  W32 clientInd;
+  W32 admitResult;
 
 /*-------------------------  CODE  -----------------------------------------*/
   
@@ -417,58 +718,38 @@ static void HandleSocketChangedEvent(PROCESS_DATA_st *processData_p)
         if(clientSockId != -1)
         {
           /* Socket is valid. */
-          /* Check if not too many connections. */
-          if(processData_p->connections < MAX_CONNECTIONS)
+          /* Check if the connection is admitted (not too many
+             connections in total or from this address, accept rate
+             not exceeded). */
+          admitResult = AdmitClient(processData_p,
+                                    tip_ntohl(addr.sin_addr.s_addr));
+          if(admitResult == ADMIT_OK)
           {
-            /* Not too many connections. */
-                  
-            clientInd = AllocateClient(processData_p, clientSockId);
-            
-            /* Build telnet process name and create the process (not started yet). */
-            if(clientInd < MAX_CONNECTIONS)
-            { 
-              /* Save the client's IP address and port. */
-              processData_p->clientData[clientInd].clientIpAddress =
-                tip_ntohl(addr.sin_addr.s_addr);
-              processData_p->clientData[clientInd].clientPortNumber =
-                tip_ntohs(addr.sin_port);
-
-              /* Get real time to remember when client was started. */
-              GetClock1(processData_p->clientData[clientInd].clientStartTime);
-          
-              CreateClient(processData_p, clientInd);
-
-              /* Increment the number of active connections. */
-              processData_p->connections++;
-            }
-            else
-            {
-              APT_RP_DOTRACE_LEV1(ERROR_ID_R12_2103, clientInd,
-                                  __LINE__, __FILE__,
-                                  0);
-
-              /* Too many connections. */
-              /* Close the socket */
-              if (tip_close(clientSockId) < 0)
-              {
-                /* Error when closing socket. */
-                APT_RP_ERROR(ERROR_ID_R12_1905, (W32) tip_errno);
-              }
-            } 
+            /* Connection admitted. */
+            StartClient(processData_p, clientSockId,
+                        tip_ntohl(addr.sin_addr.s_addr),
+                        tip_ntohs(addr.sin_port));
+          }
+          else if((admitResult == ADMIT_FULL) &&
+                  (processData_p->terminationPending == FALSE) &&
+                  QueueClient(clientSockId,
+                              tip_ntohl(addr.sin_addr.s_addr),
+                              tip_ntohs(addr.sin_port)))
+          {
+            /* All connections busy, the client waits in the queue. */
+            StartServerTick();
           }
           else
           {
             APT_RP_DOTRACE_LEV1(ERROR_ID_R12_2104, processData_p->connections,
                                 __LINE__, __FILE__,
-                                0);
+                                2,           /* Num of extra parameters 0-65535 */
+                                admitResult,
+                                tip_ntohl(addr.sin_addr.s_addr));
 
-            /* Too many connections. */
-            /* Close the socket */
-            if (tip_close(clientSockId) < 0)
-            {
-              /* Error when closing socket. */
-              APT_RP_ERROR(ERROR_ID_R12_1906, (W32) tip_errno);
-            }
+            /* Connection not admitted. */
+            /* Tell the client why and close the socket */
+            RejectClient(clientSockId, admitResult);
           }
         }
         else
@@ -498,7 +779,7 @@ static void HandleSocketChangedEvent(PROCESS_DATA_st *processData_p)
         break;
     }
   }
-  else
+  else if (!HandleQueuedSocketEvent(processData_p))
   {
     /* Bad socket */
     APT_RP_ERROR(ERROR_ID_R12_1910,
@@ -543,6 +824,13 @@ static void ProcessInit(PROCESS_DATA_st *processData_p)
   processData_p-> ipAddress = TIP_INADDR_ANY;
   processData_p-> portNumber = TELNET_SERVER_PORT;
 
+  itelnet_TmoInit();
+  serverTickActive = FALSE;
+
+  stopData.startTick = 0;
+  stopData.clients = 0;
+  stopData.forced = 0;
+
   for (i = 0; i < MAX_CONNECTIONS; i++)
   {
     processData_p->clientData[i].status = TELNET_CLIENT_IDLE;
@@ -622,6 +910,10 @@ static void CreateClient(PROCESS_DATA_st *processData_p, W32 clientInd)
 
   OS_send(&sig_p, processData_p->clientData[clientInd].clientPid);
 
+  /* Provide the session configuration */
+  itelnet_CfgSendClient(&config,
+                        processData_p->clientData[clientInd].clientPid);
+
 } /* CreateClient */
 
 
@@ -710,6 +1002,12 @@ static void InitiateClientTermination(PROCESS_DATA_st *processData_p)
 
   /* Indicate the Telnet server termination is pending */
   processData_p->terminationPending = TRUE;
+
+  stopData.startTick = get_ticks();
+  stopData.clients = processData_p->connections;
+
+  /* Waiting clients will not get a connection */
+  CloseQueuedClients();
   
   /* Request all active clients to terminate */
   for (i = 0; i < MAX_CONNECTIONS; i++)
@@ -724,6 +1022,15 @@ static void InitiateClientTermination(PROCESS_DATA_st *processData_p)
     }
   }
 
+  /* The clients stop in parallel, those not stopped at the deadline
+   * are killed */
+  if (processData_p->connections > 0)
+  {
+    APT_RP_FREQUEST_TMO(&stopDeadlineTmo, config.stopDeadline * 1000,
+                        current_process(), MISTOPDEADLINE);
+    stopDeadlineActive = TRUE;
+  }
+
   /* Check if telnet server can terminate */
   CheckAndStopServer(processData_p);
 
@@ -755,42 +1062,79 @@ static void HandleStopClientReply(PROCESS_DATA_st *processData_p)
 /*-------------------------  LOCAL DATA   ----------------------------------*/
 
   W32 clientInd;
-  W32 i;
 
 /*-------------------------  CODE  -----------------------------------------*/
   /* Get the client index */
   clientInd = RECSIG->mistopclientr.clientInd;
   
-  /* Indicate that this client is stopped */
-  processData_p->clientData[clientInd].status = TELNET_CLIENT_IDLE;
+  /* The client may already be released, if the reply was sent to a
+   * previous telnet server and the client was lost after handover */
+  if ((clientInd < MAX_CONNECTIONS) &&
+      (processData_p->clientData[clientInd].status == TELNET_CLIENT_USED))
+  {
+    ReleaseClient(processData_p, clientInd);
+  }
 
-  processData_p->connections--;
-  
-  processData_p->clientData[clientInd].clientPid = (PROCESS) NULL;
-  processData_p->clientData[clientInd].clientSockId     = 0;
-  processData_p->clientData[clientInd].clientIpAddress  = 0;
-  processData_p->clientData[clientInd].clientPortNumber = 0;
+} /* HandleStopClientReply */
 
-  for (i = 0; i < CLIENT_START_TIME_STR_LEN; i++)
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE HandleClientLost  
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Handle the attach signal from a client process taken over
+*           from a previous telnet server. The connection is released
+*           if the client process terminated without its MISTOPCLIENTR
+*           reaching this telnet server.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void HandleClientLost(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+
+  PROCESS pid;
+  W32 clientInd;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  pid = OS_sender(&RECSIG);
+
+  for (clientInd = 0; clientInd < MAX_CONNECTIONS; clientInd++)
   {
-    processData_p->clientData[clientInd].clientStartTime[i] = 0;
+    if ((processData_p->clientData[clientInd].status == TELNET_CLIENT_USED) &&
+        (processData_p->clientData[clientInd].clientPid == pid))
+    {
+      ReleaseClient(processData_p, clientInd);
+      break;
+    }
   }
 
-  /* Check if telnet server can terminate */
-  CheckAndStopServer(processData_p);
+} /* HandleClientLost */
 
-} /* HandleStopClientReply */
 
 
-
 /*
 ******************************************************************************
 *
-*                   SUBROUTINE  CheckAndStopServer
+*                   SUBROUTINE ForceStopClients  
 *                                            
 *-----------------------------------------------------------------------------
 *                                            
-*  Purpose: Check
+*  Purpose: Handle the stop deadline, MISTOPDEADLINE. Client processes
+*           that have not replied MISTOPCLIENTR are killed and their
+*           connections are released, which completes the stop.
 *                                            
 *  Parameters:                               
 *                                            
@@ -802,67 +1146,1283 @@ static void HandleStopClientReply(PROCESS_DATA_st *processData_p)
 *
 *****************************************************************************
 */
-static void CheckAndStopServer(const PROCESS_DATA_st *const processData_p)
+static void ForceStopClients(PROCESS_DATA_st *processData_p)
 {
 /*-------------------------  LOCAL DATA   ----------------------------------*/
-  SIGNAL *sig_p;
-  W32 i;
-  W32 allStopped = TRUE;
+
+  W32 clientInd;
+  PROCESS ownPid;
 
 /*-------------------------  CODE  -----------------------------------------*/
-  /* If Telnet server termination is pending */
-  if (processData_p->terminationPending)
+  if (processData_p->terminationPending == FALSE)
   {
-  /* Check if all clients are stopped
-   */
-    i = 0;
-    while ((allStopped) && (i < MAX_CONNECTIONS))
+    return;
+  }
+
+  ownPid = current_process();
+
+  for (clientInd = 0; clientInd < MAX_CONNECTIONS; clientInd++)
+  {
+    if (processData_p->clientData[clientInd].status == TELNET_CLIENT_USED)
     {
-      if (processData_p->clientData[i].status == TELNET_CLIENT_USED)
+      APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_14, clientInd,
+                          __LINE__, __FILE__,
+                          1,           /* Num of extra parameters 0-65535 */
+                          (W32) processData_p->clientData[clientInd].clientPid);
+
+      /* Take the socket back from the client process and close it,
+       * before its socket context is freed */
+      if(tip_setsockopt(processData_p->clientData[clientInd].clientSockId,
+                        TIP_SOL_SOCKET, TIP_SO_CHOWNER,                   /*lint !e641*/
+                        (char *)&ownPid,
+                        sizeof(PROCESS)) < 0)
       {
-        allStopped = FALSE;
+        APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_23, (W32) tip_errno);
       }
-      else
+      else if (tip_close(processData_p->clientData[clientInd].clientSockId) < 0)
       {
-        i++;
+        APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_24, (W32) tip_errno);
       }
-    }
+
+      kill_proc(processData_p->clientData[clientInd].clientPid);
+
+#ifndef SOFTKERNEL  
+      /* Free the socket context of the killed client process */
+      socket_proc_terminate(processData_p->clientData[clientInd].clientPid);
+#endif
+
+      stopData.forced++;
+
+      /* The server is killed when the last client is released */
+      ReleaseClient(processData_p, clientInd);
+    }
+  }
+
+} /* ForceStopClients */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE ReleaseClient  
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Release a stopped client individual
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*      clientInd        in      Client individual
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void ReleaseClient(PROCESS_DATA_st *processData_p, W32 clientInd)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  /* Indicate that this client is stopped */
+  processData_p->clientData[clientInd].status = TELNET_CLIENT_IDLE;
+
+  /* Stop the inactivity supervision */
+  itelnet_TmoDisarm(clientInd);
+
+  processData_p->connections--;
+  
+  processData_p->clientData[clientInd].clientPid = (PROCESS) NULL;
+  processData_p->clientData[clientInd].clientSockId     = 0;
+  processData_p->clientData[clientInd].clientIpAddress  = 0;
+  processData_p->clientData[clientInd].clientPortNumber = 0;
+
+  for (i = 0; i < CLIENT_START_TIME_STR_LEN; i++)
+  {
+    processData_p->clientData[clientInd].clientStartTime[i] = 0;
+  }
+
+  /* Give the free connection to a waiting client */
+  if (processData_p->terminationPending == FALSE)
+  {
+    PromoteQueuedClients(processData_p);
+  }
+
+  /* Check if telnet server can terminate */
+  CheckAndStopServer(processData_p);
+
+} /* ReleaseClient */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE HandoverServer  
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Hand over the server socket, the sessions and the waiting
+*           clients to a new telnet server (MITELNETHANDOVER) and
+*           terminate. The client processes and their sockets are not
+*           touched, they only change the telnet server they report to.
+*           Until every client has replied MIHANDOVERCLIENTR, or has
+*           terminated, all signals received are passed on to the new
+*           server. A telnet server that is stopping hands over nothing,
+*           the new server is told so and replies TELNET_START_FAIL.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void HandoverServer(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  static SIGSELECT allSignals[] = {0};
+  struct mihandoverclient_data_s *client_p;
+  SIGNAL *sig_p;
+  SIGNAL *handover_p;
+  PROCESS newPid;
+  PROCESS pid;
+  Boolean replied[MAX_CONNECTIONS];
+  W32 noOfPending = 0;
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  newPid = RECSIG->mitelnethandover.serverPid;
+
+  if (processData_p->terminationPending)
+  {
+    /* The telnet server is stopping, nothing to hand over. The new
+     * telnet server replies the failure to the telnet administration */
+    APT_RP_DOTRACE_LEV1(ERROR_ID_G12B_RTIPGPHR_13, (W32) newPid,
+                        __LINE__, __FILE__,
+                        0);
+    handover_p = OS_alloc(MISERVERHANDOVER_SIZE(1), MISERVERHANDOVER);
+    handover_p->miserverhandover.parentPid = processData_p->parentPid;
+    handover_p->miserverhandover.resultCode = TELNET_START_FAIL;
+    handover_p->miserverhandover.noOfWaiting = 0;
+    handover_p->miserverhandover.noOfClients = 0;
+    OS_send(&handover_p, newPid);
+    return;
+  }
+
+  handover_p = OS_alloc(MISERVERHANDOVER_SIZE(MAX_CONNECTIONS),
+                        MISERVERHANDOVER);
+  handover_p->miserverhandover.parentPid = processData_p->parentPid;
+  handover_p->miserverhandover.resultCode = TELNET_START_OK;
+  handover_p->miserverhandover.serverSockId =
+    (W32) processData_p->serverSockId;
+  handover_p->miserverhandover.ipAddress = processData_p->ipAddress;
+  handover_p->miserverhandover.portNumber = processData_p->portNumber;
+
+  /* Make the new telnet server owner of the server socket */
+  if (tip_asyncselect(processData_p->serverSockId, 0) < 0)
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_25, (W32) tip_errno);
+  }
+  if(tip_setsockopt(processData_p->serverSockId,
+                    TIP_SOL_SOCKET, TIP_SO_CHOWNER,                         /*lint !e641*/
+                    (char *)&newPid,
+                    sizeof(PROCESS)) < 0)
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_26, (W32) tip_errno);
+  }
+
+  /* The waiting clients */
+  handover_p->miserverhandover.noOfWaiting = waitQueue.length;
+  for (i = 0; i < waitQueue.length; i++)
+  {
+    if (tip_asyncselect(waitQueue.client[i].clientSockId, 0) < 0)
+    {
+      APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_27, (W32) tip_errno);
+    }
+    if(tip_setsockopt(waitQueue.client[i].clientSockId,
+                      TIP_SOL_SOCKET, TIP_SO_CHOWNER,                       /*lint !e641*/
+                      (char *)&newPid,
+                      sizeof(PROCESS)) < 0)
+    {
+      APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_28, (W32) tip_errno);
+    }
+
+    handover_p->miserverhandover.waiting[i].clientSockId =
+      (W32) waitQueue.client[i].clientSockId;
+    handover_p->miserverhandover.waiting[i].clientIpAddress =
+      waitQueue.client[i].clientIpAddress;
+    handover_p->miserverhandover.waiting[i].clientPortNumber =
+      waitQueue.client[i].clientPortNumber;
+  }
+
+  /* The sessions, the client processes report to the new telnet
+   * server from now on */
+  handover_p->miserverhandover.noOfClients = MAX_CONNECTIONS;
+  for (i = 0; i < MAX_CONNECTIONS; i++)
+  {
+    client_p = &handover_p->miserverhandover.client[i];
+    client_p->status = processData_p->clientData[i].status;
+    client_p->clientPid = processData_p->clientData[i].clientPid;
+    client_p->clientSockId = (W32) processData_p->clientData[i].clientSockId;
+    client_p->clientIpAddress = processData_p->clientData[i].clientIpAddress;
+    client_p->clientPortNumber = processData_p->clientData[i].clientPortNumber;
+    client_p->timeOut = itelnet_TmoTimeout(i);
+    strncpy(client_p->clientStartTime,
+            processData_p->clientData[i].clientStartTime,
+            MI_START_TIME_STR_LEN - 1);
+    client_p->clientStartTime[MI_START_TIME_STR_LEN - 1] = 0;
+
+    replied[i] = TRUE;
+    if (processData_p->clientData[i].status == TELNET_CLIENT_USED)
+    {
+      /* A client terminating before its reply is detected by the
+       * attach signal */
+      (void) attach(NULL, processData_p->clientData[i].clientPid);
+
+      sig_p = OS_alloc(MIHANDOVERCLIENT_S, MIHANDOVERCLIENT);
+      sig_p->mihandoverclient.serverPid = newPid;
+      OS_send(&sig_p, processData_p->clientData[i].clientPid);
+
+      replied[i] = FALSE;
+      noOfPending++;
+    }
+  }
+
+  OS_send(&handover_p, newPid);
+
+  /* The static data belongs to the new telnet server from now on.
+   * Signals sent to this telnet server before the clients knew of the
+   * new one are passed on, with their sender kept */
+  while (noOfPending > 0)
+  {
+    sig_p = OS_receive(allSignals);
+    pid = OS_sender(&sig_p);
+
+    if ((sig_p->sig_no == MIHANDOVERCLIENTR) ||
+        (sig_p->sig_no == OS_ATTACH_SIG))
+    {
+      for (i = 0; i < MAX_CONNECTIONS; i++)
+      {
+        if (!replied[i] &&
+            (processData_p->clientData[i].clientPid == pid))
+        {
+          replied[i] = TRUE;
+          noOfPending--;
+        }
+      }
+      OS_free(&sig_p);
+    }
+    else if (sig_p->sig_no == MISERVERTICK)
+    {
+      /* The timeout of this telnet server, the new one has its own */
+      OS_free(&sig_p);
+    }
+    else
+    {
+      send_w_s(&sig_p, pid, newPid);
+    }
+  }
+
+#ifndef SOFTKERNEL  
+  /* No more socket calls from this process, see CheckAndStopServer */
+  socket_proc_terminate(current_process() );
+#endif
+
+  /* Kill the telnet server process */
+  kill_proc(current_process());
+
+} /* HandoverServer */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE AdoptServer  
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Take over the server socket, the sessions and the waiting
+*           clients from a previous telnet server (MISERVERHANDOVER).
+*           The client processes are attached to, so that a session
+*           terminating during the handover is still released.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: TELNET_START_OK or TELNET_START_FAIL
+*
+*****************************************************************************
+*/
+static W32 AdoptServer(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  struct miserverhandover_s *handover_p;
+  struct mihandoverclient_data_s *client_p;
+  W32 result = TELNET_START_OK;
+  W32 noOfClients;
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  handover_p = &RECSIG->miserverhandover;
+
+  processData_p->serverSockId = (int) handover_p->serverSockId;
+  processData_p->ipAddress = handover_p->ipAddress;
+  processData_p->portNumber = handover_p->portNumber;
+
+  /* Subscribe on client connection request and socket closed events */
+  if (tip_asyncselect(processData_p->serverSockId, TIP_FD_CLOSE|TIP_FD_ACCEPT) < 0) /*lint !e641 !e655*/
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_29, (W32) tip_errno);
+    result = TELNET_START_FAIL;
+  }
+
+  /* The sessions */
+  noOfClients = handover_p->noOfClients;
+  if (noOfClients > MAX_CONNECTIONS)
+  {
+    noOfClients = MAX_CONNECTIONS;
+  }
+
+  for (i = 0; i < noOfClients; i++)
+  {
+    client_p = &handover_p->client[i];
+    if (client_p->status == TELNET_CLIENT_USED)
+    {
+      processData_p->clientData[i].status = TELNET_CLIENT_USED;
+      processData_p->clientData[i].clientPid = client_p->clientPid;
+      processData_p->clientData[i].clientSockId = (int) client_p->clientSockId;
+      processData_p->clientData[i].clientIpAddress = client_p->clientIpAddress;
+      processData_p->clientData[i].clientPortNumber = client_p->clientPortNumber;
+      strncpy(processData_p->clientData[i].clientStartTime,
+              client_p->clientStartTime,
+              CLIENT_START_TIME_STR_LEN - 1);
+      processData_p->connections++;
+
+      (void) attach(NULL, client_p->clientPid);
+
+      if (client_p->timeOut != 0)
+      {
+        itelnet_TmoArm(i, client_p->timeOut);
+      }
+    }
+  }
+
+  /* The waiting clients keep their position, the wait starts over */
+  for (i = 0; i < handover_p->noOfWaiting; i++)
+  {
+    if (!QueueClient((int) handover_p->waiting[i].clientSockId,
+                     handover_p->waiting[i].clientIpAddress,
+                     handover_p->waiting[i].clientPortNumber))
+    {
+      RejectClient((int) handover_p->waiting[i].clientSockId, ADMIT_FULL);
+    }
+  }
+
+  StartServerTick();
+
+  return(result);
+} /* AdoptServer */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  CheckAndStopServer
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Check
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void CheckAndStopServer(const PROCESS_DATA_st *const processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  SIGNAL *sig_p;
+  W32 i;
+  W32 allStopped = TRUE;
+  OSTICK elapsedTicks;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  /* If Telnet server termination is pending */
+  if (processData_p->terminationPending)
+  {
+  /* Check if all clients are stopped
+   */
+    i = 0;
+    while ((allStopped) && (i < MAX_CONNECTIONS))
+    {
+      if (processData_p->clientData[i].status == TELNET_CLIENT_USED)
+      {
+        allStopped = FALSE;
+      }
+      else
+      {
+        i++;
+      }
+    }
 
     if (allStopped)
     {
-      /* All clients are stopped
-       * Send reply to the creator of the Telnet server (parent) i_telneta
-       */
-      if (tip_close(processData_p->serverSockId) < 0)
+      /* All clients are stopped before the deadline */
+      if (stopDeadlineActive)
+      {
+        APT_RP_CANCEL_TMO(&stopDeadlineTmo);
+        stopDeadlineActive = FALSE;
+      }
+
+      /* All clients are stopped
+       * Send reply to the creator of the Telnet server (parent) i_telneta
+       */
+      if (tip_close(processData_p->serverSockId) < 0)
+      {
+        /* Error when closing socket. */
+        APT_RP_ERROR(ERROR_ID_R12_1912, (W32) tip_errno);
+      }
+
+      itelnet_AuthStop();
+      itelnet_RpcStop();
+
+#ifndef SOFTKERNEL  
+      /*
+       * The socket_proc_terminate function frees the process context
+       * variables used by the specified process and shall be called
+       * when a process that has been using the TIP-stack socket interface
+       * is to be terminated. Note! No more socket calls has to be made by
+       * the process in question after that this function is called.
+       * Then it will be inserted again in the context array.
+       */
+      socket_proc_terminate(current_process() );
+#endif
+
+      /* Report the time it took to stop */
+      elapsedTicks = get_ticks() - stopData.startTick;
+      sig_p = OS_alloc(MITELNETSTOPSTAT_S,MITELNETSTOPSTAT);
+      sig_p->mitelnetstopstat.duration =
+        (W32) ((elapsedTicks / 1000) * system_tick() +
+               ((elapsedTicks % 1000) * system_tick()) / 1000);
+      sig_p->mitelnetstopstat.noOfClients = stopData.clients;
+      sig_p->mitelnetstopstat.noOfForced = stopData.forced;
+      OS_send(&sig_p, processData_p->parentPid);
+
+      sig_p = OS_alloc(MITELNETSTOPR_S,MITELNETSTOPR);
+      OS_send(&sig_p, processData_p->parentPid);
+
+      /* Kill the telnet server process */
+      kill_proc(current_process());
+    }
+  }
+
+} /* CheckAndStopServer */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  StartServerTick
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Requests the periodic timeout (MISERVERTICK) driving the
+*           session timer wheel and the admission queue supervision,
+*           if not already requested and if any session is supervised
+*           or any client is waiting.
+*                                            
+*  Parameters: -
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void StartServerTick(void)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+
+/*-------------------------  CODE  -----------------------------------------*/
+  if ((serverTickActive == FALSE) &&
+      (itelnet_TmoActive() || (waitQueue.length > 0)))
+  {
+    APT_RP_FREQUEST_TMO(&serverTickTmo, TMO_WHEEL_TICK_MS,
+                        current_process(), MISERVERTICK);
+    serverTickActive = TRUE;
+  }
+} /* StartServerTick */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  HandleServerTick
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Handles the periodic timeout. Sessions that have been
+*           inactive for too long are requested to close (MICLIENTIDLE)
+*           and clients that have waited too long in the admission
+*           queue are closed.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void HandleServerTick(const PROCESS_DATA_st *const processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  SIGNAL *sig_p;
+  W32 expired[MAX_CONNECTIONS];
+  W32 noOfExpired;
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  noOfExpired = itelnet_TmoExpire(expired, MAX_CONNECTIONS);
+
+  for (i = 0; i < noOfExpired; i++)
+  {
+    if (processData_p->clientData[expired[i]].status == TELNET_CLIENT_USED)
+    {
+      sig_p = OS_alloc(MICLIENTIDLE_S, MICLIENTIDLE);
+      OS_send(&sig_p, processData_p->clientData[expired[i]].clientPid);
+    }
+  }
+
+  ExpireQueuedClients();
+
+  StartServerTick();
+} /* HandleServerTick */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  AdmissionInit
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Fills the token bucket and empties the admission queue.
+*                                            
+*  Parameters: -
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void AdmissionInit(void)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+
+/*-------------------------  CODE  -----------------------------------------*/
+  admission.tokens = config.acceptBurst * TOKEN;
+  admission.lastRefill = get_ticks();
+
+  admission.rejectedFull = 0;
+  admission.rejectedPerAddr = 0;
+  admission.rejectedRate = 0;
+
+  waitQueue.length = 0;
+  waitQueue.queued = 0;
+  waitQueue.promoted = 0;
+  waitQueue.expired = 0;
+} /* AdmissionInit */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  ReloadConfig
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Reloads the configuration snapshot (MITELNETRELOAD). The new
+*           configuration applies to new connections and is sent to the
+*           running sessions.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void ReloadConfig(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  W32 flag;
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  itelnet_CfgLoad(&config);
+
+  /* The send buffer size is inherited by accepted sockets */
+  flag = config.sendBufferSize;
+  if(tip_setsockopt(processData_p->serverSockId,
+                    TIP_SOL_SOCKET, TIP_SO_SNDBUF,          /*lint !e641*/
+                    (void *)&flag,
+                    sizeof(flag)) < 0)
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_30, (W32) tip_errno);
+  }
+
+  /* A smaller burst limits the tokens at once */
+  if (admission.tokens > config.acceptBurst * TOKEN)
+  {
+    admission.tokens = config.acceptBurst * TOKEN;
+  }
+
+  /* Clients beyond a smaller queue depth keep their place, the
+     queue shrinks as they leave */
+
+  for (i = 0; i < MAX_CONNECTIONS; i++)
+  {
+    if (processData_p->clientData[i].status == TELNET_CLIENT_USED)
+    {
+      itelnet_CfgSendClient(&config, processData_p->clientData[i].clientPid);
+    }
+  }
+} /* ReloadConfig */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  IsPrivileged
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Checks if a client address is privileged, i.e. may use
+*           the reserved connections and is not rate limited.
+*           Loopback and the telnet_privileged_net network are
+*           privileged.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      ipAddress        in      Client IP address (host order).
+*
+*  Return value: TRUE if privileged
+*
+*****************************************************************************
+*/
+static Boolean IsPrivileged(W32 ipAddress)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+
+/*-------------------------  CODE  -----------------------------------------*/
+  if ((ipAddress & LOOPBACK_MASK) == LOOPBACK_NET)
+  {
+    return TRUE;
+  }
+
+  return (Boolean) ((config.privMask != 0) &&
+                    ((ipAddress & config.privMask) == config.privNet));
+} /* IsPrivileged */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  AdmitClient
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Admission control of a new connection.
+*           Non-privileged clients are limited by the number of
+*           connections per address, the accept rate (token bucket)
+*           and may not use the reserved connections.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*      ipAddress        in      Client IP address (host order).
+*
+*  Return value: ADMIT_OK or the reason for rejecting the client
+*
+*****************************************************************************
+*/
+static W32 AdmitClient(const PROCESS_DATA_st *const processData_p,
+                       W32 ipAddress)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  OSTICK now;
+  OSTICK elapsedTicks;
+  W32 elapsedMs;
+  W32 perAddr = 0;
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  if (IsPrivileged(ipAddress))
+  {
+    /* Privileged clients may use all connections */
+    if (processData_p->connections >= MAX_CONNECTIONS)
+    {
+      admission.rejectedFull++;
+      return ADMIT_FULL;
+    }
+    return ADMIT_OK;
+  }
+
+  /* Concurrent connections (and waiting clients) from the same address */
+  for (i = 0; i < MAX_CONNECTIONS; i++)
+  {
+    if ((processData_p->clientData[i].status == TELNET_CLIENT_USED) &&
+        (processData_p->clientData[i].clientIpAddress == ipAddress))
+    {
+      perAddr++;
+    }
+  }
+
+  for (i = 0; i < waitQueue.length; i++)
+  {
+    if (waitQueue.client[i].clientIpAddress == ipAddress)
+    {
+      perAddr++;
+    }
+  }
+
+  if ((config.maxPerAddr != 0) && (perAddr >= config.maxPerAddr))
+  {
+    admission.rejectedPerAddr++;
+    return ADMIT_PER_ADDR;
+  }
+
+  /* Reserved connections are for privileged clients only */
+  if (processData_p->connections >= (MAX_CONNECTIONS - config.reserved))
+  {
+    admission.rejectedFull++;
+    return ADMIT_FULL;
+  }
+
+  /* Accept rate, checked last so that rejected clients do not use
+     tokens. Refill the token bucket for the elapsed time */
+  if (config.acceptRate != 0)
+  {
+    now = get_ticks();
+    elapsedTicks = now - admission.lastRefill;
+    elapsedMs = (W32) ((elapsedTicks / 1000) * system_tick() +
+                       ((elapsedTicks % 1000) * system_tick()) / 1000);
+    if (elapsedMs > 0)
+    {
+      admission.lastRefill = now;
+
+      if (elapsedMs >= (config.acceptBurst * 1000) / config.acceptRate)
+      {
+        admission.tokens = config.acceptBurst * TOKEN;
+      }
+      else
+      {
+        admission.tokens += elapsedMs * config.acceptRate;
+        if (admission.tokens > config.acceptBurst * TOKEN)
+        {
+          admission.tokens = config.acceptBurst * TOKEN;
+        }
+      }
+    }
+
+    if (admission.tokens < TOKEN)
+    {
+      admission.rejectedRate++;
+      return ADMIT_RATE;
+    }
+
+    admission.tokens -= TOKEN;
+  }
+
+  return ADMIT_OK;
+} /* AdmitClient */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  RejectClient
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Tells a client that is not admitted why, and closes the
+*           socket.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      clientSockId     in      Client socket.
+*      reason           in      Result from AdmitClient.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void RejectClient(int clientSockId, W32 reason)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  const char *text_p;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  switch (reason)
+  {
+    case ADMIT_PER_ADDR:
+      text_p = "\r\nToo many connections from your address.\r\n";
+      break;
+
+    case ADMIT_RATE:
+      text_p = "\r\nToo many connection attempts, try again later.\r\n";
+      break;
+
+    default:
+      text_p = "\r\nAll telnet sessions are busy.\r\n";
+      break;
+  }
+
+  /* Best effort, the socket is closed anyway */
+  (void) tip_write(clientSockId, text_p, (int) strlen(text_p));
+
+  if (tip_close(clientSockId) < 0)
+  {
+    /* Error when closing socket. */
+    APT_RP_ERROR(ERROR_ID_R12_1906, (W32) tip_errno);
+  }
+} /* RejectClient */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  StartClient
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Allocates a client individual for an admitted connection
+*           and creates the telnet client process.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*      clientSockId     in      Client socket.
+*      ipAddress        in      Client IP address (host order).
+*      portNumber       in      Client port number (host order).
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void StartClient(PROCESS_DATA_st *processData_p, int clientSockId,
+                        W32 ipAddress, W32 portNumber)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  W32 clientInd;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  clientInd = AllocateClient(processData_p, clientSockId);
+            
+  /* Build telnet process name and create the process (not started yet). */
+  if(clientInd < MAX_CONNECTIONS)
+  { 
+    /* Save the client's IP address and port. */
+    processData_p->clientData[clientInd].clientIpAddress = ipAddress;
+    processData_p->clientData[clientInd].clientPortNumber = portNumber;
+
+    /* Get real time to remember when client was started. */
+    GetClock1(processData_p->clientData[clientInd].clientStartTime);
+          
+    CreateClient(processData_p, clientInd);
+
+    /* Increment the number of active connections. */
+    processData_p->connections++;
+  }
+  else
+  {
+    APT_RP_DOTRACE_LEV1(ERROR_ID_R12_2103, clientInd,
+                        __LINE__, __FILE__,
+                        0);
+
+    /* Too many connections. */
+    /* Close the socket */
+    if (tip_close(clientSockId) < 0)
+    {
+      /* Error when closing socket. */
+      APT_RP_ERROR(ERROR_ID_R12_1905, (W32) tip_errno);
+    }
+  } 
+} /* StartClient */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  QueueClient
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Puts an accepted client in the admission queue, if the
+*           queue is enabled and not full. The client is told its
+*           position in the queue.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      clientSockId     in      Client socket.
+*      ipAddress        in      Client IP address (host order).
+*      portNumber       in      Client port number (host order).
+*
+*  Return value: TRUE if queued, FALSE if the client shall be rejected
+*
+*****************************************************************************
+*/
+static Boolean QueueClient(int clientSockId, W32 ipAddress, W32 portNumber)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  WAITING_CLIENT_st *client_p;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  if (waitQueue.length >= config.queueDepth)
+  {
+    return FALSE;
+  }
+
+  /* Detect if the client leaves the queue */
+  if (tip_asyncselect(clientSockId, TIP_FD_CLOSE) < 0) /*lint !e641*/
+  {
+    APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_31, (W32) tip_errno);
+    return FALSE;
+  }
+
+  client_p = &waitQueue.client[waitQueue.length];
+  client_p->clientSockId = clientSockId;
+  client_p->clientIpAddress = ipAddress;
+  client_p->clientPortNumber = portNumber;
+  client_p->queuedAt = get_ticks();
+
+  waitQueue.length++;
+  waitQueue.queued++;
+
+  TellQueuePositions(waitQueue.length - 1);
+
+  return TRUE;
+} /* QueueClient */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  DequeueClient
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Removes a client from the admission queue. The socket is
+*           not closed.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      pos              in      Position in the queue (0 = first).
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void DequeueClient(W32 pos)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  for (i = pos + 1; i < waitQueue.length; i++)
+  {
+    waitQueue.client[i - 1] = waitQueue.client[i];
+  }
+  waitQueue.length--;
+} /* DequeueClient */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  TellQueuePositions
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Tells the waiting clients their position in the queue.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      fromPos          in      First position that has changed.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void TellQueuePositions(W32 fromPos)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  char text[80];
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  for (i = fromPos; i < waitQueue.length; i++)
+  {
+    sprintf(text, "\r\nAll telnet sessions are busy. "
+            "You are number %lu in the queue.", (unsigned long) (i + 1));
+
+    /* Best effort, the position is told again when it changes */
+    (void) tip_write(waitQueue.client[i].clientSockId, text,
+                     (int) strlen(text));
+  }
+} /* TellQueuePositions */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  HandleQueuedSocketEvent
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Handles a socket event for a client in the admission
+*           queue, i.e. the client has closed the connection.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: TRUE if the socket belongs to a waiting client
+*
+*****************************************************************************
+*/
+static Boolean HandleQueuedSocketEvent(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  W32 i;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  for (i = 0; i < waitQueue.length; i++)
+  {
+    if ((long)RECSIG->tip_socket_changed_event.socket ==
+        waitQueue.client[i].clientSockId)
+    {
+      if (RECSIG->tip_socket_changed_event.event == (U16)TIP_FD_CLOSE)
       {
-        /* Error when closing socket. */
-        APT_RP_ERROR(ERROR_ID_R12_1912, (W32) tip_errno);
+        /* The client has left the queue */
+        if (tip_close(waitQueue.client[i].clientSockId) < 0)
+        {
+          /* Error when closing socket. */
+          APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_32, (W32) tip_errno);
+        }
+
+        DequeueClient(i);
+        TellQueuePositions(i);
       }
+      return TRUE;
+    }
+  }
 
-#ifndef SOFTKERNEL  
-      /*
-       * The socket_proc_terminate function frees the process context
-       * variables used by the specified process and shall be called
-       * when a process that has been using the TIP-stack socket interface
-       * is to be terminated. Note! No more socket calls has to be made by
-       * the process in question after that this function is called.
-       * Then it will be inserted again in the context array.
-       */
-      socket_proc_terminate(current_process() );
-#endif
+  return FALSE;
+} /* HandleQueuedSocketEvent */
 
-      sig_p = OS_alloc(MITELNETSTOPR_S,MITELNETSTOPR);
-      OS_send(&sig_p, processData_p->parentPid);
 
-      /* Kill the telnet server process */
-      kill_proc(current_process());
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  PromoteQueuedClients
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Starts client processes for waiting clients, first come
+*           first served, as long as there are free connections.
+*                                            
+*  Parameters:                               
+*                                            
+*      parameter        in/out  description  
+*
+*      *processData_p   in      Pointer to the process data.
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void PromoteQueuedClients(PROCESS_DATA_st *processData_p)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  WAITING_CLIENT_st client;
+  W32 limit;
+  W32 promoted = 0;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  while (waitQueue.length > 0)
+  {
+    client = waitQueue.client[0];
+
+    /* Non-privileged clients may not use the reserved connections */
+    limit = IsPrivileged(client.clientIpAddress) ?
+      MAX_CONNECTIONS : (MAX_CONNECTIONS - config.reserved);
+
+    if (processData_p->connections >= limit)
+    {
+      break;
+    }
+
+    DequeueClient(0);
+
+    /* The client process subscribes to the socket events itself */
+    if (tip_asyncselect(client.clientSockId, 0) < 0)
+    {
+      APT_RP_ERROR(ERROR_ID_G12B_RTIPGPHR_33, (W32) tip_errno);
     }
+
+    StartClient(processData_p, client.clientSockId,
+                client.clientIpAddress, client.clientPortNumber);
+
+    waitQueue.promoted++;
+    promoted++;
   }
 
-} /* CheckAndStopServer */
+  if (promoted > 0)
+  {
+    TellQueuePositions(0);
+  }
+} /* PromoteQueuedClients */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  ExpireQueuedClients
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Closes clients that have waited longer than
+*           telnet_queue_wait in the admission queue.
+*                                            
+*  Parameters: -
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void ExpireQueuedClients(void)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+  OSTICK now;
+  OSTICK maxWaitTicks;
+  W32 i = 0;
+  W32 first = waitQueue.length;
+
+/*-------------------------  CODE  -----------------------------------------*/
+  now = get_ticks();
+  /* system_tick() is in microseconds, the max queue wait fits */
+  maxWaitTicks = (OSTICK) ((config.queueWait * 1000000UL) / system_tick());
+
+  while (i < waitQueue.length)
+  {
+    if ((OSTICK)(now - waitQueue.client[i].queuedAt) >= maxWaitTicks)
+    {
+      RejectClient(waitQueue.client[i].clientSockId, ADMIT_FULL);
+      DequeueClient(i);
+      waitQueue.expired++;
+
+      if (i < first)
+      {
+        first = i;
+      }
+    }
+    else
+    {
+      i++;
+    }
+  }
+
+  if (first < waitQueue.length)
+  {
+    TellQueuePositions(first);
+  }
+} /* ExpireQueuedClients */
+
+
+
+/*
+******************************************************************************
+*
+*                   SUBROUTINE  CloseQueuedClients
+*                                            
+*-----------------------------------------------------------------------------
+*                                            
+*  Purpose: Closes all clients in the admission queue. Called when
+*           the telnet server is stopped.
+*                                            
+*  Parameters: -
+*
+*  Return value: void
+*
+*****************************************************************************
+*/
+static void CloseQueuedClients(void)
+{
+/*-------------------------  LOCAL DATA   ----------------------------------*/
+
+/*-------------------------  CODE  -----------------------------------------*/
+  while (waitQueue.length > 0)
+  {
+    RejectClient(waitQueue.client[0].clientSockId, ADMIT_FULL);
+    DequeueClient(0);
+  }
+} /* CloseQueuedClients */
+
 
 
-
 /*
 ******************************************************************************
 *
@@ -1010,6 +2570,48 @@ static void ReportModuleData (PROCESS_DATA_st *processData_p)
                      0,
                      TYPE_UNSIGNED_LONG);
                       
+           SendLine (processData_p,
+"'telnet' Rejected, All Sessions Busy                 ",
+                     admission.rejectedFull,
+                     0,
+                     TYPE_UNSIGNED_LONG);
+
+           SendLine (processData_p,
+"'telnet' Rejected, Too Many From Address             ",
+                     admission.rejectedPerAddr,
+                     0,
+                     TYPE_UNSIGNED_LONG);
+
+           SendLine (processData_p,
+"'telnet' Rejected, Accept Rate Exceeded              ",
+                     admission.rejectedRate,
+                     0,
+                     TYPE_UNSIGNED_LONG);
+                      
+           SendLine (processData_p,
+"'telnet' Clients Waiting In Queue                    ",
+                     waitQueue.length,
+                     0,
+                     TYPE_UNSIGNED_LONG);
+
+           SendLine (processData_p,
+"'telnet' Clients Queued                              ",
+                     waitQueue.queued,
+                     0,
+                     TYPE_UNSIGNED_LONG);
+
+           SendLine (processData_p,
+"'telnet' Clients Promoted From Queue                 ",
+                     waitQueue.promoted,
+                     0,
+                     TYPE_UNSIGNED_LONG);
+
+           SendLine (processData_p,
+"'telnet' Clients Expired In Queue                    ",
+                     waitQueue.expired,
+                     0,
+                     TYPE_UNSIGNED_LONG);
+
            SendLine (processData_p,
 "'telnet' Parent Process ID                           ",
                      processData_p-> parentPid,